@@ -0,0 +1,145 @@
+#include "text_annotator.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+	// Highest codepoint IsKanji() accepts
+	constexpr char32_t LAST_KANJI = 0x323AF;
+
+	std::string EncodeUtf8(char32_t codepoint)
+	{
+		std::string encoded;
+		if (codepoint < 0x800)
+		{
+			encoded += static_cast<char>(0xC0 | (codepoint >> 6));
+			encoded += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else if (codepoint < 0x10000)
+		{
+			encoded += static_cast<char>(0xE0 | (codepoint >> 12));
+			encoded += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			encoded += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		else
+		{
+			encoded += static_cast<char>(0xF0 | (codepoint >> 18));
+			encoded += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+			encoded += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+			encoded += static_cast<char>(0x80 | (codepoint & 0x3F));
+		}
+		return encoded;
+	}
+} // namespace
+
+namespace kanji::annotation
+{
+	bool IsKanji(char32_t codepoint)
+	{
+		return (codepoint >= 0x4E00 && codepoint <= 0x9FFF) || (codepoint >= 0x3400 && codepoint <= 0x4DBF) ||
+		       (codepoint >= 0xF900 && codepoint <= 0xFAFF) || (codepoint >= 0x20000 && codepoint <= LAST_KANJI);
+	}
+
+	LevelTable::LevelTable(const std::unordered_map<char32_t, int>& in_levels)
+	{
+		char32_t max_codepoint = 0;
+		for (const auto& [codepoint, level] : in_levels)
+		{
+			if (IsKanji(codepoint))
+			{
+				max_codepoint = std::max(max_codepoint, codepoint);
+			}
+		}
+
+		levels.assign(static_cast<std::size_t>(max_codepoint) + 1, UNKNOWN);
+		for (const auto& [codepoint, level] : in_levels)
+		{
+			if (IsKanji(codepoint) && level >= 0)
+			{
+				levels[codepoint] = static_cast<std::int8_t>(std::min(level, 127));
+				max_level = std::max(max_level, static_cast<int>(levels[codepoint]));
+			}
+		}
+	}
+
+	std::int8_t LevelTable::Get(char32_t codepoint) const
+	{
+		return codepoint < levels.size() ? levels[codepoint] : UNKNOWN;
+	}
+
+	int LevelTable::GetMaxLevel() const
+	{
+		return max_level;
+	}
+
+	AnnotationResult Annotate(std::string_view text, const LevelTable& table)
+	{
+		AnnotationResult result;
+		auto& summary = result.summary;
+		summary.level_counts.assign(static_cast<std::size_t>(table.GetMaxLevel()) + 1, 0);
+
+		// Counts by codepoint in a table each request thread allocates once and keeps. Only the entries
+		// listed in `first_seen` are ever non-zero, and they are cleared again before returning.
+		thread_local std::vector<std::uint32_t> counts(static_cast<std::size_t>(LAST_KANJI) + 1, 0);
+		std::vector<char32_t> first_seen;
+
+		utils::utf8::ForEachNonAscii(text, [&](char32_t codepoint, std::size_t) {
+			if (!IsKanji(codepoint))
+			{
+				return;
+			}
+
+			if (counts[codepoint]++ == 0)
+			{
+				first_seen.push_back(codepoint);
+			}
+
+			++summary.total_kanji;
+			const std::int8_t level = table.Get(codepoint);
+			if (level == LevelTable::UNKNOWN)
+			{
+				++summary.unknown_kanji;
+				return;
+			}
+			++summary.known_kanji;
+			++summary.level_counts[level];
+		});
+
+		result.kanjis.reserve(first_seen.size());
+		for (const char32_t codepoint : first_seen)
+		{
+			KanjiAnnotation& annotation = result.kanjis.emplace_back();
+			annotation.kanji = EncodeUtf8(codepoint);
+			annotation.count = std::exchange(counts[codepoint], 0);
+			if (const std::int8_t level = table.Get(codepoint); level != LevelTable::UNKNOWN)
+			{
+				annotation.level = level;
+				++summary.distinct_known;
+			}
+		}
+
+		summary.distinct_kanji = first_seen.size();
+		summary.coverage =
+		    summary.total_kanji == 0 ? 0.0 : static_cast<double>(summary.known_kanji) / static_cast<double>(summary.total_kanji);
+		return result;
+	}
+
+	void to_json(nlohmann::json& j, const KanjiAnnotation& annotation)
+	{
+		j = nlohmann::json{{"kanji", annotation.kanji}, {"count", annotation.count}};
+		if (annotation.level)
+		{
+			j["level"] = *annotation.level;
+		}
+		else
+		{
+			j["level"] = "unknown";
+		}
+	}
+
+	void to_json(nlohmann::json& j, const AnnotationResult& result)
+	{
+		j = nlohmann::json{{"kanjis", result.kanjis}, {"summary", result.summary}};
+	}
+} // namespace kanji::annotation
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kanji::annotation
+{
+	// CJK Unified Ideographs, including the extension blocks and compatibility ideographs
+	bool IsKanji(char32_t codepoint);
+
+	// SRS level per codepoint in a flat array, so a lookup is one bounds check and one load
+	class LevelTable
+	{
+	public:
+		static constexpr std::int8_t UNKNOWN = -1;
+
+		explicit LevelTable(const std::unordered_map<char32_t, int>& levels);
+
+		std::int8_t Get(char32_t codepoint) const;
+		int GetMaxLevel() const;
+
+	private:
+		std::vector<std::int8_t> levels;
+		int max_level{0};
+	};
+
+	struct KanjiAnnotation
+	{
+		std::string kanji;
+		// Empty when the kanji is not being reviewed
+		std::optional<int> level;
+		std::size_t count{};
+	};
+
+	struct AnnotationSummary
+	{
+		std::size_t total_kanji{};
+		std::size_t known_kanji{};
+		std::size_t unknown_kanji{};
+		std::size_t distinct_kanji{};
+		std::size_t distinct_known{};
+		// Share of kanji occurrences that are being reviewed
+		double coverage{};
+		// Occurrences per SRS level
+		std::vector<std::size_t> level_counts;
+	};
+
+	struct AnnotationResult
+	{
+		// One entry per distinct kanji, in order of first appearance
+		std::vector<KanjiAnnotation> kanjis;
+		AnnotationSummary summary;
+	};
+
+	AnnotationResult Annotate(std::string_view text, const LevelTable& table);
+
+	void to_json(nlohmann::json& j, const KanjiAnnotation& annotation);
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(AnnotationSummary, total_kanji, known_kanji, unknown_kanji, distinct_kanji,
+	                                   distinct_known, coverage, level_counts)
+	void to_json(nlohmann::json& j, const AnnotationResult& result);
+} // namespace kanji::annotation
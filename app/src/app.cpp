@@ -1,23 +1,42 @@
 #include "app.h"
 #include "auth/telegram_auth.h"
+#include "http/request_parsers.h"
+#include "importer/kanji_importer.h"
 #include "notification/telegram_notification_service.h"
+#include "utils/json_writer.h"
+#include <cstdlib>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <spdlog/spdlog.h>
+#include <string>
 
 namespace kanji
 {
-
 	KanjiApp::KanjiApp(const config::KanjiAppConfig& in_config)
 	    : config{in_config}
-	    , db{system::PlatformInfo::GetDatabaseLocation()}
-	    , controller{db, std::make_unique<scheduler::WaniKaniScheduler>()}
-	    , auth_service{std::make_shared<auth::AuthService>(config.auth, config.notification.telegram.chat_id)}
+	    , db{system::PlatformInfo::GetDatabaseLocation(), config.database}
+	    , controller{db, std::make_unique<scheduler::WaniKaniScheduler>(),
+	                 std::make_shared<catalog::CatalogStore>(db, db.GetCatalogSnapshotPath()), db.GetAnswerJournal()}
+	    , auth_service{std::make_shared<auth::AuthService>(
+	          config.auth, config.database.multi_tenant.enabled ? std::nullopt : std::optional{config.notification.telegram.chat_id})}
+	    , admission{config.admission.enabled ? std::make_shared<http::AdmissionController>(config.admission) : nullptr}
 	{
+		if (const auto& multi_tenant = config.database.multi_tenant; multi_tenant.enabled)
+		{
+			// Learners share the main database's catalog; only the configured chat id keeps using the main database
+			const auto shard_directory = db.GetPath().parent_path() / multi_tenant.shard_directory;
+			tenants = std::make_unique<tenancy::TenantRegistry>(shard_directory, db.GetPath(), config.database,
+			                                                    controller.GetCatalogStore(),
+			                                                    static_cast<std::size_t>(multi_tenant.max_open_shards));
+			spdlog::info("Multi-tenant mode: learner shards in {0}", shard_directory.string());
+		}
+
 		using TelegramService = notification::TelegramNotificationService;
 		auto telegram_service = std::make_unique<TelegramService>(config.notification.telegram);
 		const auto interval = std::chrono::minutes{config.notification.refresh_interval};
-		notifier = std::make_unique<notification::ReviewNotifier>(db, std::move(telegram_service), interval);
+		notifier = std::make_unique<notification::ReviewNotifier>(controller, std::move(telegram_service), interval);
 		notifier->Start();
+		due_counts.Start();
 
 		SetupMiddlewares();
 		RegisterRoutes();
@@ -25,7 +44,90 @@ namespace kanji
 
 	void KanjiApp::Run()
 	{
-		app.bindaddr("127.0.0.1").port(8080).run();
+		app.bindaddr("127.0.0.1").port(8080).multithreaded().run();
+	}
+
+	std::optional<KanjiApp::Session> KanjiApp::OpenSession(const crow::request& req)
+	{
+		return OpenSession(app.get_context<auth::JwtMiddleware>(req).user_id);
+	}
+
+	std::optional<KanjiApp::Session> KanjiApp::OpenSession(const std::string& user_id)
+	{
+		if (IsOwner(user_id))
+		{
+			return Session{controller, responses, nullptr};
+		}
+
+		auto tenant = tenants->Acquire(user_id);
+		if (!tenant)
+		{
+			return std::nullopt;
+		}
+		return Session{tenant->controller, tenant->responses, std::move(tenant)};
+	}
+
+	bool KanjiApp::IsOwner(const crow::request& req)
+	{
+		return IsOwner(app.get_context<auth::JwtMiddleware>(req).user_id);
+	}
+
+	bool KanjiApp::IsOwner(const std::string& user_id)
+	{
+		return !tenants || user_id == std::to_string(config.notification.telegram.chat_id);
+	}
+
+	std::optional<std::string_view> KanjiApp::ReadBody(const crow::request& req, std::string& storage, std::string& error)
+	{
+		return http::ToJson(req.body, http::RequestFormat(req.get_header_value("Content-Type")), storage, error);
+	}
+
+	crow::response KanjiApp::Respond(const crow::request& req, int code, std::string json)
+	{
+		const auto format = http::NegotiateFormat(req.get_header_value("Accept"));
+		auto res = crow::response(code, http::FromJson(std::move(json), format));
+		res.set_header("Content-Type", std::string{http::GetMediaType(format)});
+		res.set_header("Vary", "Accept");
+		return res;
+	}
+
+	crow::response KanjiApp::RespondCached(const crow::request& req, Session& session, const std::string& key,
+	                                       std::string_view version, const std::function<std::string()>& build)
+	{
+		const auto format = http::NegotiateFormat(req.get_header_value("Accept"));
+		const auto suffix = http::GetSuffix(format);
+
+		// The user id keeps a tag from one login from validating another learner's body
+		std::string tag = app.get_context<auth::JwtMiddleware>(req).user_id + "-" + std::string{version};
+		std::string format_key = key;
+		if (!suffix.empty())
+		{
+			tag += "-";
+			tag += suffix;
+			format_key += ";";
+			format_key += suffix;
+		}
+		const std::string etag = http::MakeETag(tag);
+
+		crow::response res;
+		res.set_header("ETag", etag);
+		// Browsers may keep the body but must revalidate it on every use
+		res.set_header("Cache-Control", "no-cache");
+		res.set_header("Vary", "Accept");
+		if (http::MatchesIfNoneMatch(req.get_header_value("If-None-Match"), etag))
+		{
+			res.code = 304;
+			return res;
+		}
+
+		auto body = session.responses.Find(format_key, etag);
+		if (!body)
+		{
+			body = session.responses.Store(format_key, etag, http::FromJson(build(), format));
+		}
+		res.set_header("Content-Type", std::string{http::GetMediaType(format)});
+		res.body = *body;
+		return res;
 	}
 
 	void KanjiApp::SetupMiddlewares()
@@ -34,17 +136,37 @@ namespace kanji
 		cors.global()
 		    .origin("http://localhost:5173")
 		    .methods("GET"_method, "POST"_method)
-		    .headers("Content-Type", "Authorization");
+		    .headers("Content-Type", "Authorization", "If-None-Match");
 
 		app.get_middleware<auth::JwtMiddleware>().auth_service = auth_service;
+		app.get_middleware<http::AdmissionMiddleware>().admission = admission;
 	}
 
 	void KanjiApp::RegisterRoutes()
 	{
 		CROW_ROUTE(app, "/api/login").methods("POST"_method)([&](const crow::request& req) {
-			auto j = nlohmann::json::parse(req.body);
-			auth::TelegramAuthData data = j.get<auth::TelegramAuthData>();
-			spdlog::debug("Login request body: {}", req.body);
+			std::string storage;
+			std::string error;
+			const auto body = ReadBody(req, storage, error);
+			if (!body)
+			{
+				return crow::response(400, error);
+			}
+			const auto j = nlohmann::json::parse(*body, nullptr, false);
+			if (j.is_discarded() || !j.is_object())
+			{
+				return crow::response(400, "Expected a Telegram login object");
+			}
+			auth::TelegramAuthData data;
+			try
+			{
+				data = j.get<auth::TelegramAuthData>();
+			}
+			catch (const nlohmann::json::exception& e)
+			{
+				return crow::response(400, e.what());
+			}
+			spdlog::debug("Login request body: {}", *body);
 			spdlog::info("Login attempt: id={}, username={}", data.id, data.username);
 
 			if (!auth::VerifyTelegramAuth(data, config.notification.telegram.bot_token))
@@ -55,46 +177,267 @@ namespace kanji
 
 			auto token = auth_service->GenerateToken(data.id);
 			nlohmann::json resp = {{"token", token}};
-			auto res = crow::response(resp.dump());
-			res.set_header("Content-Type", "application/json");
-			return res;
+			return Respond(req, 200, resp.dump());
 		});
 
-		CROW_ROUTE(app, "/api/reviews").methods("GET"_method)([&]() {
-			std::lock_guard lock(controller_mutex);
-			nlohmann::json j = controller.GetReviewKanjis();
-			auto res = crow::response(j.dump());
-			res.set_header("Content-Type", "application/json");
-			return res;
+		CROW_ROUTE(app, "/api/reviews").methods("GET"_method)([&](const crow::request& req) {
+			auto session = OpenSession(req);
+			if (!session)
+			{
+				return crow::response(403);
+			}
+			// Reviews also fall due as time passes, so the due count is part of the version
+			auto& controller = session->controller;
+			const std::string version =
+			    std::to_string(controller.GetRevision()) + "." + std::to_string(controller.CountDueReviews());
+			return RespondCached(req, *session, "reviews", version, [&] { return controller.GetReviewKanjisJson(); });
 		});
 
 		CROW_ROUTE(app, "/api/answers").methods("POST"_method)([&](const crow::request& req) {
-			std::lock_guard lock(controller_mutex);
-			auto j = nlohmann::json::parse(req.body);
-			controller.SetAnswers(j["answers"]);
+			auto session = OpenSession(req);
+			if (!session)
+			{
+				return crow::response(403);
+			}
+			std::string storage;
+			std::string error;
+			const auto body = ReadBody(req, storage, error);
+			if (!body)
+			{
+				return crow::response(400, error);
+			}
+			const auto answers = http::ParseAnswers(*body, error);
+			if (!answers)
+			{
+				return crow::response(400, error);
+			}
+			session->controller.SetAnswers(*answers);
+			due_counts.Notify();
 			return crow::response(200);
 		});
 
-		CROW_ROUTE(app, "/api/learn-more").methods("POST"_method)([&]() {
-			std::lock_guard lock(controller_mutex);
-			controller.LearnMoreKanjis();
-			return crow::response(200);
+		CROW_ROUTE(app, "/api/learn-more").methods("POST"_method)([&](const crow::request& req) {
+			// Batch size comes from ?count= or a {"count": n} body; both are optional
+			int count = Controller::DEFAULT_LEARN_COUNT;
+			if (const char* count_param = req.url_params.get("count"))
+			{
+				count = std::atoi(count_param);
+			}
+			else if (!req.body.empty())
+			{
+				std::string storage;
+				std::string error;
+				const auto body = ReadBody(req, storage, error);
+				if (!body)
+				{
+					return crow::response(400, error);
+				}
+				const auto j = nlohmann::json::parse(*body, nullptr, false);
+				if (j.is_discarded() || !j.is_object() || (j.contains("count") && !j["count"].is_number_integer()))
+				{
+					return crow::response(400, "Expected {\"count\": n}");
+				}
+				count = j.value("count", count);
+			}
+			if (count <= 0)
+			{
+				return crow::response(400, "count must be positive");
+			}
+
+			auto session = OpenSession(req);
+			if (!session)
+			{
+				return crow::response(403);
+			}
+			const auto ids = session->controller.LearnMoreKanjis(count);
+			due_counts.Notify();
+			std::string body;
+			utils::json::Writer writer{body};
+			writer.BeginObject();
+			writer.Field("ids", ids);
+			writer.EndObject();
+			return Respond(req, 200, std::move(body));
 		});
 
-		CROW_ROUTE(app, "/api/kanjis").methods("GET"_method)([&]() {
-			std::lock_guard lock(controller_mutex);
-			nlohmann::json j = controller.GetKanjis();
-			auto res = crow::response(j.dump());
-			res.set_header("Content-Type", "application/json");
-			return res;
+		// Browsers cannot set headers on a websocket, so the stream is opened with a ticket from here
+		CROW_ROUTE(app, "/api/reviews/stream-ticket").methods("POST"_method)([&](const crow::request& req) {
+			const auto ticket = stream_tickets.Issue(app.get_context<auth::JwtMiddleware>(req).user_id);
+			if (ticket.empty())
+			{
+				return crow::response(503, "No stream ticket available, retry shortly");
+			}
+			std::string body;
+			utils::json::Writer writer{body};
+			writer.BeginObject();
+			writer.Field("ticket", ticket);
+			writer.Field("expires_in", stream_tickets.GetLifetime().count());
+			writer.EndObject();
+			return Respond(req, 200, std::move(body));
+		});
+
+		// Pushes {"type":"due","count":n} whenever the due count changes, plus periodic heartbeats.
+		// Authenticated by a ?ticket= from POST /api/reviews/stream-ticket, never by the JWT itself.
+		CROW_WEBSOCKET_ROUTE(app, "/api/reviews/stream")
+		    .onaccept([&](const crow::request& req, void** userdata) {
+			    const char* ticket = req.url_params.get("ticket");
+			    if (!ticket)
+			    {
+				    return false;
+			    }
+			    auto user_id = stream_tickets.Redeem(ticket);
+			    if (!user_id)
+			    {
+				    spdlog::warn("Review stream rejected: unknown, used or expired ticket");
+				    return false;
+			    }
+			    *userdata = new DueStream{std::move(*user_id), std::nullopt};
+			    return true;
+		    })
+		    .onopen([&](crow::websocket::connection& conn) {
+			    auto* stream = static_cast<DueStream*>(conn.userdata());
+			    auto session = OpenSession(stream->user_id);
+			    if (!session)
+			    {
+				    conn.close("learner shard unavailable");
+				    return;
+			    }
+			    // send_text queues the frame on the connection's own thread, so the broadcaster never waits on a socket
+			    stream->id = due_counts.Subscribe(session->controller, std::move(session->tenant),
+			                                      [&conn](const std::string& message) { conn.send_text(message); });
+		    })
+		    .onclose([&](crow::websocket::connection& conn, const std::string&, std::uint16_t) {
+			    auto* stream = static_cast<DueStream*>(conn.userdata());
+			    if (stream->id)
+			    {
+				    due_counts.Unsubscribe(*stream->id);
+			    }
+			    delete stream;
+		    })
+		    .onmessage([](crow::websocket::connection&, const std::string&, bool) {});
+
+		CROW_ROUTE(app, "/api/kanjis").methods("GET"_method)([&](const crow::request& req) {
+			auto session = OpenSession(req);
+			if (!session)
+			{
+				return crow::response(403);
+			}
+			auto& controller = session->controller;
+			const std::string version = std::to_string(controller.GetRevision());
+
+			// Without a limit the whole list goes out in one body
+			const char* limit = req.url_params.get("limit");
+			if (!limit)
+			{
+				return RespondCached(req, *session, "kanjis", version, [&] { return controller.GetKanjisJson(); });
+			}
+
+			std::optional<database::KanjiCursor> after;
+			const char* cursor = req.url_params.get("cursor");
+			if (cursor)
+			{
+				after = database::KanjiCursor::Parse(cursor);
+				if (!after)
+				{
+					return crow::response(400, "invalid cursor");
+				}
+			}
+
+			const int page_size = std::atoi(limit);
+			const std::string key = "kanjis?limit=" + std::to_string(page_size) + "&cursor=" + (cursor ? cursor : "");
+			return RespondCached(req, *session, key, version,
+			                     [&] { return controller.GetKanjiPageJson(after, page_size); });
 		});
 
 		CROW_ROUTE(app, "/api/kanjis").methods("POST"_method)([&](const crow::request& req) {
-			std::lock_guard lock(controller_mutex);
-			auto j = nlohmann::json::parse(req.body);
-			std::vector<KanjiData> kanjis = j["kanjis"];
-			controller.BatchAddKanjis(kanjis);
-			return crow::response(200);
+			if (!IsOwner(req))
+			{
+				return crow::response(403);
+			}
+
+			// Kanjis always go into the shared catalog through the main controller, one chunk per
+			// write so answers keep flowing during a large import. Binary bodies are decoded in place
+			// rather than transcoded, so no format ever holds the whole payload as a document.
+			const auto format = http::RequestFormat(req.get_header_value("Content-Type"));
+			importer::KanjiImporter importer{
+			    [&](const std::vector<KanjiData>& chunk) { return controller.BatchAddKanjis(chunk); }};
+			const auto report = importer.Import(req.body, http::GetInputFormat(format));
+			due_counts.Notify();
+
+			nlohmann::json j = report;
+			return Respond(req, report.error.empty() ? 200 : 400, j.dump());
+		});
+
+		CROW_ROUTE(app, "/api/annotate").methods("POST"_method)([&](const crow::request& req) {
+			auto session = OpenSession(req);
+			if (!session)
+			{
+				return crow::response(403);
+			}
+
+			// Plain text is annotated as-is; JSON, MessagePack and CBOR bodies carry it in "text"
+			std::string_view text = req.body;
+			std::string json_text;
+			const auto& content_type = req.get_header_value("Content-Type");
+			const auto format = http::RequestFormat(content_type);
+			if (format != http::WireFormat::Json || content_type.starts_with("application/json"))
+			{
+				std::string storage;
+				std::string error;
+				const auto body = http::ToJson(req.body, format, storage, error);
+				if (!body)
+				{
+					return crow::response(400, error);
+				}
+				const auto j = nlohmann::json::parse(*body, nullptr, false);
+				if (j.is_discarded() || !j.contains("text") || !j["text"].is_string())
+				{
+					return crow::response(400, "Expected {\"text\": \"...\"}");
+				}
+				json_text = j["text"].get<std::string>();
+				text = json_text;
+			}
+
+			nlohmann::json j = session->controller.Annotate(text);
+			return Respond(req, 200, j.dump());
+		});
+
+		CROW_ROUTE(app, "/api/admin/stats").methods("GET"_method)([&](const crow::request& req) {
+			if (!IsOwner(req))
+			{
+				return crow::response(403);
+			}
+
+			nlohmann::json j = {{"statement_cache", db.GetStatementCacheStats()}, {"catalog", controller.GetCatalogStats()}};
+			if (const auto* journal = db.GetAnswerJournal())
+			{
+				j["write_behind"] = journal->GetStats();
+			}
+			if (tenants)
+			{
+				j["tenants"] = tenants->GetStats();
+			}
+			if (const auto* backups = db.GetBackupService())
+			{
+				j["backup"] = backups->GetStats();
+			}
+			if (admission)
+			{
+				j["admission"] = admission->GetStats();
+			}
+			return Respond(req, 200, j.dump());
+		});
+
+		CROW_ROUTE(app, "/api/admin/backup").methods("POST"_method)([&](const crow::request& req) {
+			auto* backups = db.GetBackupService();
+			if (!IsOwner(req) || !backups)
+			{
+				return crow::response(403);
+			}
+
+			// The copy runs in the background; progress shows up in /api/admin/stats
+			const bool queued = backups->Request();
+			nlohmann::json j = {{"queued", queued}, {"backup", backups->GetStats()}};
+			return Respond(req, queued ? 202 : 409, j.dump());
 		});
 
 		CROW_ROUTE(app, "/")([](const crow::request&, crow::response& res) {
@@ -2,16 +2,25 @@
 
 #include "auth/auth_service.h"
 #include "auth/jwt_middleware.h"
+#include "auth/stream_tickets.h"
 #include "config.h"
 #include "controller.h"
 #include "database/database_context.h"
+#include "http/admission_middleware.h"
+#include "http/response_cache.h"
+#include "http/wire_format.h"
+#include "notification/due_count_broadcaster.h"
 #include "notification/review_notifier.h"
 #include "scheduler/wanikani_scheduler.h"
 #include "system/platform_info.h"
+#include "tenancy/tenant_registry.h"
 #include <crow.h>
 #include <crow/middlewares/cors.h>
+#include <functional>
 #include <memory>
-#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace kanji
 {
@@ -22,15 +31,54 @@ namespace kanji
 		void Run();
 
 	private:
+		// Controller serving one request and its cached responses
+		struct Session
+		{
+			Controller& controller;
+			http::ResponseCache& responses;
+			// Keeps a learner's shard open while the request runs
+			std::shared_ptr<tenancy::Tenant> tenant;
+		};
+
 		void SetupMiddlewares();
 		void RegisterRoutes();
+		// Due-count stream of one websocket connection, kept in its userdata
+		struct DueStream
+		{
+			std::string user_id;
+			std::optional<notification::DueCountBroadcaster::StreamId> id;
+		};
+
+		// Empty when the learner's shard cannot be opened
+		std::optional<Session> OpenSession(const crow::request& req);
+		std::optional<Session> OpenSession(const std::string& user_id);
+		// The configured chat id; the only user allowed to change the shared catalog
+		bool IsOwner(const crow::request& req);
+		bool IsOwner(const std::string& user_id);
+		// JSON text of a small request body, transcoded when it was sent as MessagePack or CBOR
+		std::optional<std::string_view> ReadBody(const crow::request& req, std::string& storage, std::string& error);
+		// Sends a JSON body in the format the client's Accept header asks for
+		crow::response Respond(const crow::request& req, int code, std::string json);
+		// 304 when the client already holds the body for `version`, else the cached or freshly built body.
+		// Each wire format is cached and tagged as its own representation.
+		crow::response RespondCached(const crow::request& req, Session& session, const std::string& key,
+		                             std::string_view version, const std::function<std::string()>& build);
 
 		const config::KanjiAppConfig& config;
 		database::DatabaseContext db;
 		Controller controller;
 		std::unique_ptr<notification::ReviewNotifier> notifier;
 		std::shared_ptr<auth::AuthService> auth_service;
-		crow::App<crow::CORSHandler, auth::JwtMiddleware> app;
-		std::mutex controller_mutex;
+		// Single-use tickets that authenticate the review stream
+		auth::StreamTickets stream_tickets;
+		// Null when admission control is disabled
+		std::shared_ptr<http::AdmissionController> admission;
+		crow::App<crow::CORSHandler, auth::JwtMiddleware, http::AdmissionMiddleware> app;
+		// Serialized read responses of the main controller
+		http::ResponseCache responses;
+		// Learner shards in multi-tenant mode, null otherwise
+		std::unique_ptr<tenancy::TenantRegistry> tenants;
+		// Open due-count streams; declared last so it stops before the controllers it watches go away
+		notification::DueCountBroadcaster due_counts;
 	};
 } // namespace kanji
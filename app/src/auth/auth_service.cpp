@@ -4,7 +4,7 @@
 namespace kanji::auth
 {
 
-	AuthService::AuthService(const kanji::config::AuthSettings& in_auth_settings, int in_allowed_user_id)
+	AuthService::AuthService(const kanji::config::AuthSettings& in_auth_settings, std::optional<int> in_allowed_user_id)
 	    : auth_settings{in_auth_settings}, allowed_user_id{in_allowed_user_id}
 	{
 	}
@@ -24,9 +24,11 @@ namespace kanji::auth
 
 	std::string AuthService::ValidateToken(std::string_view token) const
 	{
-		const auto verifier = jwt::verify()
-		                          .allow_algorithm(jwt::algorithm::hs256{auth_settings.jwt_secret})
-		                          .with_claim("sub", jwt::claim(std::to_string(allowed_user_id)));
+		auto verifier = jwt::verify().allow_algorithm(jwt::algorithm::hs256{auth_settings.jwt_secret});
+		if (allowed_user_id)
+		{
+			verifier.with_claim("sub", jwt::claim(std::to_string(*allowed_user_id)));
+		}
 
 		auto decoded = jwt::decode(std::string{token});
 		verifier.verify(decoded);
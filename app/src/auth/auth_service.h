@@ -1,6 +1,7 @@
 #pragma once
 
 #include "config.h"
+#include <optional>
 #include <string>
 
 namespace kanji::auth
@@ -8,13 +9,15 @@ namespace kanji::auth
 	class AuthService
 	{
 	public:
-		explicit AuthService(const kanji::config::AuthSettings& in_auth_settings, int in_allowed_user_id);
+		// Without an allowed user id any correctly signed subject is accepted (multi-tenant mode)
+		explicit AuthService(const kanji::config::AuthSettings& in_auth_settings, std::optional<int> in_allowed_user_id);
 
 		std::string GenerateToken(int telegram_id) const;
+		// Returns the token subject; throws when the token is invalid
 		std::string ValidateToken(std::string_view token) const;
 
 	private:
 		kanji::config::AuthSettings auth_settings;
-		int allowed_user_id;
+		std::optional<int> allowed_user_id;
 	};
 } // namespace kanji::auth
@@ -2,6 +2,7 @@
 
 #include <crow.h>
 #include <memory>
+#include <string>
 
 namespace kanji::auth
 {
@@ -11,6 +12,8 @@ namespace kanji::auth
 	{
 		struct context
 		{
+			// JWT subject of the authenticated request; empty for public routes
+			std::string user_id;
 		};
 
 		void before_handle(crow::request& req, crow::response& res, context&);
@@ -0,0 +1,67 @@
+#include "stream_tickets.h"
+#include "utils/crypto.h"
+#include <spdlog/spdlog.h>
+
+namespace kanji::auth
+{
+	namespace
+	{
+		// 128 bits, hex-encoded so the ticket needs no escaping in a query string
+		constexpr std::size_t TICKET_BYTES = 16;
+	} // namespace
+
+	StreamTickets::StreamTickets(std::chrono::seconds in_lifetime)
+	    : lifetime{in_lifetime}
+	{
+	}
+
+	std::string StreamTickets::Issue(const std::string& user_id, Clock::time_point now)
+	{
+		const auto random = utils::crypto::RandomBytes(TICKET_BYTES);
+		if (random.value.empty())
+		{
+			spdlog::error("Stream tickets: random source unavailable");
+			return {};
+		}
+
+		std::lock_guard lock{mutex};
+		PruneExpired(now);
+		if (tickets.size() >= MAX_OUTSTANDING)
+		{
+			spdlog::warn("Stream tickets: {} outstanding, refusing a ticket for user {}", tickets.size(), user_id);
+			return {};
+		}
+
+		std::string ticket = random.ToLowerCase();
+		tickets.insert_or_assign(ticket, Ticket{user_id, now + lifetime});
+		return ticket;
+	}
+
+	std::optional<std::string> StreamTickets::Redeem(std::string_view ticket, Clock::time_point now)
+	{
+		std::lock_guard lock{mutex};
+		const auto it = tickets.find(std::string{ticket});
+		if (it == tickets.end())
+		{
+			return std::nullopt;
+		}
+
+		Ticket redeemed = std::move(it->second);
+		tickets.erase(it);
+		if (now >= redeemed.expires_at)
+		{
+			return std::nullopt;
+		}
+		return std::move(redeemed.user_id);
+	}
+
+	std::chrono::seconds StreamTickets::GetLifetime() const
+	{
+		return lifetime;
+	}
+
+	void StreamTickets::PruneExpired(Clock::time_point now)
+	{
+		std::erase_if(tickets, [now](const auto& entry) { return now >= entry.second.expires_at; });
+	}
+} // namespace kanji::auth
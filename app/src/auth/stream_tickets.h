@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kanji::auth
+{
+	// Short-lived, single-use tickets for the review stream. Browsers cannot set headers on a
+	// websocket, so an authenticated POST trades the JWT for a ticket that goes in the URL instead;
+	// a leaked URL is useless once the ticket has been redeemed or has expired.
+	class StreamTickets
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		static constexpr std::chrono::seconds DEFAULT_LIFETIME{30};
+		// Outstanding tickets beyond this are refused until some expire or are redeemed
+		static constexpr std::size_t MAX_OUTSTANDING = 4096;
+
+		explicit StreamTickets(std::chrono::seconds in_lifetime = DEFAULT_LIFETIME);
+
+		// Empty when no ticket could be issued
+		std::string Issue(const std::string& user_id, Clock::time_point now = Clock::now());
+		// The user the ticket was issued to; every ticket is consumed by its first redemption attempt
+		std::optional<std::string> Redeem(std::string_view ticket, Clock::time_point now = Clock::now());
+		std::chrono::seconds GetLifetime() const;
+
+	private:
+		struct Ticket
+		{
+			std::string user_id;
+			Clock::time_point expires_at;
+		};
+
+		void PruneExpired(Clock::time_point now);
+
+		std::chrono::seconds lifetime;
+		std::mutex mutex;
+		std::unordered_map<std::string, Ticket> tickets;
+	};
+} // namespace kanji::auth
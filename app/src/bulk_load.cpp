@@ -0,0 +1,106 @@
+#include "database/connection_pool.h"
+#include "importer/bulk_loader.h"
+#include "system/platform_info.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <string_view>
+
+namespace
+{
+	void PrintUsage()
+	{
+		std::cout << "Usage: KanjiBulkLoad <dump> [--db <path>] [--format jsonl|kanjidic] [--chunk-size <n>] "
+		             "[--threads <n>] [--cache-mib <n>]\n"
+		             "The database must not be in use: stop the server before loading."
+		          << std::endl;
+	}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	using kanji::importer::DumpFormat;
+
+	std::filesystem::path dump_path;
+	std::filesystem::path db_path = kanji::system::PlatformInfo::GetDatabaseLocation();
+	kanji::importer::BulkLoadOptions options;
+	bool format_set = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string_view arg{argv[i]};
+		const bool has_value = i + 1 < argc;
+		if (arg == "--db" && has_value)
+		{
+			db_path = argv[++i];
+		}
+		else if (arg == "--format" && has_value)
+		{
+			const std::string_view format{argv[++i]};
+			if (format != "jsonl" && format != "kanjidic")
+			{
+				PrintUsage();
+				return 1;
+			}
+			options.format = format == "kanjidic" ? DumpFormat::Kanjidic : DumpFormat::JsonLines;
+			format_set = true;
+		}
+		else if (arg == "--chunk-size" && has_value)
+		{
+			options.chunk_size = std::stoul(argv[++i]);
+		}
+		else if (arg == "--threads" && has_value)
+		{
+			options.threads = static_cast<unsigned int>(std::stoul(argv[++i]));
+		}
+		else if (arg == "--cache-mib" && has_value)
+		{
+			options.cache_size_mib = std::stoi(argv[++i]);
+		}
+		else if (dump_path.empty() && !arg.starts_with("--"))
+		{
+			dump_path = arg;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if (dump_path.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	if (!format_set && dump_path.extension() == ".xml")
+	{
+		options.format = DumpFormat::Kanjidic;
+	}
+
+	std::ifstream input{dump_path, std::ios::binary};
+	if (!input)
+	{
+		spdlog::error("Cannot open {0}", dump_path.string());
+		return 1;
+	}
+
+	kanji::database::ConnectionPool pool{db_path};
+	if (!pool.Initialize())
+	{
+		spdlog::error("Cannot open database {0}", db_path.string());
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto report = kanji::importer::BulkLoader{pool, options}.Load(input);
+	const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+	spdlog::info("Loaded {0} of {1} records into {2} in {3:.2f}s ({4} rejected)", report.inserted, report.records,
+	             db_path.string(), elapsed.count(), report.rejected);
+	return report.rejected == 0 ? 0 : 2;
+}
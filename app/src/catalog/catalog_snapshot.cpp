@@ -0,0 +1,235 @@
+#include "catalog_snapshot.h"
+#include "system/mapped_file.h"
+#include <cstring>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	using namespace kanji::catalog;
+
+	constexpr char MAGIC[8] = {'K', 'J', 'C', 'A', 'T', 'L', 'G', '\0'};
+
+	struct SnapshotHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		// Record sizes guard against struct layout changes between builds
+		std::uint32_t entry_size;
+		std::uint32_t example_size;
+		std::uint32_t reserved;
+		std::uint64_t fingerprint;
+		// Over every byte after the header
+		std::uint64_t checksum;
+		std::uint64_t entry_count;
+		std::uint64_t example_count;
+		std::uint64_t slot_count;
+		std::uint64_t arena_size;
+	};
+
+	static_assert(std::is_trivially_copyable_v<CatalogEntry> && std::is_trivially_copyable_v<CatalogExample>);
+	static_assert(sizeof(SnapshotHeader) % alignof(CatalogEntry) == 0 && sizeof(CatalogEntry) % alignof(CatalogExample) == 0 &&
+	              sizeof(CatalogExample) % alignof(std::uint32_t) == 0);
+
+	// FNV-1a over 64-bit words, then the trailing bytes
+	class Checksum
+	{
+	public:
+		void Update(std::span<const std::byte> bytes)
+		{
+			std::size_t i = 0;
+			for (; i + sizeof(std::uint64_t) <= bytes.size(); i += sizeof(std::uint64_t))
+			{
+				std::uint64_t word;
+				std::memcpy(&word, bytes.data() + i, sizeof(word));
+				Mix(word);
+			}
+			for (; i < bytes.size(); ++i)
+			{
+				Mix(static_cast<std::uint64_t>(bytes[i]));
+			}
+		}
+
+		std::uint64_t Get() const
+		{
+			return hash;
+		}
+
+	private:
+		void Mix(std::uint64_t value)
+		{
+			hash ^= value;
+			hash *= 0x100000001b3ull;
+		}
+
+		std::uint64_t hash{0xcbf29ce484222325ull};
+	};
+
+	template <typename T>
+	std::span<const std::byte> Bytes(std::span<const T> values)
+	{
+		return std::as_bytes(values);
+	}
+
+	bool InArena(StringRef ref, std::uint64_t arena_size)
+	{
+		return static_cast<std::uint64_t>(ref.offset) + ref.length <= arena_size;
+	}
+
+	// Checks that every reference stays inside its table, so a bad file can never be read out of bounds
+	bool ReferencesAreValid(const SnapshotHeader& header, std::span<const CatalogEntry> entries,
+	                        std::span<const CatalogExample> examples, std::span<const std::uint32_t> slots)
+	{
+		for (const auto& entry : entries)
+		{
+			if (!InArena(entry.kanji, header.arena_size) || !InArena(entry.meaning, header.arena_size) ||
+			    static_cast<std::uint64_t>(entry.first_example) + entry.example_count > header.example_count)
+			{
+				return false;
+			}
+		}
+		for (const auto& example : examples)
+		{
+			if (!InArena(example.word, header.arena_size) || !InArena(example.reading, header.arena_size))
+			{
+				return false;
+			}
+		}
+		for (const auto slot : slots)
+		{
+			if (slot > header.entry_count)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace
+
+namespace kanji::catalog
+{
+	std::shared_ptr<const KanjiCatalog> CatalogSnapshot::Load(const std::filesystem::path& path, std::uint64_t fingerprint)
+	{
+		std::shared_ptr<const system::MappedFile> file = system::MappedFile::Open(path);
+		if (!file)
+		{
+			return nullptr;
+		}
+
+		const auto data = file->GetData();
+		SnapshotHeader header{};
+		if (data.size() < sizeof(header))
+		{
+			spdlog::warn("Catalog snapshot {0} is truncated", path.string());
+			return nullptr;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION ||
+		    header.entry_size != sizeof(CatalogEntry) || header.example_size != sizeof(CatalogExample))
+		{
+			spdlog::warn("Catalog snapshot {0} has an unknown format", path.string());
+			return nullptr;
+		}
+
+		if (header.fingerprint != fingerprint)
+		{
+			spdlog::info("Catalog snapshot {0} is stale", path.string());
+			return nullptr;
+		}
+
+		// Counts are checked against the file size before they are used to size anything
+		const std::uint64_t payload_size = data.size() - sizeof(header);
+		if (header.entry_count > payload_size / sizeof(CatalogEntry) || header.example_count > payload_size / sizeof(CatalogExample) ||
+		    header.slot_count > payload_size / sizeof(std::uint32_t) ||
+		    header.entry_count * sizeof(CatalogEntry) + header.example_count * sizeof(CatalogExample) +
+		            header.slot_count * sizeof(std::uint32_t) + header.arena_size !=
+		        payload_size)
+		{
+			spdlog::warn("Catalog snapshot {0} has inconsistent sizes", path.string());
+			return nullptr;
+		}
+
+		const auto payload = data.subspan(sizeof(header));
+		Checksum checksum;
+		checksum.Update(payload);
+		if (checksum.Get() != header.checksum)
+		{
+			spdlog::warn("Catalog snapshot {0} failed its checksum", path.string());
+			return nullptr;
+		}
+
+		const std::byte* cursor = payload.data();
+		const std::span<const CatalogEntry> entries{reinterpret_cast<const CatalogEntry*>(cursor), header.entry_count};
+		cursor += entries.size_bytes();
+		const std::span<const CatalogExample> examples{reinterpret_cast<const CatalogExample*>(cursor), header.example_count};
+		cursor += examples.size_bytes();
+		const std::span<const std::uint32_t> slots{reinterpret_cast<const std::uint32_t*>(cursor), header.slot_count};
+		cursor += slots.size_bytes();
+		const std::string_view arena{reinterpret_cast<const char*>(cursor), header.arena_size};
+
+		if (!ReferencesAreValid(header, entries, examples, slots))
+		{
+			spdlog::warn("Catalog snapshot {0} has out-of-range references", path.string());
+			return nullptr;
+		}
+
+		return std::shared_ptr<const KanjiCatalog>{new KanjiCatalog{std::move(file), arena, entries, examples, slots}};
+	}
+
+	bool CatalogSnapshot::Save(const KanjiCatalog& catalog, const std::filesystem::path& path, std::uint64_t fingerprint)
+	{
+		SnapshotHeader header{};
+		std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+		header.version = FORMAT_VERSION;
+		header.entry_size = sizeof(CatalogEntry);
+		header.example_size = sizeof(CatalogExample);
+		header.fingerprint = fingerprint;
+		header.entry_count = catalog.entries.size();
+		header.example_count = catalog.examples.size();
+		header.slot_count = catalog.slot_by_id.size();
+		header.arena_size = catalog.arena.size();
+
+		const std::span<const std::byte> sections[] = {
+		    Bytes(catalog.entries), Bytes(catalog.examples), Bytes(catalog.slot_by_id),
+		    std::as_bytes(std::span<const char>{catalog.arena.data(), catalog.arena.size()})};
+
+		// The checksum runs over the payload exactly as Load() sees it, so assemble it once
+		std::vector<std::byte> payload;
+		for (const auto& section : sections)
+		{
+			payload.insert(payload.end(), section.begin(), section.end());
+		}
+		Checksum checksum;
+		checksum.Update(payload);
+		header.checksum = checksum.Get();
+
+		auto temp_path = path;
+		temp_path += ".tmp";
+		{
+			std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+			if (!out)
+			{
+				spdlog::error("Failed to write catalog snapshot {0}", temp_path.string());
+				out.close();
+				std::error_code ec;
+				std::filesystem::remove(temp_path, ec);
+				return false;
+			}
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(temp_path, path, ec);
+		if (ec)
+		{
+			spdlog::warn("Failed to replace catalog snapshot {0}: {1}", path.string(), ec.message());
+			std::filesystem::remove(temp_path, ec);
+			return false;
+		}
+		return true;
+	}
+} // namespace kanji::catalog
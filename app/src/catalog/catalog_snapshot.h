@@ -0,0 +1,24 @@
+#pragma once
+
+#include "kanji_catalog.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+namespace kanji::catalog
+{
+	// Binary image of a KanjiCatalog that is memory-mapped and used in place. The file is a fixed
+	// header followed by the entry, example and slot tables and the string arena, laid out exactly
+	// as in memory. A snapshot is only used when its version, checksum and database fingerprint
+	// all match; otherwise callers rebuild from SQLite and save a fresh one.
+	class CatalogSnapshot
+	{
+	public:
+		static constexpr std::uint32_t FORMAT_VERSION = 1;
+
+		// Null when the file is missing, stale or corrupt
+		static std::shared_ptr<const KanjiCatalog> Load(const std::filesystem::path& path, std::uint64_t fingerprint);
+		// Writes to a temporary file and renames it over `path`
+		static bool Save(const KanjiCatalog& catalog, const std::filesystem::path& path, std::uint64_t fingerprint);
+	};
+} // namespace kanji::catalog
@@ -0,0 +1,115 @@
+#include "catalog_store.h"
+#include "catalog_snapshot.h"
+#include "database/storage.h"
+#include <spdlog/spdlog.h>
+
+namespace kanji::catalog
+{
+	CatalogStore::CatalogStore(database::IStorage& in_db, std::filesystem::path in_snapshot_path)
+	    : db{in_db}
+	    , snapshot_path{std::move(in_snapshot_path)}
+	{
+		Publish(Load());
+	}
+
+	CatalogStore::~CatalogStore()
+	{
+		if (dirty && !snapshot_path.empty())
+		{
+			CatalogSnapshot::Save(*Get(), snapshot_path, db.GetKanjiRepository().GetCatalogFingerprint());
+		}
+	}
+
+	std::shared_ptr<const KanjiCatalog> CatalogStore::Get() const
+	{
+		std::lock_guard lock{mutex};
+		return catalog;
+	}
+
+	std::shared_ptr<const JsonFragments> CatalogStore::GetJsonFragments() const
+	{
+		auto current = Get();
+		std::lock_guard lock{fragments_mutex};
+		if (!fragments || fragments->GetCatalog() != current)
+		{
+			fragments = std::make_shared<const JsonFragments>(std::move(current));
+		}
+		return fragments;
+	}
+
+	std::vector<std::uint32_t> CatalogStore::Add(const std::vector<KanjiData>& kanjis)
+	{
+		std::lock_guard add_lock{add_mutex};
+		auto& kanji_repo = db.GetKanjiRepository();
+		const auto inserted_ids = kanji_repo.BatchInsertKanjis(kanjis);
+		if (inserted_ids.empty())
+		{
+			return inserted_ids;
+		}
+
+		auto current = Get();
+		if (!appender || appender->GetLatest() != current)
+		{
+			appender = std::make_unique<KanjiCatalog::Appender>(std::move(current));
+		}
+
+		// Ids line up with the input only when no row was skipped; otherwise reload from the database
+		auto extended = inserted_ids.size() == kanjis.size() ? appender->Append(inserted_ids, kanjis) : nullptr;
+		Publish(extended ? std::move(extended) : kanji_repo.LoadCatalog());
+		// The snapshot file is rewritten once on shutdown rather than after every batch
+		dirty = true;
+		return inserted_ids;
+	}
+
+	std::uint64_t CatalogStore::GetVersion() const
+	{
+		return version.load();
+	}
+
+	CatalogStats CatalogStore::GetStats() const
+	{
+		const auto snapshot = Get();
+		CatalogStats stats{snapshot->Size(), snapshot->GetExampleCount(), snapshot->GetMemoryUsage()};
+		std::lock_guard lock{fragments_mutex};
+		if (fragments && fragments->GetCatalog() == snapshot)
+		{
+			stats.fragment_bytes = fragments->GetMemoryUsage();
+		}
+		return stats;
+	}
+
+	bool CatalogStore::IsBackedBy(const database::IStorage& storage) const
+	{
+		return &db == &storage;
+	}
+
+	std::shared_ptr<const KanjiCatalog> CatalogStore::Load()
+	{
+		auto& kanji_repo = db.GetKanjiRepository();
+		if (snapshot_path.empty())
+		{
+			return kanji_repo.LoadCatalog();
+		}
+
+		const auto fingerprint = kanji_repo.GetCatalogFingerprint();
+		if (auto mapped = CatalogSnapshot::Load(snapshot_path, fingerprint))
+		{
+			return mapped;
+		}
+
+		auto loaded = kanji_repo.LoadCatalog();
+		CatalogSnapshot::Save(*loaded, snapshot_path, fingerprint);
+		return loaded;
+	}
+
+	void CatalogStore::Publish(std::shared_ptr<const KanjiCatalog> in_catalog)
+	{
+		spdlog::info("Kanji catalog: {0} kanjis, {1} examples, {2} KiB", in_catalog->Size(), in_catalog->GetExampleCount(),
+		             in_catalog->GetMemoryUsage() / 1024);
+		{
+			std::lock_guard lock{mutex};
+			catalog = std::move(in_catalog);
+		}
+		++version;
+	}
+} // namespace kanji::catalog
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "kanji.h"
+#include "json_fragments.h"
+#include "kanji_catalog.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace kanji::database
+{
+	class IStorage;
+}
+
+namespace kanji::catalog
+{
+	// Publishes the catalog of one kanji database and keeps its snapshot file current. Shared by
+	// every controller that serves those kanjis, so learners on separate shards see one catalog.
+	class CatalogStore
+	{
+	public:
+		// Maps the snapshot file when it is current, otherwise reads the tables and rewrites it.
+		// Without a snapshot path the catalog is read from the tables and never persisted.
+		explicit CatalogStore(database::IStorage& in_db, std::filesystem::path in_snapshot_path = {});
+		CatalogStore(const CatalogStore&) = delete;
+		CatalogStore& operator=(const CatalogStore&) = delete;
+		~CatalogStore();
+
+		std::shared_ptr<const KanjiCatalog> Get() const;
+		// Fragments of the current catalog, encoded on first use after each publish
+		std::shared_ptr<const JsonFragments> GetJsonFragments() const;
+		// Inserts the kanjis and publishes an extended catalog; returns the new ids
+		std::vector<std::uint32_t> Add(const std::vector<KanjiData>& kanjis);
+		// Bumped on every publish
+		std::uint64_t GetVersion() const;
+		CatalogStats GetStats() const;
+		// True when the kanjis live in `storage` itself rather than in a catalog shared with shards
+		bool IsBackedBy(const database::IStorage& storage) const;
+
+	private:
+		std::shared_ptr<const KanjiCatalog> Load();
+		void Publish(std::shared_ptr<const KanjiCatalog> in_catalog);
+
+		database::IStorage& db;
+		std::filesystem::path snapshot_path;
+		// Readers keep the snapshot they started with
+		mutable std::mutex mutex;
+		std::shared_ptr<const KanjiCatalog> catalog;
+		std::atomic<std::uint64_t> version{0};
+		mutable std::mutex fragments_mutex;
+		mutable std::shared_ptr<const JsonFragments> fragments;
+		// Serializes Add() so two batches never extend the same base
+		std::mutex add_mutex;
+		// Carries the grown tables from one Add to the next, so an import copies the catalog only
+		// when the tables run out of room
+		std::unique_ptr<KanjiCatalog::Appender> appender;
+		// Set when the catalog changed since the snapshot file was written
+		bool dirty{false};
+	};
+} // namespace kanji::catalog
@@ -0,0 +1,108 @@
+#include "json_fragments.h"
+#include "kanji_json.h"
+#include "utils/json_writer.h"
+#include <charconv>
+
+namespace kanji::catalog
+{
+	namespace
+	{
+		void AppendNumber(std::string& out, std::int64_t value)
+		{
+			char digits[24];
+			const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+			out.append(digits, result.ptr);
+		}
+	} // namespace
+
+	JsonFragments::JsonFragments(std::shared_ptr<const KanjiCatalog> in_catalog)
+	    : catalog{std::move(in_catalog)}
+	{
+		const auto entries = catalog->GetEntries();
+		fragments.reserve(entries.size());
+
+		const auto mark = [this](std::size_t start) {
+			return StringRef{static_cast<std::uint32_t>(start), static_cast<std::uint32_t>(arena.size() - start)};
+		};
+
+		for (const auto& entry : entries)
+		{
+			Fragment fragment;
+
+			std::size_t start = arena.size();
+			utils::json::Writer{arena}.Write(catalog->ToKanjiData(entry));
+			fragment.data = mark(start);
+
+			// Same key order as WriteJson(KanjiRecord), cut where the review fields go
+			start = arena.size();
+			utils::json::Writer head{arena};
+			head.BeginObject();
+			head.Field("id", entry.id);
+			head.Field("kanji", catalog->GetString(entry.kanji));
+			head.Key("level");
+			fragment.record_head = mark(start);
+
+			start = arena.size();
+			arena += ',';
+			utils::json::Writer middle{arena};
+			middle.Field("meaning", catalog->GetString(entry.meaning));
+			middle.Key("next_review_date");
+			fragment.record_middle = mark(start);
+
+			fragments.push_back(fragment);
+		}
+		arena.shrink_to_fit();
+	}
+
+	const std::shared_ptr<const KanjiCatalog>& JsonFragments::GetCatalog() const
+	{
+		return catalog;
+	}
+
+	bool JsonFragments::AppendKanjiData(std::string& out, std::uint32_t id) const
+	{
+		const Fragment* fragment = Find(id);
+		if (!fragment)
+		{
+			return false;
+		}
+		Append(out, fragment->data);
+		return true;
+	}
+
+	bool JsonFragments::AppendKanjiRecord(std::string& out, std::uint32_t id, int level,
+	                                      std::int64_t next_review_date) const
+	{
+		const Fragment* fragment = Find(id);
+		if (!fragment)
+		{
+			return false;
+		}
+		Append(out, fragment->record_head);
+		AppendNumber(out, level);
+		Append(out, fragment->record_middle);
+		AppendNumber(out, next_review_date);
+		out += '}';
+		return true;
+	}
+
+	std::size_t JsonFragments::GetMemoryUsage() const
+	{
+		return sizeof(*this) + arena.capacity() + fragments.capacity() * sizeof(Fragment);
+	}
+
+	const JsonFragments::Fragment* JsonFragments::Find(std::uint32_t id) const
+	{
+		const CatalogEntry* entry = catalog->Find(id);
+		if (!entry)
+		{
+			return nullptr;
+		}
+		return &fragments[entry - catalog->GetEntries().data()];
+	}
+
+	void JsonFragments::Append(std::string& out, StringRef ref) const
+	{
+		out.append(arena, ref.offset, ref.length);
+	}
+} // namespace kanji::catalog
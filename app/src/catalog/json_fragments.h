@@ -0,0 +1,44 @@
+#pragma once
+
+#include "kanji_catalog.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace kanji::catalog
+{
+	// Pre-encoded JSON for every kanji of one catalog snapshot. The catalog part of a response never
+	// changes between snapshots, so lists are assembled by copying fragments and splicing in the few
+	// review fields. The output is byte-identical to serializing KanjiData / KanjiRecord.
+	class JsonFragments
+	{
+	public:
+		explicit JsonFragments(std::shared_ptr<const KanjiCatalog> in_catalog);
+
+		const std::shared_ptr<const KanjiCatalog>& GetCatalog() const;
+		// Appends the KanjiData object for `id`; false when the id is not in the catalog
+		bool AppendKanjiData(std::string& out, std::uint32_t id) const;
+		// Appends the KanjiRecord object for `id` with its review fields; false when the id is not in the catalog
+		bool AppendKanjiRecord(std::string& out, std::uint32_t id, int level, std::int64_t next_review_date) const;
+		std::size_t GetMemoryUsage() const;
+
+	private:
+		// Slices of `arena`. A record is head + level + middle + next_review_date + "}"
+		struct Fragment
+		{
+			StringRef data;
+			StringRef record_head;
+			StringRef record_middle;
+		};
+
+		const Fragment* Find(std::uint32_t id) const;
+		void Append(std::string& out, StringRef ref) const;
+
+		std::shared_ptr<const KanjiCatalog> catalog;
+		std::string arena;
+		// Parallel to catalog->GetEntries()
+		std::vector<Fragment> fragments;
+	};
+} // namespace kanji::catalog
@@ -0,0 +1,236 @@
+#include "kanji_catalog.h"
+#include <algorithm>
+
+namespace kanji::catalog
+{
+	struct KanjiCatalog::OwnedTables
+	{
+		std::string arena;
+		std::vector<CatalogEntry> entries;
+		std::vector<CatalogExample> examples;
+		std::vector<std::uint32_t> slot_by_id;
+	};
+
+	KanjiCatalog::Builder::Builder()
+	    : tables{std::make_unique<OwnedTables>()}
+	{
+	}
+
+	KanjiCatalog::Builder::Builder(const KanjiCatalog& base)
+	    : tables{std::make_unique<OwnedTables>()}
+	{
+		tables->arena.assign(base.arena);
+		tables->entries.assign(base.entries.begin(), base.entries.end());
+		tables->examples.assign(base.examples.begin(), base.examples.end());
+	}
+
+	KanjiCatalog::Builder::~Builder() = default;
+
+	void KanjiCatalog::Builder::Add(std::uint32_t id, std::string_view kanji, std::string_view meaning)
+	{
+		CatalogEntry& entry = tables->entries.emplace_back();
+		entry.id = id;
+		entry.kanji = Store(kanji);
+		entry.meaning = Store(meaning);
+		entry.first_example = static_cast<std::uint32_t>(tables->examples.size());
+	}
+
+	void KanjiCatalog::Builder::AddExample(std::string_view word, std::string_view reading)
+	{
+		if (tables->entries.empty())
+		{
+			return;
+		}
+
+		tables->examples.push_back({Store(word), Store(reading)});
+		++tables->entries.back().example_count;
+	}
+
+	void KanjiCatalog::Builder::Add(std::uint32_t id, const KanjiData& kanji)
+	{
+		Add(id, kanji.kanji, kanji.meaning);
+		for (const auto& example : kanji.examples)
+		{
+			AddExample(example.word, example.reading);
+		}
+	}
+
+	std::shared_ptr<const KanjiCatalog> KanjiCatalog::Builder::Build()
+	{
+		auto& entries = tables->entries;
+		std::stable_sort(entries.begin(), entries.end(), [](const CatalogEntry& a, const CatalogEntry& b) {
+			return a.id < b.id;
+		});
+
+		const std::uint32_t max_id = entries.empty() ? 0 : entries.back().id;
+		tables->slot_by_id.assign(static_cast<std::size_t>(max_id) + 1, 0);
+		for (std::size_t i = 0; i < entries.size(); ++i)
+		{
+			// A later entry for the same id wins
+			tables->slot_by_id[entries[i].id] = static_cast<std::uint32_t>(i + 1);
+		}
+
+		tables->arena.shrink_to_fit();
+		entries.shrink_to_fit();
+		tables->examples.shrink_to_fit();
+
+		std::shared_ptr<const OwnedTables> owned{std::move(tables)};
+		tables = std::make_unique<OwnedTables>();
+		return std::shared_ptr<const KanjiCatalog>{
+		    new KanjiCatalog{owned, owned->arena, owned->entries, owned->examples, owned->slot_by_id}};
+	}
+
+	StringRef KanjiCatalog::Builder::Store(std::string_view text)
+	{
+		const StringRef ref{static_cast<std::uint32_t>(tables->arena.size()), static_cast<std::uint32_t>(text.size())};
+		tables->arena.append(text);
+		return ref;
+	}
+
+	KanjiCatalog::Appender::Appender(std::shared_ptr<const KanjiCatalog> in_base)
+	    : latest{std::move(in_base)}
+	{
+	}
+
+	KanjiCatalog::Appender::~Appender() = default;
+
+	std::shared_ptr<const KanjiCatalog> KanjiCatalog::Appender::Append(std::span<const std::uint32_t> ids,
+	                                                                   const std::vector<KanjiData>& kanjis)
+	{
+		if (ids.size() != kanjis.size() || ids.empty())
+		{
+			return nullptr;
+		}
+
+		// Entries stay sorted by id only while every new id is above the last one
+		std::uint32_t last_id = latest->entries.empty() ? 0 : latest->entries.back().id;
+		std::size_t arena_size = latest->arena.size();
+		std::size_t example_count = latest->examples.size();
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			if (ids[i] <= last_id)
+			{
+				return nullptr;
+			}
+			last_id = ids[i];
+			arena_size += kanjis[i].kanji.size() + kanjis[i].meaning.size();
+			for (const auto& example : kanjis[i].examples)
+			{
+				arena_size += example.word.size() + example.reading.size();
+			}
+			example_count += kanjis[i].examples.size();
+		}
+		const std::size_t entry_count = latest->entries.size() + ids.size();
+		const std::size_t slot_count = std::max(latest->slot_by_id.size(), static_cast<std::size_t>(last_id) + 1);
+
+		const bool in_place = tables && tables.get() == latest->storage.get() && tables->arena.capacity() >= arena_size &&
+		                      tables->entries.capacity() >= entry_count && tables->examples.capacity() >= example_count &&
+		                      tables->slot_by_id.capacity() >= slot_count;
+		if (!in_place)
+		{
+			// Published snapshots keep the old tables; the copy gets twice the room it needs
+			auto grown = std::make_shared<OwnedTables>();
+			grown->arena.reserve(arena_size * 2);
+			grown->arena.assign(latest->arena);
+			grown->entries.reserve(entry_count * 2);
+			grown->entries.assign(latest->entries.begin(), latest->entries.end());
+			grown->examples.reserve(example_count * 2);
+			grown->examples.assign(latest->examples.begin(), latest->examples.end());
+			grown->slot_by_id.reserve(slot_count * 2);
+			grown->slot_by_id.assign(latest->slot_by_id.begin(), latest->slot_by_id.end());
+			tables = std::move(grown);
+		}
+
+		// Only memory past the end of every published view is written from here on
+		const auto store = [&](std::string_view text) {
+			const StringRef ref{static_cast<std::uint32_t>(tables->arena.size()), static_cast<std::uint32_t>(text.size())};
+			tables->arena.append(text);
+			return ref;
+		};
+		tables->slot_by_id.resize(slot_count, 0);
+		for (std::size_t i = 0; i < ids.size(); ++i)
+		{
+			CatalogEntry& entry = tables->entries.emplace_back();
+			entry.id = ids[i];
+			entry.kanji = store(kanjis[i].kanji);
+			entry.meaning = store(kanjis[i].meaning);
+			entry.first_example = static_cast<std::uint32_t>(tables->examples.size());
+			for (const auto& example : kanjis[i].examples)
+			{
+				tables->examples.push_back({store(example.word), store(example.reading)});
+				++entry.example_count;
+			}
+			tables->slot_by_id[entry.id] = static_cast<std::uint32_t>(tables->entries.size());
+		}
+
+		latest = std::shared_ptr<const KanjiCatalog>{
+		    new KanjiCatalog{tables, tables->arena, tables->entries, tables->examples, tables->slot_by_id}};
+		return latest;
+	}
+
+	const std::shared_ptr<const KanjiCatalog>& KanjiCatalog::Appender::GetLatest() const
+	{
+		return latest;
+	}
+
+	KanjiCatalog::KanjiCatalog(std::shared_ptr<const void> in_storage, std::string_view in_arena,
+	                           std::span<const CatalogEntry> in_entries, std::span<const CatalogExample> in_examples,
+	                           std::span<const std::uint32_t> in_slot_by_id)
+	    : storage{std::move(in_storage)}
+	    , arena{in_arena}
+	    , entries{in_entries}
+	    , examples{in_examples}
+	    , slot_by_id{in_slot_by_id}
+	{
+	}
+
+	const CatalogEntry* KanjiCatalog::Find(std::uint32_t id) const
+	{
+		if (id >= slot_by_id.size() || slot_by_id[id] == 0)
+		{
+			return nullptr;
+		}
+		return &entries[slot_by_id[id] - 1];
+	}
+
+	std::string_view KanjiCatalog::GetString(StringRef ref) const
+	{
+		return arena.substr(ref.offset, ref.length);
+	}
+
+	std::span<const CatalogExample> KanjiCatalog::GetExamples(const CatalogEntry& entry) const
+	{
+		return examples.subspan(entry.first_example, entry.example_count);
+	}
+
+	std::span<const CatalogEntry> KanjiCatalog::GetEntries() const
+	{
+		return entries;
+	}
+
+	KanjiData KanjiCatalog::ToKanjiData(const CatalogEntry& entry) const
+	{
+		KanjiData kanji{entry.id, std::string{GetString(entry.kanji)}, std::string{GetString(entry.meaning)}, {}};
+		kanji.examples.reserve(entry.example_count);
+		for (const auto& example : GetExamples(entry))
+		{
+			kanji.examples.push_back({std::string{GetString(example.word)}, std::string{GetString(example.reading)}});
+		}
+		return kanji;
+	}
+
+	std::size_t KanjiCatalog::Size() const
+	{
+		return entries.size();
+	}
+
+	std::size_t KanjiCatalog::GetExampleCount() const
+	{
+		return examples.size();
+	}
+
+	std::size_t KanjiCatalog::GetMemoryUsage() const
+	{
+		return sizeof(*this) + arena.size() + entries.size_bytes() + examples.size_bytes() + slot_by_id.size_bytes();
+	}
+} // namespace kanji::catalog
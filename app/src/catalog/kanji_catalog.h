@@ -0,0 +1,127 @@
+#pragma once
+
+#include "kanji.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kanji::catalog
+{
+	// Slice of the catalog arena
+	struct StringRef
+	{
+		std::uint32_t offset{};
+		std::uint32_t length{};
+	};
+
+	struct CatalogExample
+	{
+		StringRef word;
+		StringRef reading;
+	};
+
+	struct CatalogEntry
+	{
+		std::uint32_t id{};
+		StringRef kanji;
+		StringRef meaning;
+		std::uint32_t first_example{};
+		std::uint32_t example_count{};
+	};
+
+	class CatalogSnapshot;
+
+	// Read-only snapshot of kanji text, meanings and examples. Every string lives in one arena and
+	// each kanji is a fixed-size entry, so lookups neither touch SQLite nor allocate. A new
+	// snapshot is built and swapped in whenever kanjis are added. The tables are either owned or
+	// point straight into a memory-mapped snapshot file.
+	class KanjiCatalog
+	{
+		struct OwnedTables;
+
+	public:
+		class Builder
+		{
+		public:
+			Builder();
+			~Builder();
+			// Starts from a copy of an existing snapshot so new kanjis can be appended
+			explicit Builder(const KanjiCatalog& base);
+
+			void Add(std::uint32_t id, std::string_view kanji, std::string_view meaning);
+			// Attaches an example to the most recently added kanji
+			void AddExample(std::string_view word, std::string_view reading);
+			void Add(std::uint32_t id, const KanjiData& kanji);
+
+			std::shared_ptr<const KanjiCatalog> Build();
+
+		private:
+			StringRef Store(std::string_view text);
+
+			std::unique_ptr<OwnedTables> tables;
+		};
+
+		// Extends a catalog chunk after chunk without copying it each time. Tables are reserved with
+		// room to spare and appended in place; each snapshot views only the rows that existed when it
+		// was published, so later rows never move under a reader. A copy happens only when the tables
+		// run out of room, which keeps a long import linear in its size.
+		class Appender
+		{
+		public:
+			explicit Appender(std::shared_ptr<const KanjiCatalog> in_base);
+			~Appender();
+
+			// Null when an id is not above every id already in the catalog; the caller rebuilds instead
+			std::shared_ptr<const KanjiCatalog> Append(std::span<const std::uint32_t> ids,
+			                                           const std::vector<KanjiData>& kanjis);
+			// The base, or the snapshot returned by the last Append
+			const std::shared_ptr<const KanjiCatalog>& GetLatest() const;
+
+		private:
+			std::shared_ptr<const KanjiCatalog> latest;
+			// Backs `latest` once the first chunk has been appended
+			std::shared_ptr<OwnedTables> tables;
+		};
+
+		// Null when the id is not in the catalog
+		const CatalogEntry* Find(std::uint32_t id) const;
+		std::string_view GetString(StringRef ref) const;
+		std::span<const CatalogExample> GetExamples(const CatalogEntry& entry) const;
+		std::span<const CatalogEntry> GetEntries() const;
+		KanjiData ToKanjiData(const CatalogEntry& entry) const;
+
+		std::size_t Size() const;
+		std::size_t GetExampleCount() const;
+		// Bytes of the arena and index tables, owned or mapped
+		std::size_t GetMemoryUsage() const;
+
+	private:
+		friend class CatalogSnapshot;
+
+		KanjiCatalog(std::shared_ptr<const void> in_storage, std::string_view in_arena, std::span<const CatalogEntry> in_entries,
+		             std::span<const CatalogExample> in_examples, std::span<const std::uint32_t> in_slot_by_id);
+
+		// Keeps whatever backs the views below alive
+		std::shared_ptr<const void> storage;
+		std::string_view arena;
+		std::span<const CatalogEntry> entries;
+		std::span<const CatalogExample> examples;
+		// Entry position + 1 per kanji id, 0 when absent
+		std::span<const std::uint32_t> slot_by_id;
+	};
+
+	struct CatalogStats
+	{
+		std::size_t kanjis{};
+		std::size_t examples{};
+		std::size_t memory_bytes{};
+		// Pre-encoded JSON of the current snapshot; 0 until a list is first served
+		std::size_t fragment_bytes{};
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(CatalogStats, kanjis, examples, memory_bytes, fragment_bytes)
+} // namespace kanji::catalog
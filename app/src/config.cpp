@@ -4,6 +4,14 @@
 
 namespace kanji::config
 {
+	void from_json(const nlohmann::json& j, KanjiAppConfig& config)
+	{
+		j.at("notification").get_to(config.notification);
+		j.at("auth").get_to(config.auth);
+		config.database = j.value("database", DatabaseSettings{});
+		config.admission = j.value("admission", AdmissionSettings{});
+	}
+
 	KanjiAppConfig KanjiAppConfig::LoadFromFile(const std::filesystem::path& path)
 	{
 		std::ifstream file{path};
@@ -14,6 +22,20 @@ namespace kanji::config
 
 		nlohmann::json j;
 		file >> j;
-		return j.get<KanjiAppConfig>();
+		auto config = j.get<KanjiAppConfig>();
+		if (config.auth.jwt_secret.empty())
+		{
+			throw std::runtime_error{"KanjiAppConfig: auth.jwt_secret is required"};
+		}
+		// Telegram logins are verified with a key derived from the bot token, and the chat id is the owner
+		if (config.notification.telegram.bot_token.empty())
+		{
+			throw std::runtime_error{"KanjiAppConfig: notification.telegram.bot_token is required"};
+		}
+		if (config.notification.telegram.chat_id == 0)
+		{
+			throw std::runtime_error{"KanjiAppConfig: notification.telegram.chat_id is required"};
+		}
+		return config;
 	}
 } // namespace kanji::config
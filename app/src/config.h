@@ -25,17 +25,101 @@ namespace kanji::config
 		int token_expiry_hours{24};
 	};
 
+	enum class FsyncPolicy
+	{
+		// fsync every append before the answer is acknowledged
+		Always,
+		// fsync once per flush cycle
+		Interval,
+		// leave syncing to the OS
+		Never
+	};
+
+	struct WriteBehindSettings
+	{
+		// When enabled, answers are journaled and acknowledged before they reach SQLite
+		bool enabled{false};
+		int flush_interval_ms{1000};
+		// Pending states that trigger an early flush; also the most rows written per transaction
+		int batch_size{500};
+		FsyncPolicy fsync{FsyncPolicy::Interval};
+	};
+
+	struct BackupSettings
+	{
+		// Scheduled backups; POST /api/admin/backup works either way
+		bool enabled{false};
+		// Relative to the database's directory unless absolute
+		std::string directory{"backups"};
+		int interval_minutes{1440};
+		// Newest backups kept; older ones are deleted after each successful backup
+		int retention{7};
+		// Pages copied while holding the writer; requests get the writer back between steps
+		int pages_per_step{64};
+		int step_pause_ms{5};
+	};
+
+	struct MultiTenantSettings
+	{
+		// When enabled, every Telegram user gets a review-state shard; the configured chat id keeps the main database
+		bool enabled{false};
+		// Relative to the main database's directory unless absolute
+		std::string shard_directory{"users"};
+		// Shards kept open between requests, least recently used closed first
+		int max_open_shards{64};
+	};
+
+	struct DatabaseSettings
+	{
+		// Write-ahead logging lets readers run concurrently with the single writer
+		bool wal_mode{true};
+		int busy_timeout_ms{5000};
+		// Upper bound on per-thread read-only connections; threads beyond it read through the writer
+		int max_readers{16};
+		WriteBehindSettings write_behind;
+		BackupSettings backup;
+		MultiTenantSettings multi_tenant;
+	};
+
+	struct AdmissionSettings
+	{
+		// Sheds write requests (answers, learn-more, kanji imports) with 429 before they reach a controller
+		bool enabled{true};
+		// Per-user token bucket: sustained writes per second and the burst allowed on top
+		double writes_per_second{5.0};
+		int write_burst{20};
+		// Writes running at once across all users; the rest are shed instead of queueing for the writer
+		int max_inflight_writes{8};
+	};
+
 	struct KanjiAppConfig
 	{
 		NotificationSettings notification;
 		AuthSettings auth;
+		DatabaseSettings database;
+		AdmissionSettings admission;
 
+		// Throws std::runtime_error when the file is missing or a required setting is empty
 		static KanjiAppConfig LoadFromFile(const std::filesystem::path& path);
 	};
 
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TelegramSettings, bot_token, chat_id)
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(NotificationSettings, telegram, refresh_interval)
 	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(AuthSettings, jwt_secret, token_expiry_hours)
-	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(KanjiAppConfig, notification, auth)
+	NLOHMANN_JSON_SERIALIZE_ENUM(FsyncPolicy, {
+	                                              {FsyncPolicy::Always, "always"},
+	                                              {FsyncPolicy::Interval, "interval"},
+	                                              {FsyncPolicy::Never, "never"},
+	                                          })
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(WriteBehindSettings, enabled, flush_interval_ms, batch_size, fsync)
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(BackupSettings, enabled, directory, interval_minutes, retention,
+	                                                pages_per_step, step_pause_ms)
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(MultiTenantSettings, enabled, shard_directory, max_open_shards)
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(DatabaseSettings, wal_mode, busy_timeout_ms, max_readers, write_behind,
+	                                                backup, multi_tenant)
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_WITH_DEFAULT(AdmissionSettings, enabled, writes_per_second, write_burst,
+	                                                max_inflight_writes)
+	// `notification` and `auth` are required; the tuning blocks fall back to their defaults
+	void from_json(const nlohmann::json& j, KanjiAppConfig& config);
 
 } // namespace kanji::config
@@ -1,58 +1,288 @@
 ﻿#include "controller.h"
-#include "database/database_context.h"
+#include "database/answer_journal.h"
+#include "database/storage.h"
 #include "kanji.h"
 #include "scheduler/scheduler.h"
 #include "system/platform_info.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <spdlog/spdlog.h>
 
 namespace kanji
 {
-	Controller::Controller(database::DatabaseContext& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler)
+	Controller::Controller(database::IStorage& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler,
+	                       database::AnswerJournal* in_journal)
+	    : Controller{in_db, std::move(in_scheduler), std::make_shared<catalog::CatalogStore>(in_db), in_journal}
+	{
+	}
+
+	Controller::Controller(database::IStorage& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler,
+	                       std::shared_ptr<catalog::CatalogStore> in_catalog_store, database::AnswerJournal* in_journal)
 	    : db{in_db}
 	    , scheduler{std::move(in_scheduler)}
+	    , journal{in_journal}
+	    , catalog_store{std::move(in_catalog_store)}
+	    , owns_review_states{catalog_store->IsBackedBy(db)}
 	{
+		due_queue.Load(db.GetReviewStateRepository().GetAllReviewStates());
 	}
 
+	Controller::~Controller() = default;
+
 	std::vector<KanjiData> Controller::GetReviewKanjis()
 	{
-		return db
-		    .GetKanjiRepository()
-		    .GetKanjiForReview();
+		const auto ids = due_queue.GetDue(std::chrono::system_clock::now(), database::IKanjiRepository::DEFAULT_REVIEW_BATCH_SIZE);
+		const auto snapshot = GetCatalog();
+
+		std::vector<KanjiData> kanjis;
+		kanjis.reserve(ids.size());
+		for (const std::uint32_t id : ids)
+		{
+			if (const auto* entry = snapshot->Find(id))
+			{
+				kanjis.push_back(snapshot->ToKanjiData(*entry));
+			}
+		}
+		return kanjis;
 	}
 
 	void Controller::SetAnswers(const std::vector<KanjiAnswer>& in_answers)
 	{
+		std::lock_guard lock{write_mutex};
+		if (!journal)
+		{
+			due_queue.Update(db.GetReviewStateRepository().ApplyAnswers(in_answers, *scheduler));
+			++revision;
+			return;
+		}
+
+		// Write-behind: the due queue already holds the current state of every kanji
+		std::vector<KanjiReviewState> new_states;
+		new_states.reserve(in_answers.size());
+		for (const auto& answer : in_answers)
+		{
+			auto previous = std::find_if(new_states.rbegin(), new_states.rend(), [&](const KanjiReviewState& state) {
+				return state.kanji_id == answer.kanji_id;
+			});
+			std::optional<KanjiReviewState> state =
+			    previous != new_states.rend() ? std::optional{*previous} : due_queue.Find(answer.kanji_id);
+			if (!state)
+			{
+				spdlog::warn("Ignoring answer for kanji {0} without a review state", answer.kanji_id);
+				continue;
+			}
+			new_states.push_back(scheduler->GetNextState(*state, answer.incorrect_streak));
+		}
+
+		if (!journal->Append(new_states) && !db.GetReviewStateRepository().SaveReviewStates(new_states))
+		{
+			return;
+		}
+		due_queue.Update(new_states);
+		++revision;
+	}
+
+	std::vector<std::uint32_t> Controller::LearnMoreKanjis(int count)
+	{
+		std::lock_guard lock{write_mutex};
 		auto& review_repo = db.GetReviewStateRepository();
+		const auto new_states = review_repo.InitializeNewReviewStates(std::clamp(count, 1, MAX_LEARN_COUNT));
+		due_queue.Update(new_states);
+		++revision;
+
 		std::vector<std::uint32_t> ids;
-		ids.reserve(in_answers.size());
+		ids.reserve(new_states.size());
+		for (const auto& state : new_states)
+		{
+			ids.push_back(state.kanji_id);
+		}
+		return ids;
+	}
 
-		std::transform(in_answers.begin(), in_answers.end(), std::back_inserter(ids), [](const KanjiAnswer& answer) {
-			return answer.kanji_id;
-		});
+	std::vector<std::uint32_t> Controller::BatchAddKanjis(const std::vector<KanjiData>& kanjis)
+	{
+		std::lock_guard lock{write_mutex};
+		const auto inserted_ids = catalog_store->Add(kanjis);
+		if (inserted_ids.empty() || !owns_review_states)
+		{
+			return inserted_ids;
+		}
 
-		const std::vector<KanjiReviewState>& old_review_states = review_repo.GetReviewStates(ids);
-		for (int i = 0; i < in_answers.size(); ++i)
+		// BatchInsertKanjis starts every new kanji at level 0, due immediately
+		const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+		std::vector<KanjiReviewState> new_states;
+		new_states.reserve(inserted_ids.size());
+		for (const std::uint32_t id : inserted_ids)
 		{
-			const auto& old_state = old_review_states[i];
-			const auto& new_state = scheduler->GetNextState(old_state, in_answers[i].incorrect_streak);
-			review_repo.CreateOrUpdateReviewState(new_state);
+			new_states.push_back({id, 0, now, now});
 		}
+		due_queue.Update(new_states);
+		++revision;
+		return inserted_ids;
 	}
 
-	void Controller::LearnMoreKanjis()
+	std::string Controller::GetReviewKanjisJson()
 	{
-		constexpr int MAX_REVIEWS_REQUEST = 10;
+		const auto ids = due_queue.GetDue(std::chrono::system_clock::now(), database::IKanjiRepository::DEFAULT_REVIEW_BATCH_SIZE);
+		const auto fragments = catalog_store->GetJsonFragments();
 
-		auto& review_repo = db.GetReviewStateRepository();
-		review_repo.InitializeNewReviewStates(MAX_REVIEWS_REQUEST);
+		std::string json = "[";
+		for (const std::uint32_t id : ids)
+		{
+			const std::size_t size = json.size();
+			if (size > 1)
+			{
+				json += ',';
+			}
+			if (!fragments->AppendKanjiData(json, id))
+			{
+				json.resize(size);
+			}
+		}
+		json += ']';
+		return json;
+	}
+
+	std::string Controller::GetKanjisJson()
+	{
+		std::string json = "[";
+		AppendKanjiRecordsJson(json, std::nullopt, std::numeric_limits<std::size_t>::max());
+		json += ']';
+		return json;
+	}
+
+	std::string Controller::GetKanjiPageJson(std::optional<database::KanjiCursor> after, int limit)
+	{
+		limit = std::clamp(limit, 1, database::IKanjiRepository::MAX_PAGE_SIZE);
+
+		std::optional<scheduler::DueQueue::Key> start;
+		if (after)
+		{
+			start = scheduler::DueQueue::Key{after->next_review_date, after->id};
+		}
+
+		std::string json = "{\"kanjis\":[";
+		const auto last = AppendKanjiRecordsJson(json, start, static_cast<std::size_t>(limit));
+		json += "],\"next_cursor\":";
+		if (last)
+		{
+			// Cursors are plain "<digits>:<digits>" and need no escaping
+			json += '"';
+			json += database::KanjiCursor{last->first, last->second}.ToString();
+			json += '"';
+		}
+		else
+		{
+			json += "null";
+		}
+		json += '}';
+		return json;
+	}
+
+	catalog::CatalogStats Controller::GetCatalogStats() const
+	{
+		return catalog_store->GetStats();
+	}
+
+	const std::shared_ptr<catalog::CatalogStore>& Controller::GetCatalogStore() const
+	{
+		return catalog_store;
+	}
+
+	annotation::AnnotationResult Controller::Annotate(std::string_view text)
+	{
+		return annotation::Annotate(text, *GetLevelTable());
+	}
+
+	std::size_t Controller::CountDueReviews() const
+	{
+		return due_queue.CountDue(std::chrono::system_clock::now());
+	}
+
+	std::optional<std::chrono::system_clock::time_point> Controller::GetNextDueTime() const
+	{
+		return due_queue.GetNextDueTime(std::chrono::system_clock::now());
+	}
+
+	std::uint64_t Controller::GetRevision() const
+	{
+		// Both counters only grow, so their sum changes whenever either does
+		return revision.load() + catalog_store->GetVersion();
+	}
+
+	std::shared_ptr<const catalog::KanjiCatalog> Controller::GetCatalog() const
+	{
+		return catalog_store->Get();
 	}
 
-	void Controller::BatchAddKanjis(const std::vector<KanjiData>& kanjis)
+	std::shared_ptr<const annotation::LevelTable> Controller::GetLevelTable()
 	{
-		db.GetKanjiRepository().BatchInsertKanjis(kanjis);
+		std::lock_guard lock{level_table_mutex};
+		const std::uint64_t version = revision.load();
+		const std::uint64_t catalog_version = catalog_store->GetVersion();
+		if (level_table && level_table_version == version && level_table_catalog_version == catalog_version)
+		{
+			return level_table;
+		}
+
+		// Built from the due queue and catalog, so it also sees answers still waiting in the journal
+		const auto snapshot = GetCatalog();
+		std::unordered_map<char32_t, int> levels;
+		levels.reserve(due_queue.Size());
+		due_queue.ForEach(std::nullopt, [&](const KanjiReviewState& state) {
+			const auto* entry = snapshot->Find(state.kanji_id);
+			if (!entry)
+			{
+				return true;
+			}
+
+			const std::string_view kanji = snapshot->GetString(entry->kanji);
+			if (kanji.empty())
+			{
+				return true;
+			}
+
+			std::size_t length = 0;
+			const char32_t codepoint = utils::utf8::Decode(kanji, 0, length);
+			// Several rows can share a character; the most advanced one wins
+			auto [it, inserted] = levels.emplace(codepoint, state.level);
+			if (!inserted)
+			{
+				it->second = std::max(it->second, state.level);
+			}
+			return true;
+		});
+
+		level_table = std::make_shared<const annotation::LevelTable>(levels);
+		level_table_version = version;
+		level_table_catalog_version = catalog_version;
+		return level_table;
 	}
 
-	std::vector<KanjiRecord> Controller::GetKanjis()
+	std::optional<scheduler::DueQueue::Key> Controller::AppendKanjiRecordsJson(std::string& json,
+	                                                                          std::optional<scheduler::DueQueue::Key> after,
+	                                                                          std::size_t limit) const
 	{
-		return db.GetKanjiRepository().GetKanjis();
+		const auto fragments = catalog_store->GetJsonFragments();
+		std::size_t count = 0;
+		std::optional<scheduler::DueQueue::Key> last;
+		due_queue.ForEach(after, [&](const KanjiReviewState& state) {
+			const std::size_t size = json.size();
+			if (count > 0)
+			{
+				json += ',';
+			}
+			const std::int64_t next_review_date = std::chrono::system_clock::to_time_t(state.next_review_date);
+			if (!fragments->AppendKanjiRecord(json, state.kanji_id, state.level, next_review_date))
+			{
+				json.resize(size);
+				return true;
+			}
+			last = scheduler::DueQueue::Key{next_review_date, state.kanji_id};
+			return ++count < limit;
+		});
+		return count == limit ? last : std::nullopt;
 	}
 } // namespace kanji
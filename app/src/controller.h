@@ -1,13 +1,23 @@
 #pragma once
 
+#include "annotation/text_annotator.h"
+#include "catalog/catalog_store.h"
+#include "catalog/kanji_catalog.h"
+#include "database/storage.h"
 #include "kanji.h"
+#include "scheduler/due_queue.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace kanji
 {
 	namespace database
 	{
-		class DatabaseContext;
+		class AnswerJournal;
 	}
 
 	namespace scheduler
@@ -23,15 +33,63 @@ namespace kanji
 	class Controller
 	{
 	public:
-		explicit Controller(database::DatabaseContext& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler);
+		static constexpr int DEFAULT_LEARN_COUNT = 10;
+		static constexpr int MAX_LEARN_COUNT = 1000;
+
+		// Serves review states and the catalog from the same database; a journal turns on write-behind
+		explicit Controller(database::IStorage& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler,
+		                    database::AnswerJournal* in_journal = nullptr);
+		// Serves review states from `in_db` (typically a learner's shard) and kanjis from a shared catalog
+		Controller(database::IStorage& in_db, std::unique_ptr<scheduler::IScheduler> in_scheduler,
+		           std::shared_ptr<catalog::CatalogStore> in_catalog_store, database::AnswerJournal* in_journal = nullptr);
+		~Controller();
 		std::vector<KanjiData> GetReviewKanjis();
 		void SetAnswers(const std::vector<KanjiAnswer>& in_answers);
-		void LearnMoreKanjis();
-		void BatchAddKanjis(const std::vector<KanjiData>& kanjis);
-		std::vector<KanjiRecord> GetKanjis();
+		// Starts reviews for up to `count` new kanjis and returns their ids
+		std::vector<std::uint32_t> LearnMoreKanjis(int count = DEFAULT_LEARN_COUNT);
+		// Adds to the catalog database; only a controller on that database also schedules the new kanjis
+		std::vector<std::uint32_t> BatchAddKanjis(const std::vector<KanjiData>& kanjis);
+		// Lists as JSON, copied together from the catalog's pre-encoded fragments
+		std::string GetReviewKanjisJson();
+		// Every kanji with a review state, in (next_review_date, id) order
+		std::string GetKanjisJson();
+		// Up to `limit` of the same rows after `after`: {"kanjis":[...],"next_cursor":"..." or null}
+		std::string GetKanjiPageJson(std::optional<database::KanjiCursor> after, int limit);
+		std::size_t CountDueReviews() const;
+		// When CountDueReviews next grows without any write, if a review is scheduled
+		std::optional<std::chrono::system_clock::time_point> GetNextDueTime() const;
+		catalog::CatalogStats GetCatalogStats() const;
+		// Moves forward whenever review states or the catalog change; cheap enough to check per request
+		std::uint64_t GetRevision() const;
+		// Counts the kanji in `text` and tags each with its current SRS level
+		annotation::AnnotationResult Annotate(std::string_view text);
+
+		const std::shared_ptr<catalog::CatalogStore>& GetCatalogStore() const;
 
 	private:
-		database::DatabaseContext& db;
+		std::shared_ptr<const catalog::KanjiCatalog> GetCatalog() const;
+		// Appends up to `limit` comma-separated records; returns the last key when the limit was reached
+		std::optional<scheduler::DueQueue::Key> AppendKanjiRecordsJson(std::string& json,
+		                                                               std::optional<scheduler::DueQueue::Key> after,
+		                                                               std::size_t limit) const;
+		std::shared_ptr<const annotation::LevelTable> GetLevelTable();
+
+		database::IStorage& db;
 		std::unique_ptr<scheduler::IScheduler> scheduler;
+		// Null unless review states are written behind
+		database::AnswerJournal* journal;
+		// Loaded once at startup, then kept in step with every review state write
+		scheduler::DueQueue due_queue;
+		// Serializes mutations, which read the due queue before publishing to it; reads never take it
+		std::mutex write_mutex;
+		std::shared_ptr<catalog::CatalogStore> catalog_store;
+		// False when review states live in a shard rather than next to the kanjis
+		bool owns_review_states{true};
+		// Bumped by every review state write; the level table is rebuilt lazily when it or the catalog moves on
+		std::atomic<std::uint64_t> revision{0};
+		std::mutex level_table_mutex;
+		std::shared_ptr<const annotation::LevelTable> level_table;
+		std::uint64_t level_table_version{0};
+		std::uint64_t level_table_catalog_version{0};
 	};
 } // namespace kanji
@@ -0,0 +1,290 @@
+#include "answer_journal.h"
+#include "review_state_repository.h"
+#include "system/platform_info.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <string_view>
+
+namespace
+{
+	// One record per line: "<kanji_id> <level> <next_review_date>\n"
+	bool ParseRecord(std::string_view line, kanji::KanjiReviewState& state)
+	{
+		std::int64_t values[3]{};
+		const char* it = line.data();
+		const char* end = line.data() + line.size();
+		for (auto& value : values)
+		{
+			while (it != end && *it == ' ')
+			{
+				++it;
+			}
+			const auto [next, ec] = std::from_chars(it, end, value);
+			if (ec != std::errc{})
+			{
+				return false;
+			}
+			it = next;
+		}
+
+		state.kanji_id = static_cast<std::uint32_t>(values[0]);
+		state.level = static_cast<int>(values[1]);
+		state.next_review_date = std::chrono::system_clock::from_time_t(values[2]);
+		state.created_at = state.next_review_date;
+		return true;
+	}
+} // namespace
+
+namespace kanji::database
+{
+	AnswerJournal::AnswerJournal(std::filesystem::path in_path, config::WriteBehindSettings in_settings,
+	                             ReviewStateRepository& in_review_repo)
+	    : path{std::move(in_path)}
+	    , settings{in_settings}
+	    , review_repo{in_review_repo}
+	{
+	}
+
+	AnswerJournal::~AnswerJournal()
+	{
+		if (writer.joinable())
+		{
+			writer.request_stop();
+			writer.join();
+		}
+		Flush();
+
+		if (file)
+		{
+			std::fclose(file);
+		}
+	}
+
+	bool AnswerJournal::Open()
+	{
+		const auto records = ReadRecords();
+		if (!records.empty())
+		{
+			spdlog::info("AnswerJournal: replaying {} review states from {}", records.size(), path.string());
+			if (!Commit(records))
+			{
+				// Answers written synchronously from here on would be rolled back by a later replay
+				auto failed_path = path;
+				failed_path += ".failed";
+				std::error_code error;
+				std::filesystem::rename(path, failed_path, error);
+				if (error)
+				{
+					spdlog::error("AnswerJournal: replay failed and {} cannot be moved aside: {}", path.string(),
+					              error.message());
+				}
+				else
+				{
+					spdlog::error("AnswerJournal: replay failed, moved {} to {}", path.string(), failed_path.string());
+				}
+				return false;
+			}
+		}
+
+		file = std::fopen(path.string().c_str(), "wb");
+		if (!file)
+		{
+			spdlog::error("AnswerJournal: cannot open {}", path.string());
+			return false;
+		}
+
+		writer = std::jthread([this](std::stop_token token) { Run(token); });
+		return true;
+	}
+
+	bool AnswerJournal::Append(const std::vector<KanjiReviewState>& states)
+	{
+		if (states.empty())
+		{
+			return true;
+		}
+
+		std::string records;
+		for (const auto& state : states)
+		{
+			records += std::to_string(state.kanji_id);
+			records += ' ';
+			records += std::to_string(state.level);
+			records += ' ';
+			records += std::to_string(std::chrono::system_clock::to_time_t(state.next_review_date));
+			records += '\n';
+		}
+
+		std::unique_lock lock{mutex};
+		if (!file)
+		{
+			return false;
+		}
+
+		bool ok = std::fwrite(records.data(), 1, records.size(), file) == records.size();
+		ok = ok && (settings.fsync == config::FsyncPolicy::Always ? system::PlatformInfo::SyncFile(file)
+		                                                          : std::fflush(file) == 0);
+		if (!ok)
+		{
+			spdlog::error("AnswerJournal: failed to append to {}", path.string());
+			return false;
+		}
+
+		for (const auto& state : states)
+		{
+			pending.insert_or_assign(state.kanji_id, state);
+		}
+		++appended_sequence;
+		stats.queue_depth = pending.size();
+
+		if (pending.size() >= static_cast<std::size_t>(settings.batch_size))
+		{
+			lock.unlock();
+			wake.notify_one();
+		}
+		return true;
+	}
+
+	void AnswerJournal::Flush()
+	{
+		std::lock_guard flush_lock{flush_mutex};
+
+		while (true)
+		{
+			std::vector<KanjiReviewState> batch;
+			std::uint64_t drained_sequence = 0;
+			{
+				std::lock_guard lock{mutex};
+				if (pending.empty())
+				{
+					return;
+				}
+
+				if (file && settings.fsync == config::FsyncPolicy::Interval)
+				{
+					system::PlatformInfo::SyncFile(file);
+				}
+
+				const auto batch_size = static_cast<std::size_t>(std::max(1, settings.batch_size));
+				batch.reserve(std::min(batch_size, pending.size()));
+				for (auto it = pending.begin(); it != pending.end() && batch.size() < batch_size;)
+				{
+					batch.push_back(it->second);
+					it = pending.erase(it);
+				}
+
+				if (pending.empty())
+				{
+					drained_sequence = appended_sequence;
+				}
+			}
+
+			if (!Commit(batch))
+			{
+				// Keep the states for the next cycle unless a newer answer replaced them meanwhile
+				std::lock_guard lock{mutex};
+				for (const auto& state : batch)
+				{
+					pending.try_emplace(state.kanji_id, state);
+				}
+				stats.queue_depth = pending.size();
+				return;
+			}
+
+			if (drained_sequence != 0)
+			{
+				TruncateIfDrained(drained_sequence);
+			}
+		}
+	}
+
+	AnswerJournalStats AnswerJournal::GetStats() const
+	{
+		std::lock_guard lock{mutex};
+		return stats;
+	}
+
+	void AnswerJournal::Run(std::stop_token stop_token)
+	{
+		const auto interval = std::chrono::milliseconds{settings.flush_interval_ms};
+		while (!stop_token.stop_requested())
+		{
+			{
+				std::unique_lock lock{mutex};
+				wake.wait_for(lock, stop_token, interval, [this] {
+					return pending.size() >= static_cast<std::size_t>(settings.batch_size);
+				});
+			}
+			Flush();
+		}
+	}
+
+	std::vector<KanjiReviewState> AnswerJournal::ReadRecords() const
+	{
+		std::vector<KanjiReviewState> records;
+		std::ifstream in{path, std::ios::binary};
+		if (!in)
+		{
+			return records;
+		}
+
+		const std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+		std::string_view remaining{content};
+		// A line without its terminating newline is a torn write and is dropped
+		for (auto newline = remaining.find('\n'); newline != std::string_view::npos; newline = remaining.find('\n'))
+		{
+			KanjiReviewState state{};
+			if (ParseRecord(remaining.substr(0, newline), state))
+			{
+				records.push_back(state);
+			}
+			else
+			{
+				spdlog::warn("AnswerJournal: skipping malformed record in {}", path.string());
+			}
+			remaining.remove_prefix(newline + 1);
+		}
+		return records;
+	}
+
+	bool AnswerJournal::Commit(const std::vector<KanjiReviewState>& states)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const bool ok = review_repo.SaveReviewStates(states);
+		const auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+		std::lock_guard lock{mutex};
+		stats.queue_depth = pending.size();
+		if (ok)
+		{
+			const auto latency_us = static_cast<std::uint64_t>(latency.count());
+			++stats.commits;
+			stats.committed_states += states.size();
+			stats.last_commit_latency_us = latency_us;
+			stats.max_commit_latency_us = std::max(stats.max_commit_latency_us, latency_us);
+			stats.total_commit_latency_us += latency_us;
+		}
+		return ok;
+	}
+
+	void AnswerJournal::TruncateIfDrained(std::uint64_t flushed_sequence)
+	{
+		std::lock_guard lock{mutex};
+		// Anything appended after the flush started must stay in the file
+		if (!file || !pending.empty() || appended_sequence != flushed_sequence)
+		{
+			return;
+		}
+
+		std::fclose(file);
+		file = std::fopen(path.string().c_str(), "wb");
+		if (!file)
+		{
+			spdlog::error("AnswerJournal: cannot reopen {}", path.string());
+		}
+	}
+} // namespace kanji::database
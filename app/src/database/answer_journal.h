@@ -0,0 +1,73 @@
+#pragma once
+
+#include "config.h"
+#include "kanji.h"
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace kanji::database
+{
+	class ReviewStateRepository;
+
+	struct AnswerJournalStats
+	{
+		std::size_t queue_depth{};
+		std::uint64_t commits{};
+		std::uint64_t committed_states{};
+		std::uint64_t last_commit_latency_us{};
+		std::uint64_t max_commit_latency_us{};
+		std::uint64_t total_commit_latency_us{};
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(AnswerJournalStats, queue_depth, commits, committed_states, last_commit_latency_us,
+	                                   max_commit_latency_us, total_commit_latency_us)
+
+	// Write-behind log for review states. Append() makes new states durable in a small
+	// append-only file and returns; a background thread coalesces them into batched
+	// transactions against kanji_review_state. Records are absolute states, so replaying
+	// records that were already committed is harmless.
+	class AnswerJournal
+	{
+	public:
+		AnswerJournal(std::filesystem::path in_path, config::WriteBehindSettings in_settings, ReviewStateRepository& in_review_repo);
+		AnswerJournal(const AnswerJournal&) = delete;
+		AnswerJournal& operator=(const AnswerJournal&) = delete;
+		~AnswerJournal();
+
+		// Commits whatever a previous run left in the journal, then starts the writer thread.
+		// A journal that fails to replay is renamed to `<path>.failed` so it is never applied later.
+		bool Open();
+		bool Append(const std::vector<KanjiReviewState>& states);
+		// Writes out everything appended so far; used on shutdown and by tests
+		void Flush();
+
+		AnswerJournalStats GetStats() const;
+
+	private:
+		void Run(std::stop_token stop_token);
+		std::vector<KanjiReviewState> ReadRecords() const;
+		bool Commit(const std::vector<KanjiReviewState>& states);
+		void TruncateIfDrained(std::uint64_t flushed_sequence);
+
+		std::filesystem::path path;
+		config::WriteBehindSettings settings;
+		ReviewStateRepository& review_repo;
+
+		mutable std::mutex mutex;
+		std::condition_variable_any wake;
+		std::FILE* file{nullptr};
+		std::unordered_map<std::uint32_t, KanjiReviewState> pending;
+		std::uint64_t appended_sequence{0};
+		AnswerJournalStats stats;
+
+		// Serializes flushes between the writer thread and explicit Flush() calls
+		std::mutex flush_mutex;
+		std::jthread writer;
+	};
+} // namespace kanji::database
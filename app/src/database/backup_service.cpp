@@ -0,0 +1,308 @@
+#include "backup_service.h"
+#include "connection_pool.h"
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+#include <vector>
+
+namespace
+{
+	std::uint64_t ElapsedMicroseconds(std::chrono::steady_clock::time_point since)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - since).count();
+	}
+} // namespace
+
+namespace kanji::database
+{
+	BackupService::BackupService(ConnectionPool& in_pool, config::BackupSettings in_settings)
+	    : pool{in_pool}
+	    , settings{std::move(in_settings)}
+	    , stem{pool.GetPath().stem().string()}
+	{
+		directory = settings.directory;
+		if (directory.is_relative())
+		{
+			directory = pool.GetPath().parent_path() / directory;
+		}
+
+		if (settings.enabled)
+		{
+			std::lock_guard lock{mutex};
+			EnsureStarted();
+		}
+	}
+
+	BackupService::~BackupService() = default;
+
+	bool BackupService::Request()
+	{
+		std::lock_guard lock{mutex};
+		if (stats.queued)
+		{
+			return false;
+		}
+
+		stats.queued = true;
+		EnsureStarted();
+		wake.notify_all();
+		return true;
+	}
+
+	std::optional<std::filesystem::path> BackupService::RunOnce()
+	{
+		return RunBackup({});
+	}
+
+	BackupStats BackupService::GetStats() const
+	{
+		std::lock_guard lock{mutex};
+		return stats;
+	}
+
+	const std::filesystem::path& BackupService::GetDirectory() const
+	{
+		return directory;
+	}
+
+	void BackupService::EnsureStarted()
+	{
+		// Called with mutex held; the thread is only created once something needs it
+		if (!worker.joinable())
+		{
+			worker = std::jthread([this](std::stop_token token) { Run(token); });
+		}
+	}
+
+	void BackupService::Run(std::stop_token stop_token)
+	{
+		using namespace std::chrono;
+		const auto interval = minutes{std::max(settings.interval_minutes, 1)};
+
+		// Resume the schedule from the newest backup on disk so restarts do not postpone it forever
+		auto next_due = steady_clock::now();
+		if (const auto newest = GetNewestBackupTime())
+		{
+			const auto age = duration_cast<seconds>(std::filesystem::file_time_type::clock::now() - *newest);
+			next_due += std::max(duration_cast<seconds>(interval) - age, seconds{0});
+		}
+
+		while (!stop_token.stop_requested())
+		{
+			{
+				std::unique_lock lock{mutex};
+				const auto requested = [this] { return stats.queued; };
+				if (settings.enabled)
+				{
+					wake.wait_until(lock, stop_token, next_due, requested);
+				}
+				else
+				{
+					wake.wait(lock, stop_token, requested);
+				}
+				if (stop_token.stop_requested())
+				{
+					return;
+				}
+				stats.queued = false;
+			}
+
+			RunBackup(stop_token);
+			next_due = steady_clock::now() + interval;
+		}
+	}
+
+	std::optional<std::filesystem::path> BackupService::RunBackup(std::stop_token stop_token)
+	{
+		std::lock_guard run_lock{run_mutex};
+		{
+			std::lock_guard lock{mutex};
+			stats.running = true;
+		}
+
+		std::error_code ec;
+		std::filesystem::create_directories(directory, ec);
+
+		const auto started = std::chrono::steady_clock::now();
+		const auto destination = MakeBackupPath();
+		auto temp_path = destination;
+		temp_path += ".tmp";
+
+		std::string error;
+		std::uint64_t pages = 0;
+		std::uint64_t max_step_us = 0;
+		bool ok = Copy(temp_path, stop_token, pages, max_step_us, error);
+		if (ok)
+		{
+			std::filesystem::rename(temp_path, destination, ec);
+			if (ec)
+			{
+				ok = false;
+				error = ec.message();
+			}
+		}
+		if (!ok)
+		{
+			std::filesystem::remove(temp_path, ec);
+		}
+
+		const auto duration_ms = ElapsedMicroseconds(started) / 1000;
+		{
+			std::lock_guard lock{mutex};
+			stats.running = false;
+			stats.max_step_us = std::max(stats.max_step_us, max_step_us);
+			if (ok)
+			{
+				++stats.completed;
+				stats.last_duration_ms = duration_ms;
+				stats.last_pages = pages;
+				stats.last_finished_at = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+				stats.last_file = destination.filename().string();
+				stats.last_error.clear();
+			}
+			else
+			{
+				++stats.failed;
+				stats.last_error = error;
+			}
+		}
+
+		if (!ok)
+		{
+			spdlog::error("Backup of {0} failed: {1}", pool.GetPath().string(), error);
+			return std::nullopt;
+		}
+
+		spdlog::info("Backed up {0} pages to {1} in {2} ms", pages, destination.string(), duration_ms);
+		ApplyRetention();
+		return destination;
+	}
+
+	bool BackupService::Copy(const std::filesystem::path& destination, std::stop_token stop_token, std::uint64_t& pages,
+	                         std::uint64_t& max_step_us, std::string& error)
+	{
+		sqlite3* destination_db = nullptr;
+		if (sqlite3_open_v2(reinterpret_cast<const char*>(destination.u8string().c_str()), &destination_db,
+		                    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) != SQLITE_OK)
+		{
+			error = sqlite3_errmsg(destination_db);
+			sqlite3_close(destination_db);
+			return false;
+		}
+
+		sqlite3_backup* backup = nullptr;
+		{
+			auto writer = pool.AcquireWriter();
+			backup = sqlite3_backup_init(destination_db, "main", writer, "main");
+		}
+		if (!backup)
+		{
+			error = sqlite3_errmsg(destination_db);
+			sqlite3_close(destination_db);
+			return false;
+		}
+
+		// Each step holds the writer only while it copies `pages_per_step` pages. Writes made through
+		// the writer between steps are carried into the copy rather than restarting it.
+		const auto pause = std::chrono::milliseconds{settings.step_pause_ms};
+		int rc = SQLITE_OK;
+		while (rc == SQLITE_OK || rc == SQLITE_BUSY || rc == SQLITE_LOCKED)
+		{
+			if (stop_token.stop_requested())
+			{
+				error = "cancelled";
+				break;
+			}
+
+			const auto step_started = std::chrono::steady_clock::now();
+			{
+				auto writer = pool.AcquireWriter();
+				rc = sqlite3_backup_step(backup, std::max(settings.pages_per_step, 1));
+			}
+			max_step_us = std::max(max_step_us, ElapsedMicroseconds(step_started));
+
+			if (rc != SQLITE_DONE)
+			{
+				std::this_thread::sleep_for(pause);
+			}
+		}
+
+		{
+			auto writer = pool.AcquireWriter();
+			pages = static_cast<std::uint64_t>(sqlite3_backup_pagecount(backup));
+			sqlite3_backup_finish(backup);
+		}
+		if (rc != SQLITE_DONE && error.empty())
+		{
+			error = sqlite3_errmsg(destination_db);
+		}
+		sqlite3_close(destination_db);
+		return rc == SQLITE_DONE;
+	}
+
+	std::optional<std::filesystem::file_time_type> BackupService::GetNewestBackupTime() const
+	{
+		std::optional<std::filesystem::file_time_type> newest;
+		for (const auto& backup : ListBackups())
+		{
+			std::error_code ec;
+			const auto time = std::filesystem::last_write_time(backup, ec);
+			if (!ec && (!newest || time > *newest))
+			{
+				newest = time;
+			}
+		}
+		return newest;
+	}
+
+	std::vector<std::filesystem::path> BackupService::ListBackups() const
+	{
+		// Names embed a UTC timestamp, so name order is age order
+		std::vector<std::filesystem::path> backups;
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator{directory, ec})
+		{
+			const auto name = entry.path().filename().string();
+			if (entry.is_regular_file() && name.starts_with(stem + "-") && entry.path().extension() == ".db")
+			{
+				backups.push_back(entry.path());
+			}
+		}
+		std::sort(backups.begin(), backups.end());
+		return backups;
+	}
+
+	void BackupService::ApplyRetention() const
+	{
+		auto backups = ListBackups();
+		const auto keep = static_cast<std::size_t>(std::max(settings.retention, 1));
+		if (backups.size() <= keep)
+		{
+			return;
+		}
+
+		for (auto it = backups.begin(); it != backups.end() - keep; ++it)
+		{
+			std::error_code ec;
+			if (!std::filesystem::remove(*it, ec))
+			{
+				spdlog::warn("Failed to remove old backup {0}: {1}", it->string(), ec.message());
+			}
+		}
+	}
+
+	std::filesystem::path BackupService::MakeBackupPath() const
+	{
+		using namespace std::chrono;
+		const auto now = system_clock::now();
+		const auto today = floor<days>(now);
+		const year_month_day date{today};
+		const hh_mm_ss time{floor<milliseconds>(now - today)};
+		return directory / std::format("{}-{:04}{:02}{:02}-{:02}{:02}{:02}-{:03}.db", stem, static_cast<int>(date.year()),
+		                               static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()),
+		                               time.hours().count(), time.minutes().count(), time.seconds().count(),
+		                               time.subseconds().count());
+	}
+} // namespace kanji::database
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "config.h"
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kanji::database
+{
+	class ConnectionPool;
+
+	struct BackupStats
+	{
+		bool running{};
+		bool queued{};
+		std::uint64_t completed{};
+		std::uint64_t failed{};
+		std::uint64_t last_duration_ms{};
+		std::uint64_t last_pages{};
+		// Longest single step, i.e. the longest the writer was held away from requests
+		std::uint64_t max_step_us{};
+		// Seconds since the epoch
+		std::int64_t last_finished_at{};
+		std::string last_file;
+		std::string last_error;
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(BackupStats, running, queued, completed, failed, last_duration_ms, last_pages, max_step_us,
+	                                   last_finished_at, last_file, last_error)
+
+	// Online backups through sqlite3_backup. Pages are copied a few at a time from the writer
+	// connection, which is released between steps, so requests keep running and writes made
+	// meanwhile end up in the copy instead of restarting it. Backups run on a background thread,
+	// either on a schedule or on request, and only the newest `retention` files are kept.
+	class BackupService
+	{
+	public:
+		BackupService(ConnectionPool& in_pool, config::BackupSettings in_settings);
+		BackupService(const BackupService&) = delete;
+		BackupService& operator=(const BackupService&) = delete;
+		~BackupService();
+
+		// Queues a backup; false when one is already queued
+		bool Request();
+		// Copies the database on the calling thread; empty on failure
+		std::optional<std::filesystem::path> RunOnce();
+
+		BackupStats GetStats() const;
+		const std::filesystem::path& GetDirectory() const;
+
+	private:
+		void EnsureStarted();
+		void Run(std::stop_token stop_token);
+		std::optional<std::filesystem::path> RunBackup(std::stop_token stop_token);
+		bool Copy(const std::filesystem::path& destination, std::stop_token stop_token, std::uint64_t& pages,
+		          std::uint64_t& max_step_us, std::string& error);
+		std::vector<std::filesystem::path> ListBackups() const;
+		std::optional<std::filesystem::file_time_type> GetNewestBackupTime() const;
+		void ApplyRetention() const;
+		std::filesystem::path MakeBackupPath() const;
+
+		ConnectionPool& pool;
+		config::BackupSettings settings;
+		std::filesystem::path directory;
+		std::string stem;
+
+		mutable std::mutex mutex;
+		std::condition_variable_any wake;
+		BackupStats stats;
+
+		// One backup at a time, whether scheduled, requested or run directly
+		std::mutex run_mutex;
+		std::jthread worker;
+	};
+} // namespace kanji::database
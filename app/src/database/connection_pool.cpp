@@ -0,0 +1,230 @@
+#include "connection_pool.h"
+#include <format>
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+#include <string>
+#include <utility>
+
+namespace
+{
+	std::atomic<std::uint64_t> next_pool_id{1};
+
+	// Last reader handed out on this thread; avoids the readers_mutex on the hot path
+	struct CachedReader
+	{
+		std::uint64_t pool_id{0};
+		const kanji::database::SQLiteConnection* connection{nullptr};
+	};
+	thread_local CachedReader cached_reader;
+
+	void ExecutePragma(sqlite3* db, const std::string& sql)
+	{
+		char* err_msg = nullptr;
+		if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK)
+		{
+			spdlog::error("Failed to apply '{0}': {1}", sql, err_msg ? err_msg : "unknown error");
+			sqlite3_free(err_msg);
+		}
+	}
+
+	// file: URI opening `path` read-only; reserved URI characters in the path are percent-encoded
+	std::string ReadOnlyUri(const std::filesystem::path& path)
+	{
+		const auto absolute = std::filesystem::absolute(path);
+		std::string uri = "file:";
+		if (absolute.has_root_name())
+		{
+			// Windows drive letters need a leading slash: file:/C:/...
+			uri += '/';
+		}
+		for (const char c : absolute.generic_u8string())
+		{
+			if (c == '%' || c == '?' || c == '#')
+			{
+				uri += std::format("%{:02X}", static_cast<unsigned char>(c));
+			}
+			else
+			{
+				uri += c;
+			}
+		}
+		return uri + "?mode=ro";
+	}
+} // namespace
+
+namespace kanji::database
+{
+	ConnectionLease::ConnectionLease(const SQLiteConnection& in_connection)
+	    : connection{&in_connection}
+	{
+	}
+
+	ConnectionLease::ConnectionLease(ConnectionPool& in_pool, std::unique_lock<std::recursive_mutex> in_lock)
+	    : connection{&in_pool.writer}
+	    , writer_pool{&in_pool}
+	    , lock{std::move(in_lock)}
+	{
+	}
+
+	ConnectionLease::ConnectionLease(ConnectionLease&& other) noexcept
+	    : connection{other.connection}
+	    , writer_pool{std::exchange(other.writer_pool, nullptr)}
+	    , lock{std::move(other.lock)}
+	{
+	}
+
+	ConnectionLease::~ConnectionLease()
+	{
+		if (writer_pool)
+		{
+			writer_pool->ReleaseWriter();
+		}
+	}
+
+	const SQLiteConnection& ConnectionLease::operator*() const
+	{
+		return *connection;
+	}
+
+	const SQLiteConnection* ConnectionLease::operator->() const
+	{
+		return connection;
+	}
+
+	ConnectionLease::operator sqlite3*() const
+	{
+		return connection->GetDB();
+	}
+
+	ConnectionPool::ConnectionPool(std::filesystem::path in_db_path, config::DatabaseSettings in_settings,
+	                               std::filesystem::path in_catalog_path)
+	    : pool_id{next_pool_id++}
+	    , db_path{std::move(in_db_path)}
+	    , settings{in_settings}
+	    , catalog_path{std::move(in_catalog_path)}
+	    , writer{db_path}
+	{
+		Configure(writer, true);
+	}
+
+	bool ConnectionPool::Initialize()
+	{
+		auto lease = AcquireWriter();
+		if (IsShard())
+		{
+			return writer.Initialize(GetShardMigrations());
+		}
+		return writer.Initialize(GetMigrations()) && EnsureSecondaryIndexes(writer);
+	}
+
+	ConnectionLease ConnectionPool::AcquireReader()
+	{
+		if (writer_owner.load() == std::this_thread::get_id())
+		{
+			return AcquireWriter();
+		}
+
+		if (const SQLiteConnection* reader = FindOrOpenReader())
+		{
+			return ConnectionLease{*reader};
+		}
+
+		return AcquireWriter();
+	}
+
+	ConnectionLease ConnectionPool::AcquireWriter()
+	{
+		std::unique_lock lock{writer_mutex};
+		++writer_depth;
+		writer_owner = std::this_thread::get_id();
+		return ConnectionLease{*this, std::move(lock)};
+	}
+
+	void ConnectionPool::ReleaseWriter()
+	{
+		// Called with writer_mutex still held by the releasing lease
+		if (--writer_depth == 0)
+		{
+			writer_owner = std::thread::id{};
+		}
+	}
+
+	const std::filesystem::path& ConnectionPool::GetPath() const
+	{
+		return db_path;
+	}
+
+	bool ConnectionPool::IsShard() const
+	{
+		return !catalog_path.empty();
+	}
+
+	StatementCacheStats ConnectionPool::GetStatementCacheStats()
+	{
+		StatementCacheStats total = writer.GetStatementCacheStats();
+
+		std::lock_guard lock{readers_mutex};
+		for (const auto& [thread_id, reader] : readers)
+		{
+			const auto stats = reader->GetStatementCacheStats();
+			total.hits += stats.hits;
+			total.misses += stats.misses;
+		}
+		return total;
+	}
+
+	const SQLiteConnection* ConnectionPool::FindOrOpenReader()
+	{
+		if (cached_reader.pool_id == pool_id)
+		{
+			return cached_reader.connection;
+		}
+
+		std::lock_guard lock{readers_mutex};
+		auto& reader = readers[std::this_thread::get_id()];
+		if (!reader)
+		{
+			if (!settings.wal_mode || static_cast<int>(readers.size()) > settings.max_readers)
+			{
+				readers.erase(std::this_thread::get_id());
+				return nullptr;
+			}
+
+			reader = std::make_unique<SQLiteConnection>(db_path, OpenMode::ReadOnly);
+			Configure(*reader, false);
+		}
+
+		cached_reader = {pool_id, reader.get()};
+		return reader.get();
+	}
+
+	void ConnectionPool::Configure(const SQLiteConnection& connection, const bool is_writer) const
+	{
+		sqlite3_busy_timeout(connection, settings.busy_timeout_ms);
+
+		if (is_writer && settings.wal_mode)
+		{
+			ExecutePragma(connection, "PRAGMA journal_mode=WAL;");
+			ExecutePragma(connection, "PRAGMA synchronous=NORMAL;");
+		}
+
+		if (!is_writer)
+		{
+			ExecutePragma(connection, "PRAGMA query_only=ON;");
+		}
+
+		if (IsShard())
+		{
+			// Shard tables are looked up first, so unqualified `kanjis` resolves to the catalog
+			sqlite3_stmt* stmt = nullptr;
+			const std::string uri = ReadOnlyUri(catalog_path);
+			if (sqlite3_prepare_v2(connection, "ATTACH DATABASE ? AS catalog;", -1, &stmt, nullptr) != SQLITE_OK ||
+			    sqlite3_bind_text(stmt, 1, uri.c_str(), static_cast<int>(uri.size()), SQLITE_TRANSIENT) != SQLITE_OK ||
+			    sqlite3_step(stmt) != SQLITE_DONE)
+			{
+				spdlog::error("Failed to attach catalog {0}: {1}", catalog_path.string(), sqlite3_errmsg(connection));
+			}
+			sqlite3_finalize(stmt);
+		}
+	}
+} // namespace kanji::database
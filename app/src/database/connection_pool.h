@@ -0,0 +1,82 @@
+#pragma once
+
+#include "config.h"
+#include "sqlite_connection.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace kanji::database
+{
+	class ConnectionPool;
+
+	// Borrowed connection. Holds the writer lock for as long as it lives when it refers to the writer.
+	class ConnectionLease
+	{
+	public:
+		explicit ConnectionLease(const SQLiteConnection& in_connection);
+		ConnectionLease(ConnectionLease&& other) noexcept;
+		ConnectionLease& operator=(ConnectionLease&&) = delete;
+		~ConnectionLease();
+
+		const SQLiteConnection& operator*() const;
+		const SQLiteConnection* operator->() const;
+		operator sqlite3*() const;
+
+	private:
+		friend class ConnectionPool;
+		ConnectionLease(ConnectionPool& in_pool, std::unique_lock<std::recursive_mutex> in_lock);
+
+		const SQLiteConnection* connection;
+		ConnectionPool* writer_pool{nullptr};
+		std::unique_lock<std::recursive_mutex> lock;
+	};
+
+	// One serialized writer connection plus a read-only connection per thread.
+	// In WAL mode readers never block the writer and see the last committed state.
+	// With a catalog path the pool is a review-state shard: every connection attaches the catalog
+	// database read-only as `catalog`, so shard writers never lock the shared file.
+	class ConnectionPool
+	{
+	public:
+		explicit ConnectionPool(std::filesystem::path in_db_path, config::DatabaseSettings in_settings = {},
+		                        std::filesystem::path in_catalog_path = {});
+		ConnectionPool(const ConnectionPool&) = delete;
+		ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+		bool Initialize();
+
+		// A thread already holding the writer gets the writer back so it reads its own uncommitted changes
+		ConnectionLease AcquireReader();
+		ConnectionLease AcquireWriter();
+
+		const std::filesystem::path& GetPath() const;
+		bool IsShard() const;
+		// Summed over the writer and every reader
+		StatementCacheStats GetStatementCacheStats();
+
+	private:
+		friend class ConnectionLease;
+
+		const SQLiteConnection* FindOrOpenReader();
+		void ReleaseWriter();
+		void Configure(const SQLiteConnection& connection, bool is_writer) const;
+
+		const std::uint64_t pool_id;
+		std::filesystem::path db_path;
+		config::DatabaseSettings settings;
+		std::filesystem::path catalog_path;
+
+		SQLiteConnection writer;
+		std::recursive_mutex writer_mutex;
+		std::atomic<std::thread::id> writer_owner;
+		int writer_depth{0};
+
+		std::mutex readers_mutex;
+		std::unordered_map<std::thread::id, std::unique_ptr<SQLiteConnection>> readers;
+	};
+} // namespace kanji::database
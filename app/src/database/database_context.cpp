@@ -1,13 +1,50 @@
 #include "database_context.h"
+#include <spdlog/spdlog.h>
+#include <stdexcept>
 
 namespace kanji::database
 {
-	DatabaseContext::DatabaseContext(std::filesystem::path in_db_path)
-	    : connection{std::move(in_db_path)}
-	    , kanji_repo{connection}
-	    , review_repo{connection}
+	DatabaseContext::DatabaseContext(std::filesystem::path in_db_path, const config::DatabaseSettings& in_settings,
+	                                 std::filesystem::path in_catalog_path)
+	    : pool{std::move(in_db_path), in_settings, std::move(in_catalog_path)}
+	    , kanji_repo{pool}
+	    , review_repo{pool}
 	{
-		connection.Initialize();
+		pool.Initialize();
+
+		if (!pool.IsShard())
+		{
+			backup_service = std::make_unique<BackupService>(pool, in_settings.backup);
+		}
+
+		if (in_settings.write_behind.enabled)
+		{
+			auto journal_path = pool.GetPath();
+			journal_path.replace_extension(".answers.log");
+			answer_journal = std::make_unique<AnswerJournal>(journal_path, in_settings.write_behind, review_repo);
+			if (!answer_journal->Open())
+			{
+				// A journal left in place would be replayed over the synchronous writes that follow
+				std::error_code error;
+				if (std::filesystem::exists(journal_path, error) && std::filesystem::file_size(journal_path, error) > 0)
+				{
+					throw std::runtime_error{"DatabaseContext: unreplayed write-behind journal left at " +
+					                         journal_path.string()};
+				}
+				spdlog::error("DatabaseContext: write-behind journal unavailable, writing answers synchronously");
+				answer_journal.reset();
+			}
+		}
+	}
+
+	const std::filesystem::path& DatabaseContext::GetPath() const
+	{
+		return pool.GetPath();
+	}
+
+	bool DatabaseContext::IsShard() const
+	{
+		return pool.IsShard();
 	}
 
 	KanjiRepository& DatabaseContext::GetKanjiRepository()
@@ -19,4 +56,24 @@ namespace kanji::database
 	{
 		return review_repo;
 	}
+
+	AnswerJournal* DatabaseContext::GetAnswerJournal()
+	{
+		return answer_journal.get();
+	}
+
+	BackupService* DatabaseContext::GetBackupService()
+	{
+		return backup_service.get();
+	}
+
+	std::filesystem::path DatabaseContext::GetCatalogSnapshotPath() const
+	{
+		return std::filesystem::path{pool.GetPath()}.replace_extension(".catalog");
+	}
+
+	StatementCacheStats DatabaseContext::GetStatementCacheStats()
+	{
+		return pool.GetStatementCacheStats();
+	}
 } // namespace kanji::database
@@ -1,23 +1,45 @@
 #pragma once
 
+#include "answer_journal.h"
+#include "backup_service.h"
+#include "config.h"
+#include "connection_pool.h"
 #include "kanji_repository.h"
 #include "review_state_repository.h"
-#include "sqlite_connection.h"
+#include "storage.h"
+#include <filesystem>
+#include <memory>
 #include <string>
 
 namespace kanji::database
 {
-	class DatabaseContext
+	// SQLite storage engine
+	class DatabaseContext : public IStorage
 	{
 	public:
-		explicit DatabaseContext(std::filesystem::path in_db_path);
+		// A non-empty catalog path opens `in_db_path` as a review-state shard of that catalog database
+		explicit DatabaseContext(std::filesystem::path in_db_path, const config::DatabaseSettings& in_settings = {},
+		                         std::filesystem::path in_catalog_path = {});
 
-		KanjiRepository& GetKanjiRepository();
-		ReviewStateRepository& GetReviewStateRepository();
+		const std::filesystem::path& GetPath() const;
+		// True when kanjis come from an attached catalog database
+		bool IsShard() const;
+		KanjiRepository& GetKanjiRepository() override;
+		ReviewStateRepository& GetReviewStateRepository() override;
+		// Null unless write-behind is enabled
+		AnswerJournal* GetAnswerJournal();
+		// Null for shards
+		BackupService* GetBackupService();
+		StatementCacheStats GetStatementCacheStats();
+		// Memory-mapped kanji catalog kept next to the database
+		std::filesystem::path GetCatalogSnapshotPath() const;
 
 	private:
-		SQLiteConnection connection;
+		ConnectionPool pool;
 		KanjiRepository kanji_repo;
 		ReviewStateRepository review_repo;
+		std::unique_ptr<BackupService> backup_service;
+		// Declared last so it flushes before the repositories go away
+		std::unique_ptr<AnswerJournal> answer_journal;
 	};
 } // namespace kanji::database
@@ -1,65 +1,137 @@
 #include "kanji_repository.h"
-#include "sqlite_connection.h"
+#include "connection_pool.h"
+#include "sql_params.h"
+#include "transaction.h"
+#include <algorithm>
+#include <charconv>
+#include <limits>
 #include <spdlog/spdlog.h>
 #include <sqlite3.h>
 
+namespace
+{
+	// Groups rows of (id, kanji, meaning, word, reading), one per example word, into KanjiData.
+	// Rows for the same kanji must be adjacent; a kanji without examples has NULL word columns.
+	std::vector<kanji::KanjiData> ReadKanjiDataRows(sqlite3_stmt* stmt)
+	{
+		std::vector<kanji::KanjiData> kanjis;
+		while (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			const std::uint32_t id = sqlite3_column_int(stmt, 0);
+			if (kanjis.empty() || kanjis.back().id != id)
+			{
+				kanji::KanjiData& kanji = kanjis.emplace_back();
+				kanji.id = id;
+				kanji.kanji = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+				kanji.meaning = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+			}
+
+			if (sqlite3_column_type(stmt, 3) != SQLITE_NULL)
+			{
+				kanji::KanjiWord& word = kanjis.back().examples.emplace_back();
+				word.word = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+				word.reading = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+			}
+		}
+		return kanjis;
+	}
+
+	// Row of (id, kanji, meaning, level, next_review_date)
+	kanji::KanjiRecord ReadKanjiRecord(sqlite3_stmt* stmt)
+	{
+		kanji::KanjiRecord entry;
+		entry.id = sqlite3_column_int(stmt, 0);
+		entry.kanji = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+		entry.meaning = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+		entry.level = sqlite3_column_int(stmt, 3);
+		entry.next_review_date = sqlite3_column_int64(stmt, 4);
+		return entry;
+	}
+} // namespace
+
 namespace kanji::database
 {
-	KanjiRepository::KanjiRepository(const SQLiteConnection& in_connection)
-	    : connection{in_connection}
+	KanjiRepository::KanjiRepository(ConnectionPool& in_pool)
+	    : pool{in_pool}
 	{
 	}
 
-	std::vector<KanjiData> KanjiRepository::GetKanjiForReview() const
+	std::vector<KanjiData> KanjiRepository::GetKanjiForReview(const int limit) const
 	{
-		std::vector<KanjiData> kanjis;
+		auto connection = pool.AcquireReader();
+
+		// Fetch the due kanjis together with their example words in one pass;
+		// rows arrive grouped by kanji, one row per example word.
 		const char* sql =
-		    "SELECT k.id, k.kanji, k.meaning "
+		    "WITH due AS ("
+		    "SELECT k.id, k.kanji, k.meaning, rs.next_review_date "
 		    "FROM kanjis k "
 		    "INNER JOIN kanji_review_state rs ON k.id = rs.kanji_id "
 		    "WHERE rs.next_review_date < ? "
-		    "ORDER BY rs.next_review_date "
-		    "LIMIT 5;";
-		sqlite3_stmt* stmt;
+		    "ORDER BY rs.next_review_date, rs.kanji_id "
+		    "LIMIT ?) "
+		    "SELECT due.id, due.kanji, due.meaning, w.word, w.reading "
+		    "FROM due "
+		    "LEFT JOIN kanji_words w ON w.kanji_id = due.id "
+		    "ORDER BY due.next_review_date, due.id, w.id;";
 
-		int rc = sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr);
-		if (rc != SQLITE_OK)
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return kanjis;
+			return {};
 		}
 
 		std::int64_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
 		sqlite3_bind_int64(stmt, 1, now);
+		sqlite3_bind_int(stmt, 2, limit);
 
-		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+		return ReadKanjiDataRows(stmt);
+	}
+
+	std::vector<KanjiData> KanjiRepository::GetKanjisByIds(const std::vector<std::uint32_t>& ids) const
+	{
+		if (ids.empty())
 		{
-			KanjiData kanji;
-			kanji.id = sqlite3_column_int(stmt, 0);
-			kanji.kanji = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-			kanji.meaning = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-			kanji.examples = GetKanjiWords(kanji.id);
-			kanjis.push_back(kanji);
+			return {};
 		}
 
-		sqlite3_finalize(stmt);
-		return kanjis;
+		auto connection = pool.AcquireReader();
+
+		const std::string ids_json = ToJsonArray(ids);
+
+		// json_each keys preserve the requested order
+		const char* sql =
+		    "SELECT k.id, k.kanji, k.meaning, w.word, w.reading "
+		    "FROM json_each(?) ids "
+		    "INNER JOIN kanjis k ON k.id = ids.value "
+		    "LEFT JOIN kanji_words w ON w.kanji_id = k.id "
+		    "ORDER BY ids.key, w.id;";
+
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt)
+		{
+			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
+			return {};
+		}
+
+		sqlite3_bind_text(stmt, 1, ids_json.c_str(), static_cast<int>(ids_json.size()), SQLITE_TRANSIENT);
+		return ReadKanjiDataRows(stmt);
 	}
 
-	void KanjiRepository::BatchInsertKanjis(const std::vector<KanjiData>& kanjis)
+	std::vector<std::uint32_t> KanjiRepository::BatchInsertKanjis(const std::vector<KanjiData>& kanjis)
 	{
+		std::vector<std::uint32_t> inserted_ids;
 		if (kanjis.empty())
 		{
-			return;
+			return inserted_ids;
 		}
 
-		char* err_msg = nullptr;
-		sqlite3_exec(connection, "BEGIN TRANSACTION;", nullptr, nullptr, &err_msg);
-		if (err_msg)
+		auto connection = pool.AcquireWriter();
+		Transaction transaction{connection};
+		if (!transaction)
 		{
-			spdlog::error("Failed to begin transaction: {0}", err_msg);
-			sqlite3_free(err_msg);
-			return;
+			return inserted_ids;
 		}
 
 		const char* kanji_sql = "INSERT INTO kanjis (kanji, meaning) VALUES (?, ?);";
@@ -68,17 +140,14 @@ namespace kanji::database
 		    "INSERT OR IGNORE INTO kanji_review_state (kanji_id, level, next_review_date, created_at) "
 		    "VALUES (?, 0, ?, ?);";
 
-		sqlite3_stmt* kanji_stmt;
-		sqlite3_stmt* word_stmt;
-		sqlite3_stmt* review_stmt;
+		SQLiteStatement kanji_stmt = connection->Prepare(kanji_sql);
+		SQLiteStatement word_stmt = connection->Prepare(word_sql);
+		SQLiteStatement review_stmt = connection->Prepare(review_sql);
 
-		if (sqlite3_prepare_v2(connection, kanji_sql, -1, &kanji_stmt, nullptr) != SQLITE_OK ||
-		    sqlite3_prepare_v2(connection, word_sql, -1, &word_stmt, nullptr) != SQLITE_OK ||
-		    sqlite3_prepare_v2(connection, review_sql, -1, &review_stmt, nullptr) != SQLITE_OK)
+		if (!kanji_stmt || !word_stmt || !review_stmt)
 		{
 			spdlog::error("Failed to prepare batch insert statements: {0}", sqlite3_errmsg(connection));
-			sqlite3_exec(connection, "ROLLBACK;", nullptr, nullptr, nullptr);
-			return;
+			return inserted_ids;
 		}
 
 		std::int64_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
@@ -97,6 +166,7 @@ namespace kanji::database
 
 			std::int64_t kanji_id = sqlite3_last_insert_rowid(connection);
 			sqlite3_reset(kanji_stmt);
+			inserted_ids.push_back(static_cast<std::uint32_t>(kanji_id));
 
 			for (const auto& word : kanji.examples)
 			{
@@ -123,75 +193,174 @@ namespace kanji::database
 			sqlite3_reset(review_stmt);
 		}
 
-		sqlite3_finalize(kanji_stmt);
-		sqlite3_finalize(word_stmt);
-		sqlite3_finalize(review_stmt);
-
-		sqlite3_exec(connection, "COMMIT;", nullptr, nullptr, &err_msg);
-		if (err_msg)
+		if (!transaction.Commit())
 		{
-			spdlog::error("Failed to commit transaction: {0}", err_msg);
-			sqlite3_free(err_msg);
+			inserted_ids.clear();
 		}
+		return inserted_ids;
 	}
 
 	std::vector<KanjiRecord> KanjiRepository::GetKanjis() const
 	{
 		std::vector<KanjiRecord> result;
+		ForEachKanji([&result](const KanjiRecord& record) {
+			result.push_back(record);
+			return true;
+		});
+		return result;
+	}
+
+	KanjiPage KanjiRepository::GetKanjiPage(std::optional<KanjiCursor> after, int limit) const
+	{
+		KanjiPage page;
+		limit = std::clamp(limit, 1, MAX_PAGE_SIZE);
+
+		auto connection = pool.AcquireReader();
+
+		// Row-value comparison lets SQLite seek idx_review_state_due instead of skipping OFFSET rows
+		const char* sql =
+		    "SELECT k.id, k.kanji, k.meaning, rs.level, rs.next_review_date "
+		    "FROM kanji_review_state rs "
+		    "INNER JOIN kanjis k ON k.id = rs.kanji_id "
+		    "WHERE (rs.next_review_date, rs.kanji_id) > (?, ?) "
+		    "ORDER BY rs.next_review_date, rs.kanji_id "
+		    "LIMIT ?;";
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt)
+		{
+			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
+			return page;
+		}
+
+		const KanjiCursor start = after.value_or(KanjiCursor{std::numeric_limits<std::int64_t>::min(), 0});
+		sqlite3_bind_int64(stmt, 1, start.next_review_date);
+		sqlite3_bind_int64(stmt, 2, start.id);
+		sqlite3_bind_int(stmt, 3, limit);
+
+		page.kanjis.reserve(limit);
+		while (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			page.kanjis.push_back(ReadKanjiRecord(stmt));
+		}
+
+		if (static_cast<int>(page.kanjis.size()) == limit)
+		{
+			page.next = KanjiCursor{page.kanjis.back().next_review_date, page.kanjis.back().id};
+		}
+		return page;
+	}
+
+	void KanjiRepository::ForEachKanji(const std::function<bool(const KanjiRecord&)>& visit) const
+	{
+		auto connection = pool.AcquireReader();
+
 		const char* sql =
 		    "SELECT k.id, k.kanji, k.meaning, rs.level, rs.next_review_date "
 		    "FROM kanjis k "
 		    "INNER JOIN kanji_review_state rs ON k.id = rs.kanji_id "
-		    "ORDER BY rs.next_review_date;";
-		sqlite3_stmt* stmt;
-
-		int rc = sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr);
-		if (rc != SQLITE_OK)
+		    "ORDER BY rs.next_review_date, rs.kanji_id;";
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return result;
+			return;
 		}
 
-		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+		while (sqlite3_step(stmt) == SQLITE_ROW)
 		{
-			KanjiRecord entry;
-			entry.id = sqlite3_column_int(stmt, 0);
-			entry.kanji = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-			entry.meaning = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
-			entry.level = sqlite3_column_int(stmt, 3);
-			entry.next_review_date = sqlite3_column_int64(stmt, 4);
-			result.push_back(entry);
+			if (!visit(ReadKanjiRecord(stmt)))
+			{
+				return;
+			}
 		}
-
-		sqlite3_finalize(stmt);
-		return result;
 	}
 
-	std::vector<KanjiWord> KanjiRepository::GetKanjiWords(const std::uint32_t kanji_id) const
+	std::shared_ptr<const catalog::KanjiCatalog> KanjiRepository::LoadCatalog() const
 	{
-		std::vector<KanjiWord> words;
-		const char* sql = "SELECT word, reading FROM kanji_words WHERE kanji_id = ?;";
-		sqlite3_stmt* stmt;
+		auto connection = pool.AcquireReader();
+		catalog::KanjiCatalog::Builder builder;
 
-		int rc = sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr);
-		if (rc != SQLITE_OK)
+		const char* sql =
+		    "SELECT k.id, k.kanji, k.meaning, w.word, w.reading "
+		    "FROM kanjis k "
+		    "LEFT JOIN kanji_words w ON w.kanji_id = k.id "
+		    "ORDER BY k.id, w.id;";
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return words;
+			return builder.Build();
 		}
 
-		sqlite3_bind_int(stmt, 1, kanji_id);
+		// Columns are read as views straight into the arena, without per-row strings
+		const auto column_text = [&stmt](int column) {
+			return std::string_view{reinterpret_cast<const char*>(sqlite3_column_text(stmt, column)),
+			                        static_cast<std::size_t>(sqlite3_column_bytes(stmt, column))};
+		};
 
-		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+		std::int64_t current_id = -1;
+		while (sqlite3_step(stmt) == SQLITE_ROW)
 		{
-			KanjiWord word;
-			word.word = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-			word.reading = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-			words.push_back(word);
+			const std::int64_t id = sqlite3_column_int64(stmt, 0);
+			if (id != current_id)
+			{
+				builder.Add(static_cast<std::uint32_t>(id), column_text(1), column_text(2));
+				current_id = id;
+			}
+
+			if (sqlite3_column_type(stmt, 3) != SQLITE_NULL)
+			{
+				builder.AddExample(column_text(3), column_text(4));
+			}
 		}
+		return builder.Build();
+	}
 
-		sqlite3_finalize(stmt);
-		return words;
+	std::uint64_t KanjiRepository::GetCatalogFingerprint() const
+	{
+		auto connection = pool.AcquireReader();
+
+		// The generation catches in-place edits and deletes that leave counts and ids unchanged
+		const char* sql =
+		    "SELECT (SELECT count(*) FROM kanjis), (SELECT max(id) FROM kanjis), "
+		    "(SELECT count(*) FROM kanji_words), (SELECT max(id) FROM kanji_words), "
+		    "(SELECT generation FROM catalog_generation);";
+		SQLiteStatement stmt = connection->Prepare(sql);
+		if (!stmt || sqlite3_step(stmt) != SQLITE_ROW)
+		{
+			spdlog::error("Failed to read catalog fingerprint: {0}", sqlite3_errmsg(connection));
+			return 0;
+		}
+
+		std::uint64_t fingerprint = 0xcbf29ce484222325ull;
+		for (int column = 0; column < 5; ++column)
+		{
+			fingerprint ^= static_cast<std::uint64_t>(sqlite3_column_int64(stmt, column));
+			fingerprint *= 0x100000001b3ull;
+		}
+		return fingerprint;
 	}
 
+	std::string KanjiCursor::ToString() const
+	{
+		return std::to_string(next_review_date) + ":" + std::to_string(id);
+	}
+
+	std::optional<KanjiCursor> KanjiCursor::Parse(std::string_view token)
+	{
+		KanjiCursor cursor;
+		const char* end = token.data() + token.size();
+		const auto [date_end, date_ec] = std::from_chars(token.data(), end, cursor.next_review_date);
+		if (date_ec != std::errc{} || date_end == end || *date_end != ':')
+		{
+			return std::nullopt;
+		}
+
+		const auto [id_end, id_ec] = std::from_chars(date_end + 1, end, cursor.id);
+		if (id_ec != std::errc{} || id_end != end)
+		{
+			return std::nullopt;
+		}
+		return cursor;
+	}
 } // namespace kanji::database
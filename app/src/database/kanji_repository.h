@@ -1,26 +1,43 @@
 #pragma once
 
+#include "catalog/kanji_catalog.h"
 #include "kanji.h"
+#include "storage.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 
 namespace kanji::database
 {
-	class SQLiteConnection;
+	class ConnectionPool;
 
-	class KanjiRepository
+	class KanjiRepository : public IKanjiRepository
 	{
 	public:
-		explicit KanjiRepository(const SQLiteConnection& in_connection);
+		explicit KanjiRepository(ConnectionPool& in_pool);
 
 		KanjiRepository(const KanjiRepository&) = delete;
 		KanjiRepository& operator=(const KanjiRepository&) = delete;
 
-		std::vector<KanjiData> GetKanjiForReview() const;
+		std::vector<KanjiData> GetKanjiForReview(int limit = DEFAULT_REVIEW_BATCH_SIZE) const;
+		// Kanjis with their examples, in the order of `ids`; unknown ids are skipped
+		std::vector<KanjiData> GetKanjisByIds(const std::vector<std::uint32_t>& ids) const;
 		std::vector<KanjiRecord> GetKanjis() const;
-		void BatchInsertKanjis(const std::vector<KanjiData>& kanjis);
+		// Up to `limit` rows strictly after `after`, or from the start without a cursor
+		KanjiPage GetKanjiPage(std::optional<KanjiCursor> after, int limit) const;
+		// Walks the whole list without materializing it; stops early when `visit` returns false
+		void ForEachKanji(const std::function<bool(const KanjiRecord&)>& visit) const;
+		// Snapshot of every kanji with its examples
+		std::shared_ptr<const catalog::KanjiCatalog> LoadCatalog() const override;
+		// Changes whenever kanjis or example words are added or removed
+		std::uint64_t GetCatalogFingerprint() const override;
+		// Returns the ids of the inserted kanjis, or nothing if the batch was rolled back
+		std::vector<std::uint32_t> BatchInsertKanjis(const std::vector<KanjiData>& kanjis) override;
 
 	private:
-		const SQLiteConnection& connection;
-
-		std::vector<KanjiWord> GetKanjiWords(std::uint32_t kanji_id) const;
+		ConnectionPool& pool;
 	};
 } // namespace kanji::database
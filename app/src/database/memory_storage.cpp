@@ -0,0 +1,233 @@
+#include "memory_storage.h"
+#include "scheduler/scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <shared_mutex>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace kanji::database
+{
+	namespace
+	{
+		std::int64_t ToSeconds(std::chrono::system_clock::time_point time)
+		{
+			return std::chrono::system_clock::to_time_t(time);
+		}
+
+		std::chrono::system_clock::time_point FromSeconds(std::int64_t seconds)
+		{
+			return std::chrono::system_clock::from_time_t(seconds);
+		}
+	} // namespace
+
+	struct MemoryTables
+	{
+		struct KanjiRow
+		{
+			std::string kanji;
+			std::string meaning;
+			// Slice of `words`
+			std::uint32_t first_word{};
+			std::uint32_t word_count{};
+		};
+
+		struct StateRow
+		{
+			bool active{false};
+			int level{};
+			std::int64_t next_review_date{};
+			std::int64_t created_at{};
+		};
+
+		mutable std::shared_mutex mutex;
+		// Kanji id N lives at index N - 1
+		std::vector<KanjiRow> kanjis;
+		std::vector<KanjiWord> words;
+		std::vector<StateRow> states;
+
+		KanjiReviewState ToState(std::uint32_t id) const
+		{
+			const StateRow& row = states[id - 1];
+			return {id, row.level, FromSeconds(row.next_review_date), FromSeconds(row.created_at)};
+		}
+
+		bool HasState(std::uint32_t id) const
+		{
+			return id >= 1 && id <= states.size() && states[id - 1].active;
+		}
+
+		void PutState(std::uint32_t id, int level, std::int64_t next_review_date, std::int64_t created_at)
+		{
+			StateRow& row = states[id - 1];
+			if (!row.active)
+			{
+				row.active = true;
+				row.created_at = created_at;
+			}
+			row.level = level;
+			row.next_review_date = next_review_date;
+		}
+	};
+
+	MemoryKanjiRepository::MemoryKanjiRepository(MemoryTables& in_tables)
+	    : tables{in_tables}
+	{
+	}
+
+	std::shared_ptr<const catalog::KanjiCatalog> MemoryKanjiRepository::LoadCatalog() const
+	{
+		std::shared_lock lock{tables.mutex};
+		catalog::KanjiCatalog::Builder builder;
+		for (std::size_t i = 0; i < tables.kanjis.size(); ++i)
+		{
+			const auto& row = tables.kanjis[i];
+			builder.Add(static_cast<std::uint32_t>(i + 1), row.kanji, row.meaning);
+			for (std::uint32_t w = row.first_word; w < row.first_word + row.word_count; ++w)
+			{
+				builder.AddExample(tables.words[w].word, tables.words[w].reading);
+			}
+		}
+		return builder.Build();
+	}
+
+	std::uint64_t MemoryKanjiRepository::GetCatalogFingerprint() const
+	{
+		std::shared_lock lock{tables.mutex};
+		std::uint64_t fingerprint = 0xcbf29ce484222325ull;
+		for (const std::uint64_t value : {tables.kanjis.size(), tables.words.size()})
+		{
+			fingerprint ^= value;
+			fingerprint *= 0x100000001b3ull;
+		}
+		return fingerprint;
+	}
+
+	std::vector<std::uint32_t> MemoryKanjiRepository::BatchInsertKanjis(const std::vector<KanjiData>& kanjis)
+	{
+		const std::int64_t now = ToSeconds(std::chrono::system_clock::now());
+		std::unique_lock lock{tables.mutex};
+
+		std::vector<std::uint32_t> inserted_ids;
+		inserted_ids.reserve(kanjis.size());
+		for (const auto& kanji : kanjis)
+		{
+			const auto id = static_cast<std::uint32_t>(tables.kanjis.size() + 1);
+			tables.kanjis.push_back({kanji.kanji, kanji.meaning, static_cast<std::uint32_t>(tables.words.size()),
+			                         static_cast<std::uint32_t>(kanji.examples.size())});
+			tables.words.insert(tables.words.end(), kanji.examples.begin(), kanji.examples.end());
+			tables.states.emplace_back();
+			tables.PutState(id, 0, now, now);
+			inserted_ids.push_back(id);
+		}
+		return inserted_ids;
+	}
+
+	MemoryReviewStateRepository::MemoryReviewStateRepository(MemoryTables& in_tables)
+	    : tables{in_tables}
+	{
+	}
+
+	std::vector<KanjiReviewState> MemoryReviewStateRepository::GetAllReviewStates()
+	{
+		std::shared_lock lock{tables.mutex};
+		std::vector<KanjiReviewState> states;
+		states.reserve(tables.states.size());
+		for (std::uint32_t id = 1; id <= tables.states.size(); ++id)
+		{
+			if (tables.states[id - 1].active)
+			{
+				states.push_back(tables.ToState(id));
+			}
+		}
+		return states;
+	}
+
+	std::vector<KanjiReviewState> MemoryReviewStateRepository::InitializeNewReviewStates(int count)
+	{
+		const std::int64_t now = ToSeconds(std::chrono::system_clock::now());
+		std::unique_lock lock{tables.mutex};
+
+		std::vector<KanjiReviewState> new_states;
+		for (std::uint32_t id = 1; id <= tables.states.size() && static_cast<int>(new_states.size()) < count; ++id)
+		{
+			if (!tables.states[id - 1].active)
+			{
+				tables.PutState(id, 0, now, now);
+				new_states.push_back(tables.ToState(id));
+			}
+		}
+		return new_states;
+	}
+
+	std::vector<KanjiReviewState> MemoryReviewStateRepository::ApplyAnswers(const std::vector<KanjiAnswer>& answers,
+	                                                                         const scheduler::IScheduler& scheduler)
+	{
+		std::unique_lock lock{tables.mutex};
+
+		// Repeated answers for one kanji chain, and each kanji is reported once, in first-answer order
+		std::vector<KanjiReviewState> new_states;
+		for (const auto& answer : answers)
+		{
+			if (!tables.HasState(answer.kanji_id))
+			{
+				spdlog::warn("Ignoring answer for kanji {0} without a review state", answer.kanji_id);
+				continue;
+			}
+
+			const auto next = scheduler.GetNextState(tables.ToState(answer.kanji_id), answer.incorrect_streak);
+			tables.PutState(answer.kanji_id, next.level, ToSeconds(next.next_review_date), ToSeconds(next.created_at));
+
+			auto previous = std::find_if(new_states.begin(), new_states.end(), [&](const KanjiReviewState& state) {
+				return state.kanji_id == answer.kanji_id;
+			});
+			if (previous != new_states.end())
+			{
+				*previous = next;
+			}
+			else
+			{
+				new_states.push_back(next);
+			}
+		}
+		return new_states;
+	}
+
+	bool MemoryReviewStateRepository::SaveReviewStates(const std::vector<KanjiReviewState>& states)
+	{
+		const std::int64_t now = ToSeconds(std::chrono::system_clock::now());
+		std::unique_lock lock{tables.mutex};
+		for (const auto& state : states)
+		{
+			if (state.kanji_id < 1 || state.kanji_id > tables.states.size())
+			{
+				spdlog::error("Cannot save review state for unknown kanji {0}", state.kanji_id);
+				return false;
+			}
+		}
+		for (const auto& state : states)
+		{
+			tables.PutState(state.kanji_id, state.level, ToSeconds(state.next_review_date), now);
+		}
+		return true;
+	}
+
+	MemoryStorage::MemoryStorage()
+	    : tables{std::make_unique<MemoryTables>()}
+	    , kanji_repo{*tables}
+	    , review_repo{*tables}
+	{
+	}
+
+	MemoryStorage::~MemoryStorage() = default;
+
+	MemoryKanjiRepository& MemoryStorage::GetKanjiRepository()
+	{
+		return kanji_repo;
+	}
+
+	MemoryReviewStateRepository& MemoryStorage::GetReviewStateRepository()
+	{
+		return review_repo;
+	}
+} // namespace kanji::database
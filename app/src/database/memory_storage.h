@@ -0,0 +1,56 @@
+#pragma once
+
+#include "storage.h"
+#include <memory>
+
+namespace kanji::database
+{
+	struct MemoryTables;
+
+	class MemoryKanjiRepository : public IKanjiRepository
+	{
+	public:
+		explicit MemoryKanjiRepository(MemoryTables& in_tables);
+
+		std::shared_ptr<const catalog::KanjiCatalog> LoadCatalog() const override;
+		std::uint64_t GetCatalogFingerprint() const override;
+		std::vector<std::uint32_t> BatchInsertKanjis(const std::vector<KanjiData>& kanjis) override;
+
+	private:
+		MemoryTables& tables;
+	};
+
+	class MemoryReviewStateRepository : public IReviewStateRepository
+	{
+	public:
+		explicit MemoryReviewStateRepository(MemoryTables& in_tables);
+
+		std::vector<KanjiReviewState> GetAllReviewStates() override;
+		std::vector<KanjiReviewState> InitializeNewReviewStates(int count) override;
+		std::vector<KanjiReviewState> ApplyAnswers(const std::vector<KanjiAnswer>& answers,
+		                                           const scheduler::IScheduler& scheduler) override;
+		bool SaveReviewStates(const std::vector<KanjiReviewState>& states) override;
+
+	private:
+		MemoryTables& tables;
+	};
+
+	// Storage engine that keeps everything in flat, id-indexed vectors and forgets it on exit.
+	// Same observable behaviour as the SQLite engine; meant for tests, benchmarks and demos.
+	class MemoryStorage : public IStorage
+	{
+	public:
+		MemoryStorage();
+		MemoryStorage(const MemoryStorage&) = delete;
+		MemoryStorage& operator=(const MemoryStorage&) = delete;
+		~MemoryStorage() override;
+
+		MemoryKanjiRepository& GetKanjiRepository() override;
+		MemoryReviewStateRepository& GetReviewStateRepository() override;
+
+	private:
+		std::unique_ptr<MemoryTables> tables;
+		MemoryKanjiRepository kanji_repo;
+		MemoryReviewStateRepository review_repo;
+	};
+} // namespace kanji::database
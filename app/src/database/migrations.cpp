@@ -0,0 +1,166 @@
+#include "migrations.h"
+#include <format>
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+#include <string>
+
+namespace
+{
+	using kanji::database::Migration;
+	using kanji::database::SecondaryIndex;
+
+	// Append-only: never edit a migration that has shipped, add a new one instead
+	constexpr Migration migrations[] = {
+	    {1, "initial schema",
+	     "CREATE TABLE IF NOT EXISTS kanjis ("
+	     "id INTEGER PRIMARY KEY,"
+	     "kanji TEXT NOT NULL,"
+	     "meaning TEXT NOT NULL"
+	     ");"
+	     "CREATE TABLE IF NOT EXISTS kanji_words ("
+	     "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+	     "kanji_id INTEGER NOT NULL,"
+	     "word TEXT NOT NULL,"
+	     "reading TEXT NOT NULL,"
+	     "FOREIGN KEY(kanji_id) REFERENCES kanjis(id) ON DELETE CASCADE"
+	     ");"
+	     "CREATE TABLE IF NOT EXISTS kanji_review_state ("
+	     "kanji_id INTEGER PRIMARY KEY,"
+	     "level INTEGER NOT NULL DEFAULT 0,"
+	     "incorrect_streak INTEGER NOT NULL DEFAULT 0,"
+	     "next_review_date INTEGER NOT NULL DEFAULT (unixepoch()),"
+	     "created_at INTEGER NOT NULL DEFAULT (unixepoch()),"
+	     "FOREIGN KEY(kanji_id) REFERENCES kanjis(id) ON DELETE CASCADE"
+	     ");"},
+	    {2, "covering indexes for the due queue and example lookups",
+	     // Due queue and the kanji list walk review states in next_review_date order
+	     "CREATE INDEX IF NOT EXISTS idx_review_state_due "
+	     "ON kanji_review_state(next_review_date, kanji_id, level);"
+	     // Example words are fetched per kanji in insertion order
+	     "CREATE INDEX IF NOT EXISTS idx_kanji_words_kanji "
+	     "ON kanji_words(kanji_id, id, word, reading);"},
+	    {3, "catalog generation bumped by every kanji or example change",
+	     // Part of the catalog fingerprint, so edits and deletes invalidate the snapshot file too
+	     "CREATE TABLE IF NOT EXISTS catalog_generation ("
+	     "id INTEGER PRIMARY KEY CHECK (id = 0),"
+	     "generation INTEGER NOT NULL"
+	     ");"
+	     "INSERT OR IGNORE INTO catalog_generation (id, generation) VALUES (0, 0);"
+	     "CREATE TRIGGER IF NOT EXISTS kanjis_insert_generation AFTER INSERT ON kanjis "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"
+	     "CREATE TRIGGER IF NOT EXISTS kanjis_update_generation AFTER UPDATE ON kanjis "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"
+	     "CREATE TRIGGER IF NOT EXISTS kanjis_delete_generation AFTER DELETE ON kanjis "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"
+	     "CREATE TRIGGER IF NOT EXISTS kanji_words_insert_generation AFTER INSERT ON kanji_words "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"
+	     "CREATE TRIGGER IF NOT EXISTS kanji_words_update_generation AFTER UPDATE ON kanji_words "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"
+	     "CREATE TRIGGER IF NOT EXISTS kanji_words_delete_generation AFTER DELETE ON kanji_words "
+	     "BEGIN UPDATE catalog_generation SET generation = generation + 1; END;"},
+	};
+
+	// No foreign key: kanjis live in another database file
+	constexpr Migration shard_migrations[] = {
+	    {1, "review state shard",
+	     "CREATE TABLE IF NOT EXISTS kanji_review_state ("
+	     "kanji_id INTEGER PRIMARY KEY,"
+	     "level INTEGER NOT NULL DEFAULT 0,"
+	     "incorrect_streak INTEGER NOT NULL DEFAULT 0,"
+	     "next_review_date INTEGER NOT NULL DEFAULT (unixepoch()),"
+	     "created_at INTEGER NOT NULL DEFAULT (unixepoch())"
+	     ");"
+	     "CREATE INDEX IF NOT EXISTS idx_review_state_due "
+	     "ON kanji_review_state(next_review_date, kanji_id, level);"},
+	};
+
+	constexpr SecondaryIndex secondary_indexes[] = {
+	    {"idx_review_state_due",
+	     "CREATE INDEX IF NOT EXISTS idx_review_state_due ON kanji_review_state(next_review_date, kanji_id, level);"},
+	    {"idx_kanji_words_kanji",
+	     "CREATE INDEX IF NOT EXISTS idx_kanji_words_kanji ON kanji_words(kanji_id, id, word, reading);"},
+	};
+
+	bool Execute(sqlite3* db, const char* sql)
+	{
+		char* err_msg = nullptr;
+		if (sqlite3_exec(db, sql, nullptr, nullptr, &err_msg) != SQLITE_OK)
+		{
+			spdlog::error("SQL error: {0}", err_msg ? err_msg : sqlite3_errmsg(db));
+			sqlite3_free(err_msg);
+			return false;
+		}
+		return true;
+	}
+} // namespace
+
+namespace kanji::database
+{
+	std::span<const Migration> GetMigrations()
+	{
+		return migrations;
+	}
+
+	std::span<const Migration> GetShardMigrations()
+	{
+		return shard_migrations;
+	}
+
+	std::span<const SecondaryIndex> GetSecondaryIndexes()
+	{
+		return secondary_indexes;
+	}
+
+	bool EnsureSecondaryIndexes(sqlite3* db)
+	{
+		for (const SecondaryIndex& index : secondary_indexes)
+		{
+			if (!Execute(db, index.sql))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	int GetSchemaVersion(sqlite3* db)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		int version = 0;
+		if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK &&
+		    sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			version = sqlite3_column_int(stmt, 0);
+		}
+		sqlite3_finalize(stmt);
+		return version;
+	}
+
+	bool ApplyMigrations(sqlite3* db, std::span<const Migration> in_migrations)
+	{
+		const int current_version = GetSchemaVersion(db);
+		for (const Migration& migration : in_migrations)
+		{
+			if (migration.version <= current_version)
+			{
+				continue;
+			}
+
+			spdlog::info("Applying schema migration {0}: {1}", migration.version, migration.description);
+
+			if (!Execute(db, "BEGIN IMMEDIATE TRANSACTION;"))
+			{
+				return false;
+			}
+
+			const std::string set_version = std::format("PRAGMA user_version = {};", migration.version);
+			if (!Execute(db, migration.sql) || !Execute(db, set_version.c_str()) || !Execute(db, "COMMIT;"))
+			{
+				Execute(db, "ROLLBACK;");
+				spdlog::error("Schema migration {0} failed", migration.version);
+				return false;
+			}
+		}
+		return true;
+	}
+} // namespace kanji::database
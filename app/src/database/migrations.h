@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+
+struct sqlite3;
+
+namespace kanji::database
+{
+	struct Migration
+	{
+		// Value stored in PRAGMA user_version once the migration has been applied
+		int version;
+		const char* description;
+		const char* sql;
+	};
+
+	struct SecondaryIndex
+	{
+		const char* name;
+		// Same definition the migrations create
+		const char* sql;
+	};
+
+	std::span<const Migration> GetMigrations();
+	// Schema of a per-user review-state shard; kanjis are read from the attached catalog database
+	std::span<const Migration> GetShardMigrations();
+	// Indexes that bulk loads may drop and rebuild once the rows are in
+	std::span<const SecondaryIndex> GetSecondaryIndexes();
+	// Recreates any secondary index a bulk load dropped and never got to rebuild
+	bool EnsureSecondaryIndexes(sqlite3* db);
+	int GetSchemaVersion(sqlite3* db);
+
+	// Brings the schema up to the latest version, one transaction per migration
+	bool ApplyMigrations(sqlite3* db, std::span<const Migration> in_migrations = GetMigrations());
+} // namespace kanji::database
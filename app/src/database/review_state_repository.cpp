@@ -1,81 +1,89 @@
 #include "review_state_repository.h"
+#include "connection_pool.h"
 #include "kanji.h"
 #include "scheduler/scheduler.h"
-#include "sqlite_connection.h"
+#include "sql_params.h"
+#include "transaction.h"
+#include "utils/utf8.h"
+#include <algorithm>
+#include <format>
 #include <spdlog/spdlog.h>
 #include <sqlite3.h>
 #include <vector>
 
+namespace
+{
+	std::vector<kanji::KanjiReviewState> ReadReviewStateRows(sqlite3_stmt* stmt)
+	{
+		std::vector<kanji::KanjiReviewState> states;
+		while (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			kanji::KanjiReviewState state;
+			state.kanji_id = sqlite3_column_int(stmt, 0);
+			state.level = sqlite3_column_int(stmt, 1);
+			std::int64_t next_review_timestamp = sqlite3_column_int64(stmt, 2);
+			std::int64_t created_timestamp = sqlite3_column_int64(stmt, 3);
+			state.next_review_date = std::chrono::system_clock::from_time_t(next_review_timestamp);
+			state.created_at = std::chrono::system_clock::from_time_t(created_timestamp);
+
+			states.push_back(state);
+		}
+		return states;
+	}
+} // namespace
+
 namespace kanji::database
 {
 	std::vector<KanjiReviewState> ReviewStateRepository::GetReviewStates(const std::vector<std::uint32_t>& ids)
 	{
-		std::vector<KanjiReviewState> states;
-
 		if (ids.empty())
 		{
-			return states;
+			return {};
 		}
 
-		// Build the IN clause with placeholders
-		std::string placeholders(ids.size() * 2 - 1, ',');
-		for (size_t i = 0; i < ids.size(); ++i)
-		{
-			placeholders[i * 2] = '?';
-		}
+		auto connection = pool.AcquireReader();
 
-		std::string select_sql =
-		    "SELECT kanji_id, level, next_review_date, created_at FROM kanji_review_state WHERE kanji_id IN (" +
-		    placeholders + ");";
+		const std::string ids_json = ToJsonArray(ids);
+		const char* select_sql =
+		    "SELECT kanji_id, level, next_review_date, created_at FROM kanji_review_state "
+		    "WHERE kanji_id IN (SELECT value FROM json_each(?));";
 
-		sqlite3_stmt* stmt;
-		int rc = sqlite3_prepare_v2(connection, select_sql.c_str(), -1, &stmt, nullptr);
-		if (rc != SQLITE_OK)
+		SQLiteStatement stmt = connection->Prepare(select_sql);
+		if (!stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return states;
-		}
-
-		// Bind all the IDs
-		for (size_t i = 0; i < ids.size(); ++i)
-		{
-			sqlite3_bind_int(stmt, static_cast<int>(i + 1), ids[i]);
+			return {};
 		}
 
-		// Fetch all matching states
-		while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
-		{
-			KanjiReviewState state;
-			state.kanji_id = sqlite3_column_int(stmt, 0);
-			state.level = sqlite3_column_int(stmt, 1);
-			std::int64_t next_review_timestamp = sqlite3_column_int64(stmt, 2);
-			std::int64_t created_timestamp = sqlite3_column_int64(stmt, 3);
-			state.next_review_date = std::chrono::system_clock::from_time_t(next_review_timestamp);
-			state.created_at = std::chrono::system_clock::from_time_t(created_timestamp);
-
-			states.push_back(state);
-		}
+		sqlite3_bind_text(stmt, 1, ids_json.c_str(), static_cast<int>(ids_json.size()), SQLITE_TRANSIENT);
+		return ReadReviewStateRows(stmt);
+	}
 
-		sqlite3_finalize(stmt);
+	std::vector<KanjiReviewState> ReviewStateRepository::GetAllReviewStates()
+	{
+		auto connection = pool.AcquireReader();
 
-		if (rc != SQLITE_DONE && rc != SQLITE_ROW)
+		const char* select_sql = "SELECT kanji_id, level, next_review_date, created_at FROM kanji_review_state;";
+		SQLiteStatement stmt = connection->Prepare(select_sql);
+		if (!stmt)
 		{
-			spdlog::error("Failed to fetch review states: {0}", sqlite3_errmsg(connection));
+			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
+			return {};
 		}
 
-		return states;
+		return ReadReviewStateRows(stmt);
 	}
 
 	std::unordered_map<char32_t, int> ReviewStateRepository::GetAllReviewLevels()
 	{
+		auto connection = pool.AcquireReader();
+
 		const char* select_sql = "SELECT k.kanji, krs.level "
 		                         "FROM kanjis k "
 		                         "INNER JOIN kanji_review_state krs ON k.id = krs.kanji_id;";
 
-		sqlite3_stmt* select_stmt;
-
-		int rc = sqlite3_prepare_v2(connection, select_sql, -1, &select_stmt, nullptr);
-		if (rc != SQLITE_OK)
+		SQLiteStatement select_stmt = connection->Prepare(select_sql);
+		if (!select_stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
 			return {};
@@ -83,124 +91,201 @@ namespace kanji::database
 
 		std::unordered_map<char32_t, int> result;
 
-		while ((rc = sqlite3_step(select_stmt)) == SQLITE_ROW)
+		while (sqlite3_step(select_stmt) == SQLITE_ROW)
 		{
-			const unsigned char* kanji = sqlite3_column_text(select_stmt, 0);
+			const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(select_stmt, 0));
 			const int level = sqlite3_column_int(select_stmt, 1);
-			// Decode UTF-8 to char32_t (most kanji are 3-byte UTF-8)
-			char32_t kanji_char;
-			if ((kanji[0] & 0xF0) == 0xE0) // 3-byte
+			const std::string_view kanji{text ? text : "", static_cast<std::size_t>(sqlite3_column_bytes(select_stmt, 0))};
+			if (kanji.empty())
 			{
-				kanji_char = ((kanji[0] & 0x0F) << 12) |
-				             ((kanji[1] & 0x3F) << 6) |
-				             (kanji[2] & 0x3F);
-			}
-			else if ((kanji[0] & 0xF8) == 0xF0) // 4-byte (rare)
-			{
-				kanji_char = ((kanji[0] & 0x07) << 18) |
-				             ((kanji[1] & 0x3F) << 12) |
-				             ((kanji[2] & 0x3F) << 6) |
-				             (kanji[3] & 0x3F);
-			}
-			else
-			{
-				kanji_char = kanji[0]; // fallback
+				continue;
 			}
 
+			std::size_t length = 0;
+			const char32_t kanji_char = utils::utf8::Decode(kanji, 0, length);
 			result.emplace(kanji_char, level);
 		}
 
 		return result;
 	}
 
-	void ReviewStateRepository::InitializeNewReviewStates(int count)
+	std::vector<KanjiReviewState> ReviewStateRepository::InitializeNewReviewStates(int count)
 	{
-		// Get next K kanjis that don't have review states
-		const char* select_sql =
-		    "SELECT id FROM kanjis "
-		    "WHERE id NOT IN (SELECT kanji_id FROM kanji_review_state) "
-		    "ORDER BY id LIMIT ?;";
-		sqlite3_stmt* select_stmt;
+		if (count <= 0)
+		{
+			return {};
+		}
+
+		auto connection = pool.AcquireWriter();
+		Transaction transaction{connection};
+		if (!transaction)
+		{
+			return {};
+		}
 
-		int rc = sqlite3_prepare_v2(connection, select_sql, -1, &select_stmt, nullptr);
-		if (rc != SQLITE_OK)
+		// One anti-join picks the next `count` kanjis without a review state and inserts them in a single statement
+		const char* insert_sql =
+		    "INSERT INTO kanji_review_state (kanji_id, level, incorrect_streak, next_review_date, created_at) "
+		    "SELECT k.id, 0, 0, ?2, ?2 FROM kanjis k "
+		    "LEFT JOIN kanji_review_state krs ON krs.kanji_id = k.id "
+		    "WHERE krs.kanji_id IS NULL "
+		    "ORDER BY k.id LIMIT ?1 "
+		    "RETURNING kanji_id;";
+
+		SQLiteStatement insert_stmt = connection->Prepare(insert_sql);
+		if (!insert_stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return;
+			return {};
 		}
 
-		sqlite3_bind_int(select_stmt, 1, count);
+		const std::int64_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+		sqlite3_bind_int(insert_stmt, 1, count);
+		sqlite3_bind_int64(insert_stmt, 2, now);
 
 		std::vector<std::uint32_t> kanji_ids;
-		while ((rc = sqlite3_step(select_stmt)) == SQLITE_ROW)
+		kanji_ids.reserve(count);
+		int rc;
+		while ((rc = sqlite3_step(insert_stmt)) == SQLITE_ROW)
 		{
-			kanji_ids.push_back(sqlite3_column_int(select_stmt, 0));
+			kanji_ids.push_back(static_cast<std::uint32_t>(sqlite3_column_int64(insert_stmt, 0)));
 		}
-		sqlite3_finalize(select_stmt);
+		if (rc != SQLITE_DONE)
+		{
+			spdlog::error("Failed to insert review states: {0}", sqlite3_errmsg(connection));
+			return {};
+		}
+		sqlite3_reset(insert_stmt);
 
-		// Insert new review states with next_review_date = created_at = now()
-		std::int64_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-		const char* insert_sql =
-		    "INSERT INTO kanji_review_state (kanji_id, level, incorrect_streak, next_review_date, created_at) "
-		    "VALUES (?, 0, 0, ?, ?);";
+		if (!transaction.Commit())
+		{
+			return {};
+		}
 
-		for (std::uint32_t kanji_id : kanji_ids)
+		// RETURNING does not promise any row order
+		std::sort(kanji_ids.begin(), kanji_ids.end());
+
+		const auto now_time = std::chrono::system_clock::from_time_t(now);
+		std::vector<KanjiReviewState> new_states;
+		new_states.reserve(kanji_ids.size());
+		for (const std::uint32_t kanji_id : kanji_ids)
 		{
-			sqlite3_stmt* insert_stmt;
-			rc = sqlite3_prepare_v2(connection, insert_sql, -1, &insert_stmt, nullptr);
-			if (rc != SQLITE_OK)
-			{
-				spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-				return;
-			}
+			new_states.push_back({kanji_id, 0, now_time, now_time});
+		}
+		return new_states;
+	}
+
+	std::vector<KanjiReviewState> ReviewStateRepository::ApplyAnswers(const std::vector<KanjiAnswer>& answers,
+	                                                                   const scheduler::IScheduler& scheduler)
+	{
+		if (answers.empty())
+		{
+			return {};
+		}
 
-			sqlite3_bind_int(insert_stmt, 1, kanji_id);
-			sqlite3_bind_int64(insert_stmt, 2, now);
-			sqlite3_bind_int64(insert_stmt, 3, now);
+		auto connection = pool.AcquireWriter();
+		Transaction transaction{connection};
+		if (!transaction)
+		{
+			return {};
+		}
+
+		std::vector<std::uint32_t> ids;
+		ids.reserve(answers.size());
+		std::transform(answers.begin(), answers.end(), std::back_inserter(ids), [](const KanjiAnswer& answer) {
+			return answer.kanji_id;
+		});
+
+		// Rows come back in no particular order, so match them to answers by kanji_id
+		std::unordered_map<std::uint32_t, KanjiReviewState> states_by_id;
+		for (const auto& state : GetReviewStates(ids))
+		{
+			states_by_id.emplace(state.kanji_id, state);
+		}
 
-			rc = sqlite3_step(insert_stmt);
-			sqlite3_finalize(insert_stmt);
+		std::vector<std::uint32_t> updated_ids;
+		updated_ids.reserve(answers.size());
+		for (const auto& answer : answers)
+		{
+			auto it = states_by_id.find(answer.kanji_id);
+			if (it == states_by_id.end())
+			{
+				spdlog::warn("Ignoring answer for kanji {0} without a review state", answer.kanji_id);
+				continue;
+			}
 
-			if (rc != SQLITE_DONE)
+			if (std::find(updated_ids.begin(), updated_ids.end(), answer.kanji_id) == updated_ids.end())
 			{
-				spdlog::error("Failed to insert review state: {0}", sqlite3_errmsg(connection));
-				return;
+				updated_ids.push_back(answer.kanji_id);
 			}
+			it->second = scheduler.GetNextState(it->second, answer.incorrect_streak);
+		}
+
+		std::vector<KanjiReviewState> new_states;
+		new_states.reserve(updated_ids.size());
+		for (const std::uint32_t id : updated_ids)
+		{
+			new_states.push_back(states_by_id.at(id));
 		}
+
+		if (!UpsertReviewStates(*connection, new_states) || !transaction.Commit())
+		{
+			return {};
+		}
+
+		return new_states;
 	}
 
-	void ReviewStateRepository::CreateOrUpdateReviewState(const KanjiReviewState& state)
+	bool ReviewStateRepository::SaveReviewStates(const std::vector<KanjiReviewState>& states)
 	{
+		if (states.empty())
+		{
+			return true;
+		}
+
+		auto connection = pool.AcquireWriter();
+		Transaction transaction{connection};
+		return transaction && UpsertReviewStates(*connection, states) && transaction.Commit();
+	}
+
+	bool ReviewStateRepository::UpsertReviewStates(const SQLiteConnection& connection,
+	                                               const std::vector<KanjiReviewState>& states) const
+	{
+		// All rows go in as one JSON array of [kanji_id, level, next_review_date] triples
+		std::string rows_json = "[";
+		for (size_t i = 0; i < states.size(); ++i)
+		{
+			const auto& state = states[i];
+			if (i > 0)
+			{
+				rows_json += ',';
+			}
+			rows_json += std::format("[{},{},{}]", state.kanji_id, state.level,
+			                         static_cast<std::int64_t>(std::chrono::system_clock::to_time_t(state.next_review_date)));
+		}
+		rows_json += ']';
+
 		const char* sql =
 		    "INSERT INTO kanji_review_state (kanji_id, level, next_review_date, created_at) "
-		    "VALUES (?, ?, ?, unixepoch()) "
+		    "SELECT value ->> 0, value ->> 1, value ->> 2, unixepoch() FROM json_each(?) WHERE true "
 		    "ON CONFLICT(kanji_id) DO UPDATE SET "
 		    "level = excluded.level, "
 		    "next_review_date = excluded.next_review_date;";
-		sqlite3_stmt* stmt;
-
-		int rc = sqlite3_prepare_v2(connection, sql, -1, &stmt, nullptr);
-		if (rc != SQLITE_OK)
+		SQLiteStatement stmt = connection.Prepare(sql);
+		if (!stmt)
 		{
 			spdlog::error("Failed to prepare statement: {0}", sqlite3_errmsg(connection));
-			return;
+			return false;
 		}
 
-		std::int64_t timestamp = std::chrono::system_clock::to_time_t(state.next_review_date);
+		sqlite3_bind_text(stmt, 1, rows_json.c_str(), static_cast<int>(rows_json.size()), SQLITE_TRANSIENT);
 
-		sqlite3_bind_int(stmt, 1, state.kanji_id);
-		sqlite3_bind_int(stmt, 2, state.level);
-		sqlite3_bind_int64(stmt, 3, timestamp);
-
-		rc = sqlite3_step(stmt);
-		sqlite3_finalize(stmt);
-
-		if (rc != SQLITE_DONE)
+		if (sqlite3_step(stmt) != SQLITE_DONE)
 		{
-			spdlog::error("Failed to insert/update review state: {0}", sqlite3_errmsg(connection));
-			return;
+			spdlog::error("Failed to insert/update review states: {0}", sqlite3_errmsg(connection));
+			return false;
 		}
 
-		return;
+		return true;
 	}
 } // namespace kanji::database
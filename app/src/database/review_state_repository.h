@@ -1,5 +1,6 @@
 #pragma once
 
+#include "storage.h"
 #include <cstdint>
 #include <unordered_map>
 #include <vector>
@@ -10,23 +11,36 @@ namespace kanji
 	struct KanjiAnswer;
 } // namespace kanji
 
+namespace kanji::scheduler
+{
+	class IScheduler;
+}
+
 namespace kanji::database
 {
+	class ConnectionPool;
 	class SQLiteConnection;
 
-	class ReviewStateRepository
+	class ReviewStateRepository : public IReviewStateRepository
 	{
 	public:
-		explicit ReviewStateRepository(const SQLiteConnection& in_connection)
-		    : connection{in_connection}
+		explicit ReviewStateRepository(ConnectionPool& in_pool)
+		    : pool{in_pool}
 		{}
 
 		std::vector<KanjiReviewState> GetReviewStates(const std::vector<std::uint32_t>& ids);
+		std::vector<KanjiReviewState> GetAllReviewStates() override;
 		std::unordered_map<char32_t, int> GetAllReviewLevels();
-		void InitializeNewReviewStates(int count);
-		void CreateOrUpdateReviewState(const KanjiReviewState& state);
+		// Starts reviews for the next `count` kanjis without a review state; returns the created states
+		std::vector<KanjiReviewState> InitializeNewReviewStates(int count) override;
+		// Computes and stores the next state for every answer in one transaction; returns the new states
+		std::vector<KanjiReviewState> ApplyAnswers(const std::vector<KanjiAnswer>& answers,
+		                                           const scheduler::IScheduler& scheduler) override;
+		bool SaveReviewStates(const std::vector<KanjiReviewState>& states) override;
 
 	private:
-		const SQLiteConnection& connection;
+		bool UpsertReviewStates(const SQLiteConnection& connection, const std::vector<KanjiReviewState>& states) const;
+
+		ConnectionPool& pool;
 	};
 } // namespace kanji::database
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace kanji::database
+{
+	// Encodes ids as a JSON array for binding to json_each(?), which keeps
+	// IN-list statements constant so they stay in the statement cache
+	inline std::string ToJsonArray(const std::vector<std::uint32_t>& ids)
+	{
+		std::string json = "[";
+		for (size_t i = 0; i < ids.size(); ++i)
+		{
+			if (i > 0)
+			{
+				json += ',';
+			}
+			json += std::to_string(ids[i]);
+		}
+		json += ']';
+		return json;
+	}
+} // namespace kanji::database
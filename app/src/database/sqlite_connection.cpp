@@ -1,20 +1,26 @@
 #include "sqlite_connection.h"
+#include "migrations.h"
 #include <iostream>
 #include <spdlog/spdlog.h>
 #include <sqlite3.h>
 
 namespace kanji::database
 {
-	SQLiteConnection::SQLiteConnection(std::filesystem::path in_db_path)
+	SQLiteConnection::SQLiteConnection(std::filesystem::path in_db_path, const OpenMode in_mode)
 	    : db_path{std::move(in_db_path)}
 	{
-
-		if (!std::filesystem::exists(db_path))
+		// URI filenames let shards ATTACH the catalog database read-only
+		int flags = SQLITE_OPEN_READONLY | SQLITE_OPEN_URI;
+		if (in_mode == OpenMode::ReadWrite)
 		{
-			std::filesystem::create_directories(db_path.parent_path());
+			flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI;
+			if (!std::filesystem::exists(db_path) && db_path.has_parent_path())
+			{
+				std::filesystem::create_directories(db_path.parent_path());
+			}
 		}
 
-		int rc = sqlite3_open(reinterpret_cast<const char*>(db_path.u8string().c_str()), &db);
+		int rc = sqlite3_open_v2(reinterpret_cast<const char*>(db_path.u8string().c_str()), &db, flags, nullptr);
 		if (rc != SQLITE_OK)
 		{
 			spdlog::error("Cannot open database: {0}", sqlite3_errmsg(db));
@@ -23,76 +29,73 @@ namespace kanji::database
 
 	SQLiteConnection::~SQLiteConnection()
 	{
+		for (auto& [sql, stmt] : statement_cache)
+		{
+			sqlite3_finalize(stmt);
+		}
+		statement_cache.clear();
+
 		if (db)
 		{
 			sqlite3_close(db);
 		}
 	}
 
-	bool SQLiteConnection::Initialize()
+	bool SQLiteConnection::Initialize(std::span<const Migration> migrations)
 	{
-		const char* kanji_table_sql =
-		    "CREATE TABLE IF NOT EXISTS kanjis ("
-		    "id INTEGER PRIMARY KEY,"
-		    "kanji TEXT NOT NULL,"
-		    "meaning TEXT NOT NULL"
-		    ");";
-
-		const char* words_table_sql =
-		    "CREATE TABLE IF NOT EXISTS kanji_words ("
-		    "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-		    "kanji_id INTEGER NOT NULL,"
-		    "word TEXT NOT NULL,"
-		    "reading TEXT NOT NULL,"
-		    "FOREIGN KEY(kanji_id) REFERENCES kanjis(id) ON DELETE CASCADE"
-		    ");";
+		return ApplyMigrations(db, migrations);
+	}
 
-		const char* review_state_table_sql =
-		    "CREATE TABLE IF NOT EXISTS kanji_review_state ("
-		    "kanji_id INTEGER PRIMARY KEY,"
-		    "level INTEGER NOT NULL DEFAULT 0,"
-		    "incorrect_streak INTEGER NOT NULL DEFAULT 0,"
-		    "next_review_date INTEGER NOT NULL DEFAULT (unixepoch()),"
-		    "created_at INTEGER NOT NULL DEFAULT (unixepoch()),"
-		    "FOREIGN KEY(kanji_id) REFERENCES kanjis(id) ON DELETE CASCADE"
-		    ");";
+	sqlite3* SQLiteConnection::GetDB() const
+	{
+		return db;
+	}
 
-		char* err_msg = nullptr;
+	const std::filesystem::path& SQLiteConnection::GetPath() const
+	{
+		return db_path;
+	}
 
-		int rc = sqlite3_exec(db, kanji_table_sql, nullptr, nullptr, &err_msg);
-		if (rc != SQLITE_OK)
-		{
-			spdlog::error("SQL error: {0}", err_msg);
-			sqlite3_free(err_msg);
-			return false;
-		}
+	SQLiteConnection::operator sqlite3*() const
+	{
+		return GetDB();
+	}
 
-		rc = sqlite3_exec(db, words_table_sql, nullptr, nullptr, &err_msg);
-		if (rc != SQLITE_OK)
+	SQLiteStatement SQLiteConnection::Prepare(std::string_view sql) const
+	{
+		std::string key{sql};
 		{
-			spdlog::error("SQL error: {0}", err_msg);
-			sqlite3_free(err_msg);
-			return false;
+			std::lock_guard lock(statement_cache_mutex);
+			if (auto it = statement_cache.find(key); it != statement_cache.end())
+			{
+				sqlite3_stmt* stmt = it->second;
+				statement_cache.erase(it);
+				++statement_cache_hits;
+				return SQLiteStatement{*this, std::move(key), stmt};
+			}
 		}
 
-		rc = sqlite3_exec(db, review_state_table_sql, nullptr, nullptr, &err_msg);
-		if (rc != SQLITE_OK)
+		++statement_cache_misses;
+		sqlite3_stmt* stmt = nullptr;
+		if (sqlite3_prepare_v3(db, key.c_str(), static_cast<int>(key.size()), SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK)
 		{
-			spdlog::error("SQL error: {0}", err_msg);
-			sqlite3_free(err_msg);
-			return false;
+			sqlite3_finalize(stmt);
+			return {};
 		}
-
-		return true;
+		return SQLiteStatement{*this, std::move(key), stmt};
 	}
 
-	sqlite3* SQLiteConnection::GetDB() const
+	StatementCacheStats SQLiteConnection::GetStatementCacheStats() const
 	{
-		return db;
+		return {statement_cache_hits.load(), statement_cache_misses.load()};
 	}
 
-	SQLiteConnection::operator sqlite3*() const
+	void SQLiteConnection::ReleaseStatement(std::string sql, sqlite3_stmt* stmt) const
 	{
-		return GetDB();
+		sqlite3_reset(stmt);
+		sqlite3_clear_bindings(stmt);
+
+		std::lock_guard lock(statement_cache_mutex);
+		statement_cache.emplace(std::move(sql), stmt);
 	}
 } // namespace kanji::database
@@ -1,26 +1,64 @@
 #pragma once
 
+#include "migrations.h"
+#include "sqlite_statement.h"
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 struct sqlite3;
+struct sqlite3_stmt;
 
 namespace kanji::database
 {
+	struct StatementCacheStats
+	{
+		std::uint64_t hits{};
+		std::uint64_t misses{};
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(StatementCacheStats, hits, misses)
+
+	enum class OpenMode
+	{
+		ReadWrite,
+		ReadOnly
+	};
+
 	class SQLiteConnection
 	{
 	public:
-		explicit SQLiteConnection(std::filesystem::path in_db_path);
+		explicit SQLiteConnection(std::filesystem::path in_db_path, OpenMode in_mode = OpenMode::ReadWrite);
 		SQLiteConnection(const SQLiteConnection&) = delete;
 		SQLiteConnection& operator=(const SQLiteConnection&) = delete;
 		~SQLiteConnection();
 
-		bool Initialize();
+		bool Initialize(std::span<const Migration> migrations = GetMigrations());
 		sqlite3* GetDB() const;
+		const std::filesystem::path& GetPath() const;
 		operator sqlite3*() const;
 
+		// Returns a cached prepared statement for the given SQL text, preparing it on first use.
+		// The handle is empty if preparation failed.
+		SQLiteStatement Prepare(std::string_view sql) const;
+		StatementCacheStats GetStatementCacheStats() const;
+
 	private:
-		sqlite3* db;
+		friend class SQLiteStatement;
+		void ReleaseStatement(std::string sql, sqlite3_stmt* stmt) const;
+
+		sqlite3* db{nullptr};
 		std::filesystem::path db_path;
+
+		mutable std::mutex statement_cache_mutex;
+		mutable std::unordered_multimap<std::string, sqlite3_stmt*> statement_cache;
+		mutable std::atomic<std::uint64_t> statement_cache_hits{0};
+		mutable std::atomic<std::uint64_t> statement_cache_misses{0};
 	};
 
 } // namespace kanji::database
@@ -0,0 +1,62 @@
+#include "sqlite_statement.h"
+#include "sqlite_connection.h"
+#include <utility>
+
+namespace kanji::database
+{
+	SQLiteStatement::SQLiteStatement(const SQLiteConnection& in_owner, std::string in_sql, sqlite3_stmt* in_stmt)
+	    : owner{&in_owner}
+	    , sql{std::move(in_sql)}
+	    , stmt{in_stmt}
+	{
+	}
+
+	SQLiteStatement::SQLiteStatement(SQLiteStatement&& other) noexcept
+	    : owner{std::exchange(other.owner, nullptr)}
+	    , sql{std::move(other.sql)}
+	    , stmt{std::exchange(other.stmt, nullptr)}
+	{
+	}
+
+	SQLiteStatement& SQLiteStatement::operator=(SQLiteStatement&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Release();
+			owner = std::exchange(other.owner, nullptr);
+			sql = std::move(other.sql);
+			stmt = std::exchange(other.stmt, nullptr);
+		}
+		return *this;
+	}
+
+	SQLiteStatement::~SQLiteStatement()
+	{
+		Release();
+	}
+
+	sqlite3_stmt* SQLiteStatement::Get() const
+	{
+		return stmt;
+	}
+
+	SQLiteStatement::operator sqlite3_stmt*() const
+	{
+		return Get();
+	}
+
+	SQLiteStatement::operator bool() const
+	{
+		return stmt != nullptr;
+	}
+
+	void SQLiteStatement::Release()
+	{
+		if (owner && stmt)
+		{
+			owner->ReleaseStatement(std::move(sql), stmt);
+		}
+		owner = nullptr;
+		stmt = nullptr;
+	}
+} // namespace kanji::database
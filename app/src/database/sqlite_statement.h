@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+struct sqlite3_stmt;
+
+namespace kanji::database
+{
+	class SQLiteConnection;
+
+	// RAII handle for a prepared statement borrowed from SQLiteConnection's cache.
+	// The statement is reset and its bindings cleared when the handle goes out of scope.
+	class SQLiteStatement
+	{
+	public:
+		SQLiteStatement() = default;
+		SQLiteStatement(const SQLiteConnection& in_owner, std::string in_sql, sqlite3_stmt* in_stmt);
+		SQLiteStatement(const SQLiteStatement&) = delete;
+		SQLiteStatement& operator=(const SQLiteStatement&) = delete;
+		SQLiteStatement(SQLiteStatement&& other) noexcept;
+		SQLiteStatement& operator=(SQLiteStatement&& other) noexcept;
+		~SQLiteStatement();
+
+		sqlite3_stmt* Get() const;
+		operator sqlite3_stmt*() const;
+		explicit operator bool() const;
+
+	private:
+		void Release();
+
+		const SQLiteConnection* owner{nullptr};
+		std::string sql;
+		sqlite3_stmt* stmt{nullptr};
+	};
+} // namespace kanji::database
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "catalog/kanji_catalog.h"
+#include "kanji.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kanji::scheduler
+{
+	class IScheduler;
+}
+
+namespace kanji::database
+{
+	// Position in the kanji list, which is ordered by (next_review_date, id)
+	struct KanjiCursor
+	{
+		std::int64_t next_review_date{};
+		std::uint32_t id{};
+
+		// Opaque "<next_review_date>:<id>" token handed to clients
+		std::string ToString() const;
+		static std::optional<KanjiCursor> Parse(std::string_view token);
+	};
+
+	struct KanjiPage
+	{
+		std::vector<KanjiRecord> kanjis;
+		// Set when more rows may follow
+		std::optional<KanjiCursor> next;
+	};
+
+	class IKanjiRepository
+	{
+	public:
+		static constexpr int DEFAULT_REVIEW_BATCH_SIZE = 5;
+		static constexpr int MAX_PAGE_SIZE = 1000;
+
+		// Snapshot of every kanji with its examples
+		virtual std::shared_ptr<const catalog::KanjiCatalog> LoadCatalog() const = 0;
+		// Changes whenever kanjis or example words are added or removed
+		virtual std::uint64_t GetCatalogFingerprint() const = 0;
+		// Returns the ids of the inserted kanjis, or nothing if the batch was rolled back
+		virtual std::vector<std::uint32_t> BatchInsertKanjis(const std::vector<KanjiData>& kanjis) = 0;
+		virtual ~IKanjiRepository() = default;
+	};
+
+	class IReviewStateRepository
+	{
+	public:
+		virtual std::vector<KanjiReviewState> GetAllReviewStates() = 0;
+		// Starts reviews for the next `count` kanjis without a review state; returns the created states
+		virtual std::vector<KanjiReviewState> InitializeNewReviewStates(int count) = 0;
+		// Computes and stores the next state for every answer in one transaction; returns the new states
+		virtual std::vector<KanjiReviewState> ApplyAnswers(const std::vector<KanjiAnswer>& answers,
+		                                                   const scheduler::IScheduler& scheduler) = 0;
+		virtual bool SaveReviewStates(const std::vector<KanjiReviewState>& states) = 0;
+		virtual ~IReviewStateRepository() = default;
+	};
+
+	// Storage engine behind a Controller: SQLite (DatabaseContext) or in memory (MemoryStorage).
+	// Only what the controller and catalog store call; server wiring stays on DatabaseContext.
+	class IStorage
+	{
+	public:
+		virtual IKanjiRepository& GetKanjiRepository() = 0;
+		virtual IReviewStateRepository& GetReviewStateRepository() = 0;
+		virtual ~IStorage() = default;
+	};
+} // namespace kanji::database
@@ -0,0 +1,50 @@
+#include "transaction.h"
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+
+namespace kanji::database
+{
+	Transaction::Transaction(sqlite3* in_db)
+	    : db{in_db}
+	{
+		char* err_msg = nullptr;
+		if (sqlite3_exec(db, "BEGIN IMMEDIATE TRANSACTION;", nullptr, nullptr, &err_msg) != SQLITE_OK)
+		{
+			spdlog::error("Failed to begin transaction: {0}", err_msg ? err_msg : sqlite3_errmsg(db));
+			sqlite3_free(err_msg);
+			return;
+		}
+		active = true;
+	}
+
+	Transaction::~Transaction()
+	{
+		if (active)
+		{
+			sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+		}
+	}
+
+	bool Transaction::Commit()
+	{
+		if (!active)
+		{
+			return false;
+		}
+
+		char* err_msg = nullptr;
+		if (sqlite3_exec(db, "COMMIT;", nullptr, nullptr, &err_msg) != SQLITE_OK)
+		{
+			spdlog::error("Failed to commit transaction: {0}", err_msg ? err_msg : sqlite3_errmsg(db));
+			sqlite3_free(err_msg);
+			return false;
+		}
+		active = false;
+		return true;
+	}
+
+	Transaction::operator bool() const
+	{
+		return active;
+	}
+} // namespace kanji::database
@@ -0,0 +1,23 @@
+#pragma once
+
+struct sqlite3;
+
+namespace kanji::database
+{
+	// Scoped write transaction; rolls back unless Commit() succeeded.
+	class Transaction
+	{
+	public:
+		explicit Transaction(sqlite3* in_db);
+		Transaction(const Transaction&) = delete;
+		Transaction& operator=(const Transaction&) = delete;
+		~Transaction();
+
+		bool Commit();
+		explicit operator bool() const;
+
+	private:
+		sqlite3* db;
+		bool active{false};
+	};
+} // namespace kanji::database
@@ -0,0 +1,94 @@
+#include "admission_control.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace kanji::http
+{
+	bool IsWriteRoute(std::string_view method, std::string_view url)
+	{
+		static constexpr std::array<std::string_view, 3> write_routes{"/api/answers", "/api/learn-more", "/api/kanjis"};
+		return method == "POST" && std::ranges::find(write_routes, url) != write_routes.end();
+	}
+
+	AdmissionController::AdmissionController(const config::AdmissionSettings& in_settings)
+	    : rate{std::max(in_settings.writes_per_second, 0.001)}
+	    , burst{static_cast<double>(std::max(in_settings.write_burst, 1))}
+	    , max_in_flight{static_cast<std::size_t>(std::max(in_settings.max_inflight_writes, 1))}
+	{
+	}
+
+	AdmissionResult AdmissionController::TryAdmit(const std::string& user_id, Clock::time_point now)
+	{
+		std::lock_guard lock{mutex};
+		auto [it, inserted] = buckets.try_emplace(user_id);
+		Bucket& bucket = it->second;
+		if (inserted)
+		{
+			bucket = {burst, now};
+		}
+		Refill(bucket, now);
+
+		if (bucket.tokens < 1.0)
+		{
+			++stats.rate_limited;
+			const double wait = (1.0 - bucket.tokens) / rate;
+			return {Admission::RateLimited, std::chrono::seconds{static_cast<std::int64_t>(std::ceil(wait))}};
+		}
+		if (in_flight >= max_in_flight)
+		{
+			// Writes finish in milliseconds, so the earliest a retry can be told to come back is a second
+			++stats.overloaded;
+			return {Admission::Overloaded, std::chrono::seconds{1}};
+		}
+
+		bucket.tokens -= 1.0;
+		++in_flight;
+		++stats.admitted;
+		if (inserted && buckets.size() > MAX_TRACKED_USERS)
+		{
+			PruneFullBuckets(now);
+		}
+		return {};
+	}
+
+	void AdmissionController::Release()
+	{
+		std::lock_guard lock{mutex};
+		if (in_flight > 0)
+		{
+			--in_flight;
+		}
+	}
+
+	AdmissionStats AdmissionController::GetStats() const
+	{
+		std::lock_guard lock{mutex};
+		AdmissionStats result = stats;
+		result.in_flight = in_flight;
+		result.tracked_users = buckets.size();
+		return result;
+	}
+
+	double AdmissionController::TokensAt(const Bucket& bucket, Clock::time_point now) const
+	{
+		if (now <= bucket.refilled_at)
+		{
+			return bucket.tokens;
+		}
+		const double elapsed = std::chrono::duration<double>(now - bucket.refilled_at).count();
+		return std::min(burst, bucket.tokens + elapsed * rate);
+	}
+
+	void AdmissionController::Refill(Bucket& bucket, Clock::time_point now) const
+	{
+		bucket.tokens = TokensAt(bucket, now);
+		bucket.refilled_at = std::max(bucket.refilled_at, now);
+	}
+
+	void AdmissionController::PruneFullBuckets(Clock::time_point now)
+	{
+		// A full bucket is indistinguishable from a user seen for the first time
+		std::erase_if(buckets, [&](const auto& entry) { return TokensAt(entry.second, now) >= burst; });
+	}
+} // namespace kanji::http
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "config.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kanji::http
+{
+	enum class Admission
+	{
+		Admitted,
+		// The user's token bucket is empty
+		RateLimited,
+		// Every in-flight write slot is taken
+		Overloaded
+	};
+
+	struct AdmissionResult
+	{
+		Admission verdict{Admission::Admitted};
+		// Whole seconds until a retry can succeed; zero when admitted
+		std::chrono::seconds retry_after{0};
+	};
+
+	struct AdmissionStats
+	{
+		std::uint64_t admitted{};
+		std::uint64_t rate_limited{};
+		std::uint64_t overloaded{};
+		std::size_t in_flight{};
+		std::size_t tracked_users{};
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(AdmissionStats, admitted, rate_limited, overloaded, in_flight, tracked_users)
+
+	// True for the routes that write to the database: answers, learn-more and kanji imports.
+	// Everything else, annotate included, is served without touching the writer.
+	bool IsWriteRoute(std::string_view method, std::string_view url);
+
+	// Decides whether a write may start: one token from the user's bucket and one of a fixed number
+	// of global in-flight slots. Refusals cost neither, so a shed request never eats into a later one.
+	class AdmissionController
+	{
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		// Buckets beyond this are dropped once they have refilled, so a stream of one-off users stays bounded
+		static constexpr std::size_t MAX_TRACKED_USERS = 4096;
+
+		explicit AdmissionController(const config::AdmissionSettings& in_settings);
+
+		// On Admitted the caller holds a slot and must Release it when the write finishes
+		AdmissionResult TryAdmit(const std::string& user_id, Clock::time_point now = Clock::now());
+		void Release();
+
+		AdmissionStats GetStats() const;
+
+	private:
+		struct Bucket
+		{
+			double tokens{0.0};
+			Clock::time_point refilled_at;
+		};
+
+		double TokensAt(const Bucket& bucket, Clock::time_point now) const;
+		// Tops the bucket up for the time since it was last touched
+		void Refill(Bucket& bucket, Clock::time_point now) const;
+		void PruneFullBuckets(Clock::time_point now);
+
+		double rate;
+		double burst;
+		std::size_t max_in_flight;
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, Bucket> buckets;
+		std::size_t in_flight{0};
+		AdmissionStats stats;
+	};
+} // namespace kanji::http
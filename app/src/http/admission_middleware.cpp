@@ -0,0 +1,39 @@
+#include "admission_middleware.h"
+#include <spdlog/spdlog.h>
+
+namespace kanji::http
+{
+	void AdmissionMiddleware::BeforeHandle(crow::request& req, crow::response& res, context& ctx,
+	                                       const std::string& user_id)
+	{
+		// Only the write routes queue on the SQLite writer; reads and annotate are served from memory
+		if (!admission || !IsWriteRoute(crow::method_name(req.method), req.url))
+		{
+			return;
+		}
+
+		const auto result = admission->TryAdmit(user_id);
+		if (result.verdict == Admission::Admitted)
+		{
+			ctx.admitted = true;
+			return;
+		}
+
+		const bool rate_limited = result.verdict == Admission::RateLimited;
+		spdlog::debug("Admission: {} {} for user {}", rate_limited ? "rate limited" : "overloaded, shedding", req.url,
+		              user_id);
+		res.code = 429;
+		res.set_header("Retry-After", std::to_string(result.retry_after.count()));
+		res.body = rate_limited ? "Too many writes, slow down" : "Server busy, retry shortly";
+		res.end();
+	}
+
+	void AdmissionMiddleware::after_handle(crow::request&, crow::response&, context& ctx)
+	{
+		if (ctx.admitted)
+		{
+			ctx.admitted = false;
+			admission->Release();
+		}
+	}
+} // namespace kanji::http
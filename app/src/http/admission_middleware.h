@@ -0,0 +1,36 @@
+#pragma once
+
+#include "admission_control.h"
+#include "auth/jwt_middleware.h"
+#include <crow.h>
+#include <memory>
+
+namespace kanji::http
+{
+	// Sheds write requests with 429 and Retry-After before any handler runs, so a client spamming
+	// /api/answers never gets as far as a controller lock or the SQLite writer. Must come after
+	// auth::JwtMiddleware, whose subject picks the token bucket.
+	struct AdmissionMiddleware
+	{
+		struct context
+		{
+			// Set while the request holds an in-flight write slot
+			bool admitted{false};
+		};
+
+		template <typename AllContext>
+		void before_handle(crow::request& req, crow::response& res, context& ctx, AllContext& all_ctx)
+		{
+			const auto& user_id = all_ctx.template get<auth::JwtMiddleware>().user_id;
+			BeforeHandle(req, res, ctx, user_id);
+		}
+
+		void after_handle(crow::request& req, crow::response& res, context& ctx);
+
+		// Null leaves every request through
+		std::shared_ptr<AdmissionController> admission;
+
+	private:
+		void BeforeHandle(crow::request& req, crow::response& res, context& ctx, const std::string& user_id);
+	};
+} // namespace kanji::http
@@ -0,0 +1,62 @@
+#include "request_parsers.h"
+#include "kanji_json.h"
+#include "utils/json_reader.h"
+
+namespace kanji::http
+{
+	std::optional<std::vector<KanjiAnswer>> ParseAnswers(std::string_view body, std::string& error)
+	{
+		utils::json::Reader reader{body};
+		std::vector<KanjiAnswer> answers;
+		bool found = false;
+		std::string key;
+		std::string answer_error;
+
+		if (reader.Peek() != utils::json::ValueType::Object)
+		{
+			error = "expected {\"answers\": [...]}";
+			return std::nullopt;
+		}
+		reader.BeginObject();
+		while (reader.NextKey(key))
+		{
+			if (key != "answers")
+			{
+				reader.SkipValue();
+				continue;
+			}
+			if (reader.Peek() != utils::json::ValueType::Array)
+			{
+				error = "\"answers\" must be an array";
+				return std::nullopt;
+			}
+
+			found = true;
+			answers.clear();
+			reader.BeginArray();
+			for (std::size_t index = 0; reader.NextElement(); ++index)
+			{
+				KanjiAnswer answer{};
+				if (!ReadJson(reader, answer, answer_error))
+				{
+					error = reader.HasError() ? reader.GetError()
+					                          : "answers[" + std::to_string(index) + "]: " + answer_error;
+					return std::nullopt;
+				}
+				answers.push_back(answer);
+			}
+		}
+
+		if (!reader.AtEnd())
+		{
+			error = reader.HasError() ? reader.GetError() : "unexpected data after the body";
+			return std::nullopt;
+		}
+		if (!found)
+		{
+			error = "missing \"answers\"";
+			return std::nullopt;
+		}
+		return answers;
+	}
+} // namespace kanji::http
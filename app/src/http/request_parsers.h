@@ -0,0 +1,14 @@
+#pragma once
+
+#include "kanji.h"
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kanji::http
+{
+	// Body of POST /api/answers: {"answers": [{"kanji_id": n, "incorrect_streak": n}, ...]}, decoded
+	// in one pass. Empty with `error` set when the body is malformed or any answer has the wrong shape.
+	std::optional<std::vector<KanjiAnswer>> ParseAnswers(std::string_view body, std::string& error);
+} // namespace kanji::http
@@ -0,0 +1,76 @@
+#include "response_cache.h"
+#include <algorithm>
+
+namespace kanji::http
+{
+	ResponseCache::ResponseCache(std::size_t in_capacity)
+	    : capacity{std::max<std::size_t>(in_capacity, 1)}
+	{
+	}
+
+	std::shared_ptr<const std::string> ResponseCache::Find(const std::string& key, std::string_view etag) const
+	{
+		std::lock_guard lock{mutex};
+		auto it = entries.find(key);
+		if (it == entries.end() || it->second.etag != etag)
+		{
+			return nullptr;
+		}
+		return it->second.body;
+	}
+
+	std::shared_ptr<const std::string> ResponseCache::Store(const std::string& key, std::string etag, std::string body)
+	{
+		auto shared_body = std::make_shared<const std::string>(std::move(body));
+
+		std::lock_guard lock{mutex};
+		if (!entries.contains(key) && entries.size() >= capacity)
+		{
+			const auto oldest = std::min_element(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+				return a.second.stored_at < b.second.stored_at;
+			});
+			entries.erase(oldest);
+		}
+		entries[key] = Entry{std::move(etag), shared_body, next_stamp++};
+		return shared_body;
+	}
+
+	std::string MakeETag(std::string_view value)
+	{
+		std::string etag;
+		etag.reserve(value.size() + 2);
+		etag += '"';
+		etag += value;
+		etag += '"';
+		return etag;
+	}
+
+	bool MatchesIfNoneMatch(std::string_view if_none_match, std::string_view etag)
+	{
+		constexpr std::string_view WHITESPACE = " \t";
+		while (!if_none_match.empty())
+		{
+			const std::size_t comma = if_none_match.find(',');
+			std::string_view candidate = if_none_match.substr(0, comma);
+			if_none_match = comma == std::string_view::npos ? std::string_view{} : if_none_match.substr(comma + 1);
+
+			const std::size_t first = candidate.find_first_not_of(WHITESPACE);
+			if (first == std::string_view::npos)
+			{
+				continue;
+			}
+			candidate = candidate.substr(first, candidate.find_last_not_of(WHITESPACE) - first + 1);
+
+			// If-None-Match uses weak comparison, so W/"x" matches "x"
+			if (candidate.starts_with("W/"))
+			{
+				candidate.remove_prefix(2);
+			}
+			if (candidate == "*" || candidate == etag)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+} // namespace kanji::http
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace kanji::http
+{
+	// Last serialized body of each read route (and query), tagged with the ETag it was built for.
+	// Lets a changed-but-repeated poll skip serialization and an unchanged one skip everything.
+	class ResponseCache
+	{
+	public:
+		static constexpr std::size_t DEFAULT_CAPACITY = 32;
+
+		explicit ResponseCache(std::size_t in_capacity = DEFAULT_CAPACITY);
+
+		// Null unless the body stored under `key` was built for `etag`
+		std::shared_ptr<const std::string> Find(const std::string& key, std::string_view etag) const;
+		// Replaces the entry for `key`; the least recently stored entry goes once the cache is full
+		std::shared_ptr<const std::string> Store(const std::string& key, std::string etag, std::string body);
+
+	private:
+		struct Entry
+		{
+			std::string etag;
+			std::shared_ptr<const std::string> body;
+			std::uint64_t stored_at{};
+		};
+
+		mutable std::mutex mutex;
+		std::unordered_map<std::string, Entry> entries;
+		std::size_t capacity;
+		std::uint64_t next_stamp{0};
+	};
+
+	// Quoted strong ETag
+	std::string MakeETag(std::string_view value);
+	// True when an If-None-Match header lists `etag` (weak or strong) or is "*"
+	bool MatchesIfNoneMatch(std::string_view if_none_match, std::string_view etag);
+} // namespace kanji::http
@@ -0,0 +1,204 @@
+#include "wire_format.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <nlohmann/json.hpp>
+
+namespace kanji::http
+{
+	namespace
+	{
+		constexpr std::string_view WHITESPACE = " \t";
+
+		std::string_view Trim(std::string_view value)
+		{
+			const std::size_t first = value.find_first_not_of(WHITESPACE);
+			if (first == std::string_view::npos)
+			{
+				return {};
+			}
+			return value.substr(first, value.find_last_not_of(WHITESPACE) - first + 1);
+		}
+
+		bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+		{
+			return std::ranges::equal(a, b, [](char x, char y) {
+				return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+			});
+		}
+
+		// Format named by a bare media type ("application/cbor"), if any
+		std::optional<WireFormat> FormatOf(std::string_view media_type)
+		{
+			if (EqualsIgnoreCase(media_type, "application/json"))
+			{
+				return WireFormat::Json;
+			}
+			// MessagePack has no registered type; clients use all three spellings
+			if (EqualsIgnoreCase(media_type, "application/msgpack") || EqualsIgnoreCase(media_type, "application/x-msgpack") ||
+			    EqualsIgnoreCase(media_type, "application/vnd.msgpack"))
+			{
+				return WireFormat::MessagePack;
+			}
+			if (EqualsIgnoreCase(media_type, "application/cbor"))
+			{
+				return WireFormat::Cbor;
+			}
+			return std::nullopt;
+		}
+
+		// Weight of one Accept entry's parameters ("; q=0.5"), 1 when absent or malformed
+		double ParseQuality(std::string_view parameters)
+		{
+			while (!parameters.empty())
+			{
+				const std::size_t semicolon = parameters.find(';');
+				const std::string_view parameter = Trim(parameters.substr(0, semicolon));
+				parameters = semicolon == std::string_view::npos ? std::string_view{} : parameters.substr(semicolon + 1);
+
+				if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=')
+				{
+					double quality = 1.0;
+					const auto value = parameter.substr(2);
+					if (std::from_chars(value.data(), value.data() + value.size(), quality).ec != std::errc{})
+					{
+						return 1.0;
+					}
+					return std::clamp(quality, 0.0, 1.0);
+				}
+			}
+			return 1.0;
+		}
+	} // namespace
+
+	WireFormat RequestFormat(std::string_view content_type)
+	{
+		const auto format = FormatOf(Trim(content_type.substr(0, content_type.find(';'))));
+		return format.value_or(WireFormat::Json);
+	}
+
+	WireFormat NegotiateFormat(std::string_view accept)
+	{
+		WireFormat best = WireFormat::Json;
+		double best_quality = 0.0;
+		bool best_is_wildcard = true;
+		while (!accept.empty())
+		{
+			const std::size_t comma = accept.find(',');
+			const std::string_view entry = accept.substr(0, comma);
+			accept = comma == std::string_view::npos ? std::string_view{} : accept.substr(comma + 1);
+
+			const std::size_t semicolon = entry.find(';');
+			const std::string_view media_type = Trim(entry.substr(0, semicolon));
+			// Wildcards are served as JSON, the format every client can read
+			auto format = FormatOf(media_type);
+			const bool wildcard = !format;
+			if (wildcard && (media_type == "*/*" || EqualsIgnoreCase(media_type, "application/*")))
+			{
+				format = WireFormat::Json;
+			}
+			if (!format)
+			{
+				continue;
+			}
+
+			// Higher q wins; at equal q a named type beats a wildcard and the earlier entry beats a later one
+			const double quality = semicolon == std::string_view::npos ? 1.0 : ParseQuality(entry.substr(semicolon + 1));
+			if (quality > best_quality || (quality == best_quality && quality > 0.0 && best_is_wildcard && !wildcard))
+			{
+				best = *format;
+				best_quality = quality;
+				best_is_wildcard = wildcard;
+			}
+		}
+		return best;
+	}
+
+	std::string_view GetMediaType(WireFormat format)
+	{
+		switch (format)
+		{
+		case WireFormat::MessagePack:
+			return "application/msgpack";
+		case WireFormat::Cbor:
+			return "application/cbor";
+		default:
+			return "application/json";
+		}
+	}
+
+	std::string_view GetSuffix(WireFormat format)
+	{
+		switch (format)
+		{
+		case WireFormat::MessagePack:
+			return "msgpack";
+		case WireFormat::Cbor:
+			return "cbor";
+		default:
+			return "";
+		}
+	}
+
+	nlohmann::json::input_format_t GetInputFormat(WireFormat format)
+	{
+		switch (format)
+		{
+		case WireFormat::MessagePack:
+			return nlohmann::json::input_format_t::msgpack;
+		case WireFormat::Cbor:
+			return nlohmann::json::input_format_t::cbor;
+		default:
+			return nlohmann::json::input_format_t::json;
+		}
+	}
+
+	std::string FromJson(std::string json, WireFormat format)
+	{
+		if (format == WireFormat::Json)
+		{
+			return json;
+		}
+
+		const auto document = nlohmann::json::parse(json, nullptr, false);
+		std::string encoded;
+		if (format == WireFormat::MessagePack)
+		{
+			nlohmann::json::to_msgpack(document, encoded);
+		}
+		else
+		{
+			nlohmann::json::to_cbor(document, encoded);
+		}
+		return encoded;
+	}
+
+	std::optional<std::string_view> ToJson(std::string_view body, WireFormat format, std::string& storage,
+	                                       std::string& error)
+	{
+		if (format == WireFormat::Json)
+		{
+			return body;
+		}
+
+		// An empty body means "no body" in every format
+		if (body.empty())
+		{
+			storage.clear();
+			return std::string_view{storage};
+		}
+
+		const auto* bytes = reinterpret_cast<const std::uint8_t*>(body.data());
+		const auto document = format == WireFormat::MessagePack
+		                          ? nlohmann::json::from_msgpack(bytes, bytes + body.size(), true, false)
+		                          : nlohmann::json::from_cbor(bytes, bytes + body.size(), true, false);
+		if (document.is_discarded())
+		{
+			error = format == WireFormat::MessagePack ? "malformed MessagePack body" : "malformed CBOR body";
+			return std::nullopt;
+		}
+		// Binary strings carry no encoding guarantee; mend them the way the JSON writer does
+		storage = document.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+		return std::string_view{storage};
+	}
+} // namespace kanji::http
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kanji::http
+{
+	// Body encodings a route can speak. Routes build and parse JSON; MessagePack and CBOR are
+	// transcoded at the edge, so every route supports them without knowing about them. Kanji
+	// imports are the exception: they are too large to transcode and decode binary bodies directly.
+	enum class WireFormat
+	{
+		Json,
+		MessagePack,
+		Cbor
+	};
+
+	// Format of a request body by its Content-Type. Anything that is not a binary type stays JSON,
+	// which is what clients sending text/plain or no header at all have always meant.
+	WireFormat RequestFormat(std::string_view content_type);
+	// Best format for a response by the Accept header's q-values; named types beat wildcards at equal q,
+	// and JSON is the answer when nothing else is acceptable
+	WireFormat NegotiateFormat(std::string_view accept);
+
+	std::string_view GetMediaType(WireFormat format);
+	// Short tag that keeps cache keys and ETags of different representations apart; empty for JSON
+	std::string_view GetSuffix(WireFormat format);
+	// Format tag for nlohmann's parsers
+	nlohmann::json::input_format_t GetInputFormat(WireFormat format);
+
+	// Re-encodes a JSON document; returns it unchanged for JSON
+	std::string FromJson(std::string json, WireFormat format);
+	// JSON text of a request body: the body itself for JSON, else a transcoded copy kept in `storage`.
+	// Empty with `error` set when the body is not valid in its format. Meant for small bodies only.
+	std::optional<std::string_view> ToJson(std::string_view body, WireFormat format, std::string& storage,
+	                                       std::string& error);
+} // namespace kanji::http
@@ -0,0 +1,214 @@
+#include "bulk_loader.h"
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "database/migrations.h"
+#include "dictionary_parser.h"
+#include <algorithm>
+#include <deque>
+#include <format>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <sqlite3.h>
+#include <thread>
+
+namespace
+{
+	using namespace kanji::importer;
+
+	// Rejected records logged per chunk before the rest are only counted
+	constexpr std::size_t MAX_LOGGED_ERRORS = 10;
+
+	struct ParsedChunk
+	{
+		std::vector<kanji::KanjiData> kanjis;
+		std::size_t records{};
+		std::size_t rejected{};
+		std::vector<std::string> errors;
+	};
+
+	ParsedChunk ParseChunk(DumpFormat format, const std::vector<std::string>& records)
+	{
+		ParsedChunk parsed;
+		parsed.records = records.size();
+		parsed.kanjis.reserve(records.size());
+
+		std::string error;
+		for (const auto& record : records)
+		{
+			auto kanji = format == DumpFormat::Kanjidic ? ParseKanjidicCharacter(record, error) : ParseJsonLine(record, error);
+			if (kanji)
+			{
+				parsed.kanjis.push_back(std::move(*kanji));
+				continue;
+			}
+
+			++parsed.rejected;
+			if (parsed.errors.size() < MAX_LOGGED_ERRORS)
+			{
+				parsed.errors.push_back(std::move(error));
+			}
+		}
+		return parsed;
+	}
+
+	bool Execute(sqlite3* db, const std::string& sql)
+	{
+		char* err_msg = nullptr;
+		if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &err_msg) != SQLITE_OK)
+		{
+			spdlog::error("Failed to apply '{0}': {1}", sql, err_msg ? err_msg : "unknown error");
+			sqlite3_free(err_msg);
+			return false;
+		}
+		return true;
+	}
+
+	std::int64_t QueryPragma(sqlite3* db, const char* pragma)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		std::int64_t value = 0;
+		if (sqlite3_prepare_v2(db, std::format("PRAGMA {};", pragma).c_str(), -1, &stmt, nullptr) == SQLITE_OK &&
+		    sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			value = sqlite3_column_int64(stmt, 0);
+		}
+		sqlite3_finalize(stmt);
+		return value;
+	}
+
+	bool HasReviewStates(sqlite3* db)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		bool found = false;
+		if (sqlite3_prepare_v2(db, "SELECT 1 FROM kanji_review_state LIMIT 1;", -1, &stmt, nullptr) == SQLITE_OK)
+		{
+			found = sqlite3_step(stmt) == SQLITE_ROW;
+		}
+		sqlite3_finalize(stmt);
+		return found;
+	}
+} // namespace
+
+namespace kanji::importer
+{
+	BulkLoader::BulkLoader(database::ConnectionPool& in_pool, BulkLoadOptions in_options)
+	    : pool{in_pool}
+	    , options{in_options}
+	{
+		options.chunk_size = std::max<std::size_t>(options.chunk_size, 1);
+	}
+
+	BulkLoadReport BulkLoader::Load(std::istream& input)
+	{
+		BulkLoadReport report;
+
+		// Held for the whole load so nothing else interleaves with the chunk transactions
+		auto writer = pool.AcquireWriter();
+		const auto previous_synchronous = QueryPragma(writer, "synchronous");
+		const auto previous_cache_size = QueryPragma(writer, "cache_size");
+
+		Execute(writer, std::format("PRAGMA cache_size = -{};", static_cast<std::int64_t>(options.cache_size_mib) * 1024));
+		Execute(writer, "PRAGMA temp_store = MEMORY;");
+		// Loading into an empty database is simply rerun after a crash, so per-commit syncs buy nothing there.
+		// Existing review progress cannot be rerun, so it keeps the syncs that protect it from corruption.
+		Execute(writer, HasReviewStates(writer) ? "PRAGMA synchronous = NORMAL;" : "PRAGMA synchronous = OFF;");
+		// Dropped indexes are recreated by the next ConnectionPool::Initialize should the load not finish
+		for (const auto& index : database::GetSecondaryIndexes())
+		{
+			Execute(writer, std::format("DROP INDEX IF EXISTS {};", index.name));
+		}
+
+		database::KanjiRepository kanji_repo{pool};
+		const unsigned int threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+
+		// Parsed chunks are written strictly in input order, so ids follow the dump
+		std::deque<std::future<ParsedChunk>> in_flight;
+		const auto write_next = [&] {
+			ParsedChunk parsed = in_flight.front().get();
+			in_flight.pop_front();
+
+			for (const auto& error : parsed.errors)
+			{
+				spdlog::warn("Rejected record in chunk {0}: {1}", report.chunks, error);
+			}
+
+			report.records += parsed.records;
+			report.rejected += parsed.rejected;
+			report.inserted += kanji_repo.BatchInsertKanjis(parsed.kanjis).size();
+			++report.chunks;
+			spdlog::info("Loaded chunk {0}: {1} kanjis inserted, {2} records read", report.chunks, report.inserted,
+			             report.records);
+		};
+
+		std::vector<std::string> records;
+		while (ReadChunk(input, records))
+		{
+			in_flight.push_back(std::async(std::launch::async, [format = options.format, chunk = std::move(records)] {
+				return ParseChunk(format, chunk);
+			}));
+			records = {};
+
+			if (in_flight.size() >= threads)
+			{
+				write_next();
+			}
+		}
+		while (!in_flight.empty())
+		{
+			write_next();
+		}
+
+		spdlog::info("Rebuilding indexes");
+		for (const auto& index : database::GetSecondaryIndexes())
+		{
+			Execute(writer, index.sql);
+		}
+		Execute(writer, "PRAGMA optimize;");
+		Execute(writer, std::format("PRAGMA cache_size = {};", previous_cache_size));
+		Execute(writer, std::format("PRAGMA synchronous = {};", previous_synchronous));
+		return report;
+	}
+
+	bool BulkLoader::ReadChunk(std::istream& input, std::vector<std::string>& records) const
+	{
+		std::string piece;
+		if (options.format == DumpFormat::JsonLines)
+		{
+			while (records.size() < options.chunk_size && std::getline(input, piece))
+			{
+				if (!piece.empty() && piece.back() == '\r')
+				{
+					piece.pop_back();
+				}
+				if (piece.find_first_not_of(" \t") != std::string::npos)
+				{
+					records.push_back(std::move(piece));
+				}
+			}
+			return !records.empty();
+		}
+
+		// Tag by tag, so the layout of the XML does not matter
+		std::string element;
+		while (records.size() < options.chunk_size && std::getline(input, piece, '>'))
+		{
+			piece += '>';
+			if (element.empty())
+			{
+				if (piece.ends_with("<character>"))
+				{
+					element = "<character>";
+				}
+				continue;
+			}
+
+			element += piece;
+			if (piece.ends_with("</character>"))
+			{
+				records.push_back(std::move(element));
+				element.clear();
+			}
+		}
+		return !records.empty();
+	}
+} // namespace kanji::importer
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "kanji.h"
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace kanji::database
+{
+	class ConnectionPool;
+}
+
+namespace kanji::importer
+{
+	enum class DumpFormat
+	{
+		JsonLines,
+		Kanjidic
+	};
+
+	struct BulkLoadOptions
+	{
+		DumpFormat format{DumpFormat::JsonLines};
+		// Records per parse task and per transaction
+		std::size_t chunk_size{5000};
+		// Parser threads; 0 uses every core
+		unsigned int threads{0};
+		int cache_size_mib{256};
+	};
+
+	struct BulkLoadReport
+	{
+		std::size_t records{};
+		std::size_t inserted{};
+		std::size_t rejected{};
+		std::size_t chunks{};
+	};
+
+	// Offline loader for dictionary dumps. Records are parsed in parallel and written in input
+	// order by a single writer through KanjiRepository::BatchInsertKanjis, one transaction per
+	// chunk, with secondary indexes dropped for the duration and rebuilt at the end.
+	class BulkLoader
+	{
+	public:
+		BulkLoader(database::ConnectionPool& in_pool, BulkLoadOptions in_options);
+
+		BulkLoadReport Load(std::istream& input);
+
+	private:
+		bool ReadChunk(std::istream& input, std::vector<std::string>& records) const;
+
+		database::ConnectionPool& pool;
+		BulkLoadOptions options;
+	};
+} // namespace kanji::importer
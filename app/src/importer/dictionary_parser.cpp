@@ -0,0 +1,164 @@
+#include "dictionary_parser.h"
+
+namespace
+{
+	std::string DecodeEntities(std::string_view text)
+	{
+		constexpr std::pair<std::string_view, char> entities[] = {
+		    {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+
+		std::string decoded;
+		decoded.reserve(text.size());
+		for (std::size_t i = 0; i < text.size(); ++i)
+		{
+			bool replaced = false;
+			if (text[i] == '&')
+			{
+				for (const auto& [entity, character] : entities)
+				{
+					if (text.substr(i).starts_with(entity))
+					{
+						decoded += character;
+						i += entity.size() - 1;
+						replaced = true;
+						break;
+					}
+				}
+			}
+			if (!replaced)
+			{
+				decoded += text[i];
+			}
+		}
+		return decoded;
+	}
+
+	// Walks the <tag ...>text</tag> elements of one tag name in document order
+	class ElementCursor
+	{
+	public:
+		ElementCursor(std::string_view in_xml, std::string_view in_tag)
+		    : xml{in_xml}
+		    , open{"<" + std::string{in_tag}}
+		    , close{"</" + std::string{in_tag} + ">"}
+		{
+		}
+
+		bool Next(std::string_view& attributes, std::string_view& text)
+		{
+			while (true)
+			{
+				const auto start = xml.find(open, position);
+				if (start == std::string_view::npos)
+				{
+					return false;
+				}
+
+				const auto name_end = start + open.size();
+				const auto tag_end = xml.find('>', name_end);
+				if (tag_end == std::string_view::npos)
+				{
+					return false;
+				}
+
+				// Skip tags that merely share the prefix, e.g. <reading_meaning> for <reading>
+				if (xml[name_end] != '>' && xml[name_end] != ' ')
+				{
+					position = tag_end;
+					continue;
+				}
+
+				const auto text_end = xml.find(close, tag_end);
+				if (text_end == std::string_view::npos)
+				{
+					return false;
+				}
+
+				attributes = xml.substr(name_end, tag_end - name_end);
+				text = xml.substr(tag_end + 1, text_end - tag_end - 1);
+				position = text_end + close.size();
+				return true;
+			}
+		}
+
+	private:
+		std::string_view xml;
+		std::string open;
+		std::string close;
+		std::size_t position{0};
+	};
+} // namespace
+
+namespace kanji::importer
+{
+	std::optional<KanjiData> ParseJsonLine(std::string_view line, std::string& error)
+	{
+		const auto j = nlohmann::json::parse(line, nullptr, false);
+		if (j.is_discarded() || !j.is_object())
+		{
+			error = "not a JSON object";
+			return std::nullopt;
+		}
+
+		try
+		{
+			KanjiData kanji{};
+			kanji.kanji = j.at("kanji").get<std::string>();
+			kanji.meaning = j.value("meaning", std::string{});
+			kanji.examples = j.value("examples", std::vector<KanjiWord>{});
+			if (kanji.kanji.empty())
+			{
+				error = "empty kanji";
+				return std::nullopt;
+			}
+			return kanji;
+		}
+		catch (const nlohmann::json::exception& e)
+		{
+			error = e.what();
+			return std::nullopt;
+		}
+	}
+
+	std::optional<KanjiData> ParseKanjidicCharacter(std::string_view element, std::string& error)
+	{
+		std::string_view attributes;
+		std::string_view text;
+
+		ElementCursor literal{element, "literal"};
+		if (!literal.Next(attributes, text) || text.empty())
+		{
+			error = "character without <literal>";
+			return std::nullopt;
+		}
+
+		KanjiData kanji{};
+		kanji.kanji = DecodeEntities(text);
+
+		// Meanings in other languages carry an m_lang attribute
+		ElementCursor meanings{element, "meaning"};
+		while (meanings.Next(attributes, text))
+		{
+			if (attributes.find("m_lang") != std::string_view::npos)
+			{
+				continue;
+			}
+			if (!kanji.meaning.empty())
+			{
+				kanji.meaning += ", ";
+			}
+			kanji.meaning += DecodeEntities(text);
+		}
+
+		ElementCursor readings{element, "reading"};
+		while (readings.Next(attributes, text))
+		{
+			if (attributes.find("\"ja_on\"") != std::string_view::npos ||
+			    attributes.find("\"ja_kun\"") != std::string_view::npos)
+			{
+				kanji.examples.push_back({kanji.kanji, DecodeEntities(text)});
+			}
+		}
+		return kanji;
+	}
+} // namespace kanji::importer
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "kanji.h"
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace kanji::importer
+{
+	// One kanji object per line: {"kanji": "日", "meaning": "day", "examples": [{"word": ..., "reading": ...}]}.
+	// Only "kanji" is required; "id" is ignored because ids are assigned on insert.
+	std::optional<KanjiData> ParseJsonLine(std::string_view line, std::string& error);
+
+	// One KANJIDIC2 <character> element. English meanings are joined into the meaning and the
+	// on/kun readings become examples of the literal itself, since KANJIDIC carries no words.
+	std::optional<KanjiData> ParseKanjidicCharacter(std::string_view element, std::string& error);
+} // namespace kanji::importer
@@ -0,0 +1,369 @@
+#include "kanji_importer.h"
+#include "kanji_json.h"
+#include "utils/json_reader.h"
+#include <optional>
+#include <spdlog/spdlog.h>
+#include <utility>
+
+namespace
+{
+	using json = nlohmann::json;
+
+	// Receives each row of the "kanjis" array, or why it could not be decoded
+	using RowCallback = std::function<void(std::optional<kanji::KanjiData>&&, const std::string&)>;
+
+	// How far a walk over the payload got
+	struct WalkResult
+	{
+		bool found_kanjis{false};
+		// Set when the payload itself is malformed
+		std::string error;
+	};
+
+	// Tracks where the parser is in the document and rebuilds only the current element of the
+	// top-level "kanjis" array; everything else in the payload is skipped as it streams past.
+	class KanjiArrayHandler : public nlohmann::json_sax<json>
+	{
+	public:
+		using ElementCallback = std::function<void(json&&)>;
+
+		explicit KanjiArrayHandler(ElementCallback in_on_element)
+		    : on_element{std::move(in_on_element)}
+		{
+		}
+
+		bool null() override
+		{
+			return Value(nullptr);
+		}
+
+		bool boolean(bool value) override
+		{
+			return Value(value);
+		}
+
+		bool number_integer(number_integer_t value) override
+		{
+			return Value(value);
+		}
+
+		bool number_unsigned(number_unsigned_t value) override
+		{
+			return Value(value);
+		}
+
+		bool number_float(number_float_t value, const string_t&) override
+		{
+			return Value(value);
+		}
+
+		bool string(string_t& value) override
+		{
+			return Value(std::move(value));
+		}
+
+		bool binary(binary_t& value) override
+		{
+			return Value(json::binary(std::move(value)));
+		}
+
+		bool start_object(std::size_t) override
+		{
+			return Open(json::object());
+		}
+
+		bool key(string_t& value) override
+		{
+			if (!stack.empty())
+			{
+				pending_key = std::move(value);
+			}
+			else if (depth == 1)
+			{
+				root_key = std::move(value);
+			}
+			return true;
+		}
+
+		bool end_object() override
+		{
+			return Close();
+		}
+
+		bool start_array(std::size_t) override
+		{
+			if (stack.empty() && depth == 1 && root_key == "kanjis")
+			{
+				in_kanjis = true;
+				found_kanjis = true;
+				++depth;
+				return true;
+			}
+			return Open(json::array());
+		}
+
+		bool end_array() override
+		{
+			if (stack.empty() && in_kanjis && depth == 2)
+			{
+				in_kanjis = false;
+				--depth;
+				return true;
+			}
+			return Close();
+		}
+
+		bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+		{
+			error = ex.what();
+			return false;
+		}
+
+		bool FoundKanjis() const
+		{
+			return found_kanjis;
+		}
+
+		const std::string& GetError() const
+		{
+			return error;
+		}
+
+	private:
+		bool IsElementStart() const
+		{
+			return in_kanjis && depth == 2 && stack.empty();
+		}
+
+		json* Insert(json&& value)
+		{
+			if (stack.empty())
+			{
+				element = std::move(value);
+				return &element;
+			}
+
+			json& parent = *stack.back();
+			if (parent.is_object())
+			{
+				json& slot = parent[pending_key];
+				slot = std::move(value);
+				return &slot;
+			}
+			parent.push_back(std::move(value));
+			return &parent.back();
+		}
+
+		bool Value(json&& value)
+		{
+			if (!stack.empty())
+			{
+				Insert(std::move(value));
+			}
+			else if (IsElementStart())
+			{
+				on_element(std::move(value));
+			}
+			return true;
+		}
+
+		bool Open(json&& container)
+		{
+			if (!stack.empty() || IsElementStart())
+			{
+				stack.push_back(Insert(std::move(container)));
+			}
+			++depth;
+			return true;
+		}
+
+		bool Close()
+		{
+			--depth;
+			if (!stack.empty())
+			{
+				stack.pop_back();
+				if (stack.empty())
+				{
+					on_element(std::move(element));
+				}
+			}
+			return true;
+		}
+
+		ElementCallback on_element;
+		std::size_t depth{0};
+		std::string root_key;
+		bool in_kanjis{false};
+		bool found_kanjis{false};
+
+		// Element being rebuilt and the open containers inside it
+		json element;
+		std::vector<json*> stack;
+		std::string pending_key;
+
+		std::string error;
+	};
+} // namespace
+
+namespace kanji::importer
+{
+	KanjiImporter::KanjiImporter(ChunkSink in_sink, std::size_t in_chunk_size)
+	    : sink{std::move(in_sink)}
+	    , chunk_size{in_chunk_size > 0 ? in_chunk_size : DEFAULT_CHUNK_SIZE}
+	{
+	}
+
+	template <typename Parse>
+	ImportReport KanjiImporter::Run(Parse&& parse)
+	{
+		ImportReport report;
+		ImportChunkReport chunk_report;
+		std::vector<KanjiData> chunk;
+		chunk.reserve(chunk_size);
+
+		const auto commit_chunk = [&] {
+			if (chunk_report.received == 0)
+			{
+				return;
+			}
+
+			if (!chunk.empty())
+			{
+				chunk_report.inserted = sink(chunk).size();
+				if (chunk_report.inserted < chunk.size())
+				{
+					chunk_report.errors.push_back(
+					    std::to_string(chunk.size() - chunk_report.inserted) + " kanjis could not be inserted");
+				}
+			}
+
+			spdlog::info("Imported chunk {0}: {1} of {2} kanjis inserted", chunk_report.chunk, chunk_report.inserted,
+			             chunk_report.received);
+			report.received += chunk_report.received;
+			report.inserted += chunk_report.inserted;
+
+			const std::size_t next_chunk = chunk_report.chunk + 1;
+			report.chunks.push_back(std::move(chunk_report));
+			chunk_report = {};
+			chunk_report.chunk = next_chunk;
+			chunk.clear();
+		};
+
+		const RowCallback on_row = [&](std::optional<KanjiData>&& row, const std::string& row_error) {
+			const std::size_t index = report.received + chunk_report.received;
+			++chunk_report.received;
+			if (row)
+			{
+				chunk.push_back(std::move(*row));
+			}
+			else
+			{
+				chunk_report.errors.push_back("kanjis[" + std::to_string(index) + "]: " + row_error);
+			}
+
+			if (chunk_report.received >= chunk_size)
+			{
+				commit_chunk();
+			}
+		};
+
+		const WalkResult result = parse(on_row);
+		// Rows parsed before a syntax error are still valid, so the partial chunk is kept
+		commit_chunk();
+
+		if (!result.error.empty())
+		{
+			report.error = result.error;
+			spdlog::error("Kanji import stopped after {0} kanjis: {1}", report.received, report.error);
+		}
+		else if (!result.found_kanjis)
+		{
+			report.error = "payload has no \"kanjis\" array";
+		}
+		return report;
+	}
+
+	ImportReport KanjiImporter::Import(std::string_view payload, json::input_format_t format)
+	{
+		if (format != json::input_format_t::json)
+		{
+			return ImportBinary(payload, format);
+		}
+
+		// The pull reader decodes rows straight into KanjiData
+		return Run([payload](const RowCallback& on_row) {
+			WalkResult result;
+			utils::json::Reader reader{payload};
+			std::string key;
+			std::string row_error;
+
+			if (reader.Peek() != utils::json::ValueType::Object)
+			{
+				reader.SkipValue();
+			}
+			else
+			{
+				reader.BeginObject();
+				while (reader.NextKey(key))
+				{
+					if (key != "kanjis" || reader.Peek() != utils::json::ValueType::Array)
+					{
+						reader.SkipValue();
+						continue;
+					}
+
+					result.found_kanjis = true;
+					reader.BeginArray();
+					while (reader.NextElement())
+					{
+						KanjiData row{};
+						if (ReadJson(reader, row, row_error))
+						{
+							on_row(std::move(row), {});
+						}
+						else if (!reader.HasError())
+						{
+							on_row(std::nullopt, row_error);
+						}
+					}
+				}
+			}
+
+			if (!reader.AtEnd())
+			{
+				result.error = reader.HasError() ? reader.GetError() : "unexpected data after the payload";
+			}
+			return result;
+		});
+	}
+
+	ImportReport KanjiImporter::ImportBinary(std::string_view payload, json::input_format_t format)
+	{
+		// Binary formats have no pull reader, so the SAX parser rebuilds one element at a time
+		return Run([payload, format](const RowCallback& on_row) {
+			KanjiArrayHandler handler{[&](json&& element) {
+				std::optional<KanjiData> row;
+				std::string row_error;
+				try
+				{
+					row = element.get<KanjiData>();
+				}
+				catch (const json::exception& e)
+				{
+					row_error = e.what();
+				}
+				on_row(std::move(row), row_error);
+			}};
+
+			WalkResult result;
+			const auto* bytes = reinterpret_cast<const std::uint8_t*>(payload.data());
+			if (!json::sax_parse(bytes, bytes + payload.size(), &handler, format))
+			{
+				result.error = handler.GetError().empty() ? "malformed JSON" : handler.GetError();
+			}
+			result.found_kanjis = handler.FoundKanjis();
+			return result;
+		});
+	}
+} // namespace kanji::importer
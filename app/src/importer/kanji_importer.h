@@ -0,0 +1,57 @@
+#pragma once
+
+#include "kanji.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace kanji::importer
+{
+	struct ImportChunkReport
+	{
+		std::size_t chunk{};
+		std::size_t received{};
+		std::size_t inserted{};
+		std::vector<std::string> errors;
+	};
+
+	struct ImportReport
+	{
+		std::size_t received{};
+		std::size_t inserted{};
+		std::vector<ImportChunkReport> chunks;
+		// Set when the payload itself is malformed; chunks before the error stay committed
+		std::string error;
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ImportChunkReport, chunk, received, inserted, errors)
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(ImportReport, received, inserted, chunks, error)
+
+	// Receives one chunk of parsed kanjis and returns the ids that were inserted
+	using ChunkSink = std::function<std::vector<std::uint32_t>(const std::vector<KanjiData>&)>;
+
+	// Decodes a {"kanjis": [...]} document row by row and hands the rows to the sink in bounded
+	// chunks, so neither a DOM of the whole payload nor the full row list is ever built. JSON goes
+	// through the one-pass pull reader, MessagePack and CBOR through nlohmann's SAX parser.
+	class KanjiImporter
+	{
+	public:
+		static constexpr std::size_t DEFAULT_CHUNK_SIZE = 500;
+
+		explicit KanjiImporter(ChunkSink in_sink, std::size_t in_chunk_size = DEFAULT_CHUNK_SIZE);
+
+		ImportReport Import(std::string_view payload,
+		                    nlohmann::json::input_format_t format = nlohmann::json::input_format_t::json);
+
+	private:
+		ImportReport ImportBinary(std::string_view payload, nlohmann::json::input_format_t format);
+		template <typename Parse>
+		ImportReport Run(Parse&& parse);
+
+		ChunkSink sink;
+		std::size_t chunk_size;
+	};
+} // namespace kanji::importer
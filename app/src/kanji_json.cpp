@@ -0,0 +1,223 @@
+#include "kanji_json.h"
+#include <initializer_list>
+#include <utility>
+
+namespace kanji
+{
+	namespace
+	{
+		using utils::json::Reader;
+		using utils::json::ValueType;
+
+		// Marks a field as seen, or records why it was skipped
+		class FieldSet
+		{
+		public:
+			FieldSet(Reader& in_reader, std::string& in_error)
+			    : reader{in_reader}
+			    , error{in_error}
+			{
+			}
+
+			// Reads `out` when the next value has the expected type, otherwise skips it
+			bool String(std::string_view name, std::string& out)
+			{
+				if (reader.Peek() != ValueType::String)
+				{
+					return Mismatch(name, "a string");
+				}
+				return reader.ReadString(out);
+			}
+
+			template <typename T>
+			bool Integer(std::string_view name, T& out)
+			{
+				if (reader.Peek() != ValueType::Number)
+				{
+					return Mismatch(name, "an integer");
+				}
+				if (!reader.ReadInteger(out) && !reader.HasError())
+				{
+					Note(std::string{"\""} + std::string{name} + "\" is not a valid integer");
+				}
+				return !reader.HasError();
+			}
+
+			template <typename T>
+			bool Array(std::string_view name, std::vector<T>& out)
+			{
+				if (reader.Peek() != ValueType::Array)
+				{
+					return Mismatch(name, "an array");
+				}
+
+				reader.BeginArray();
+				std::string element_error;
+				for (std::size_t index = 0; reader.NextElement(); ++index)
+				{
+					T element{};
+					if (ReadJson(reader, element, element_error))
+					{
+						out.push_back(std::move(element));
+					}
+					else if (!reader.HasError())
+					{
+						Note(std::string{name} + "[" + std::to_string(index) + "]: " + element_error);
+					}
+				}
+				return !reader.HasError();
+			}
+
+			// Notes the first field that was never seen
+			void Require(std::initializer_list<std::pair<std::string_view, bool>> fields)
+			{
+				for (const auto& [name, seen] : fields)
+				{
+					if (!seen)
+					{
+						Note(std::string{"missing \""} + std::string{name} + "\"");
+					}
+				}
+			}
+
+			bool Ok() const
+			{
+				return error.empty();
+			}
+
+		private:
+			bool Mismatch(std::string_view name, std::string_view expected)
+			{
+				Note(std::string{"\""} + std::string{name} + "\" must be " + std::string{expected});
+				return reader.SkipValue();
+			}
+
+			void Note(std::string message)
+			{
+				if (error.empty())
+				{
+					error = std::move(message);
+				}
+			}
+
+			Reader& reader;
+			std::string& error;
+		};
+
+		// Skips a non-object value; the caller reports it as a wrong shape
+		bool ExpectObject(Reader& in, std::string& error)
+		{
+			if (in.Peek() == ValueType::Object)
+			{
+				return in.BeginObject();
+			}
+			error = "expected an object";
+			in.SkipValue();
+			return false;
+		}
+	} // namespace
+
+	bool ReadJson(utils::json::Reader& in, KanjiWord& word, std::string& error)
+	{
+		error.clear();
+		if (!ExpectObject(in, error))
+		{
+			return false;
+		}
+
+		FieldSet fields{in, error};
+		bool has_word = false;
+		bool has_reading = false;
+		std::string key;
+		while (in.NextKey(key))
+		{
+			if (key == "word")
+			{
+				has_word = fields.String(key, word.word);
+			}
+			else if (key == "reading")
+			{
+				has_reading = fields.String(key, word.reading);
+			}
+			else
+			{
+				in.SkipValue();
+			}
+		}
+		fields.Require({{"word", has_word}, {"reading", has_reading}});
+		return !in.HasError() && fields.Ok();
+	}
+
+	bool ReadJson(utils::json::Reader& in, KanjiData& kanji, std::string& error)
+	{
+		error.clear();
+		if (!ExpectObject(in, error))
+		{
+			return false;
+		}
+
+		FieldSet fields{in, error};
+		bool has_id = false;
+		bool has_kanji = false;
+		bool has_meaning = false;
+		bool has_examples = false;
+		std::string key;
+		while (in.NextKey(key))
+		{
+			if (key == "id")
+			{
+				has_id = fields.Integer(key, kanji.id);
+			}
+			else if (key == "kanji")
+			{
+				has_kanji = fields.String(key, kanji.kanji);
+			}
+			else if (key == "meaning")
+			{
+				has_meaning = fields.String(key, kanji.meaning);
+			}
+			else if (key == "examples")
+			{
+				kanji.examples.clear();
+				has_examples = fields.Array(key, kanji.examples);
+			}
+			else
+			{
+				in.SkipValue();
+			}
+		}
+		fields.Require({{"id", has_id}, {"kanji", has_kanji}, {"examples", has_examples}, {"meaning", has_meaning}});
+		return !in.HasError() && fields.Ok();
+	}
+
+	bool ReadJson(utils::json::Reader& in, KanjiAnswer& answer, std::string& error)
+	{
+		error.clear();
+		if (!ExpectObject(in, error))
+		{
+			return false;
+		}
+
+		FieldSet fields{in, error};
+		bool has_kanji_id = false;
+		bool has_incorrect_streak = false;
+		std::string key;
+		while (in.NextKey(key))
+		{
+			if (key == "kanji_id")
+			{
+				has_kanji_id = fields.Integer(key, answer.kanji_id);
+			}
+			else if (key == "incorrect_streak")
+			{
+				has_incorrect_streak = fields.Integer(key, answer.incorrect_streak);
+			}
+			else
+			{
+				in.SkipValue();
+			}
+		}
+		fields.Require({{"kanji_id", has_kanji_id}, {"incorrect_streak", has_incorrect_streak}});
+		return !in.HasError() && fields.Ok();
+	}
+} // namespace kanji
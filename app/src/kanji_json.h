@@ -0,0 +1,49 @@
+#pragma once
+
+#include "kanji.h"
+#include "utils/json_reader.h"
+#include "utils/json_writer.h"
+#include <string>
+
+namespace kanji
+{
+	// Streaming counterparts of the NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE definitions in kanji.h.
+	// Keys are written in the sorted order nlohmann::json uses for objects.
+
+	inline void WriteJson(utils::json::Writer& out, const KanjiWord& word)
+	{
+		out.BeginObject();
+		out.Field("reading", word.reading);
+		out.Field("word", word.word);
+		out.EndObject();
+	}
+
+	inline void WriteJson(utils::json::Writer& out, const KanjiData& kanji)
+	{
+		out.BeginObject();
+		out.Field("examples", kanji.examples);
+		out.Field("id", kanji.id);
+		out.Field("kanji", kanji.kanji);
+		out.Field("meaning", kanji.meaning);
+		out.EndObject();
+	}
+
+	inline void WriteJson(utils::json::Writer& out, const KanjiRecord& record)
+	{
+		out.BeginObject();
+		out.Field("id", record.id);
+		out.Field("kanji", record.kanji);
+		out.Field("level", record.level);
+		out.Field("meaning", record.meaning);
+		out.Field("next_review_date", record.next_review_date);
+		out.EndObject();
+	}
+
+	// Decode the next value in one pass. Like the nlohmann definitions, every field is required and
+	// unknown keys are ignored. A value of the wrong shape is skipped and described in `error`, so
+	// the caller can carry on with the next one; false with in.HasError() means the document itself
+	// is malformed.
+	bool ReadJson(utils::json::Reader& in, KanjiWord& word, std::string& error);
+	bool ReadJson(utils::json::Reader& in, KanjiData& kanji, std::string& error);
+	bool ReadJson(utils::json::Reader& in, KanjiAnswer& answer, std::string& error);
+} // namespace kanji
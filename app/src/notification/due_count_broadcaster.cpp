@@ -0,0 +1,152 @@
+#include "due_count_broadcaster.h"
+#include "controller.h"
+#include <algorithm>
+#include <spdlog/spdlog.h>
+
+namespace kanji::notification
+{
+	namespace
+	{
+		std::string DueMessage(std::size_t count)
+		{
+			return R"({"type":"due","count":)" + std::to_string(count) + "}";
+		}
+	} // namespace
+
+	DueCountBroadcaster::DueCountBroadcaster(std::chrono::milliseconds in_heartbeat_interval)
+	    : heartbeat_interval{in_heartbeat_interval}
+	{
+	}
+
+	void DueCountBroadcaster::Start()
+	{
+		worker = std::jthread([this](std::stop_token token) { Run(token); });
+	}
+
+	DueCountBroadcaster::StreamId DueCountBroadcaster::Subscribe(Controller& controller, std::shared_ptr<void> owner,
+	                                                             Send send)
+	{
+		std::lock_guard lock{mutex};
+		const StreamId id = next_id++;
+		stream_topics.emplace(id, &controller);
+
+		auto [it, inserted] = topics.try_emplace(&controller);
+		Topic& topic = it->second;
+		if (inserted)
+		{
+			topic.controller = &controller;
+			topic.owner = std::move(owner);
+			Refresh(topic);
+		}
+		// Later streams start from the count the others last saw; the worker catches them all up together
+		send(DueMessage(*topic.sent_count));
+		topic.streams.emplace_back(id, std::move(send));
+
+		// A new topic may fall due before the worker's current deadline
+		notified = true;
+		wake.notify_one();
+		return id;
+	}
+
+	void DueCountBroadcaster::Unsubscribe(StreamId id)
+	{
+		std::lock_guard lock{mutex};
+		const auto stream = stream_topics.find(id);
+		if (stream == stream_topics.end())
+		{
+			return;
+		}
+
+		const auto topic = topics.find(stream->second);
+		stream_topics.erase(stream);
+		std::erase_if(topic->second.streams, [id](const auto& entry) { return entry.first == id; });
+		if (topic->second.streams.empty())
+		{
+			// Releases the learner's shard with the last stream watching it
+			topics.erase(topic);
+		}
+	}
+
+	void DueCountBroadcaster::Notify()
+	{
+		{
+			std::lock_guard lock{mutex};
+			notified = true;
+		}
+		wake.notify_one();
+	}
+
+	std::size_t DueCountBroadcaster::GetStreamCount() const
+	{
+		std::lock_guard lock{mutex};
+		return stream_topics.size();
+	}
+
+	void DueCountBroadcaster::Run(std::stop_token stop_token)
+	{
+		std::unique_lock lock{mutex};
+		auto next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval;
+		while (!stop_token.stop_requested())
+		{
+			notified = false;
+			for (auto& [controller, topic] : topics)
+			{
+				Refresh(topic);
+			}
+
+			if (std::chrono::steady_clock::now() >= next_heartbeat)
+			{
+				static const std::string HEARTBEAT = R"({"type":"heartbeat"})";
+				for (const auto& [controller, topic] : topics)
+				{
+					Broadcast(topic, HEARTBEAT);
+				}
+				next_heartbeat = std::chrono::steady_clock::now() + heartbeat_interval;
+			}
+
+			// Sleep until the next heartbeat or the earliest review falling due, whichever comes first
+			auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(next_heartbeat -
+			                                                                     std::chrono::steady_clock::now());
+			const auto now = std::chrono::system_clock::now();
+			for (const auto& [controller, topic] : topics)
+			{
+				if (topic.next_due)
+				{
+					timeout = std::min(timeout, std::chrono::ceil<std::chrono::milliseconds>(*topic.next_due - now));
+				}
+			}
+			wake.wait_for(lock, stop_token, std::max(timeout, std::chrono::milliseconds{0}), [this] { return notified; });
+		}
+
+		spdlog::info("DueCountBroadcaster: shutdown");
+	}
+
+	void DueCountBroadcaster::Refresh(Topic& topic)
+	{
+		const std::uint64_t revision = topic.controller->GetRevision();
+		const bool fell_due = topic.next_due && *topic.next_due <= std::chrono::system_clock::now();
+		if (topic.sent_count && revision == topic.seen_revision && !fell_due)
+		{
+			return;
+		}
+
+		topic.seen_revision = revision;
+		// Looked up before counting: a review falling due in between is either counted or woken for
+		topic.next_due = topic.controller->GetNextDueTime();
+		const std::size_t count = topic.controller->CountDueReviews();
+		if (count == topic.sent_count)
+		{
+			return;
+		}
+		topic.sent_count = count;
+		Broadcast(topic, DueMessage(count));
+	}
+
+	void DueCountBroadcaster::Broadcast(const Topic& topic, const std::string& message)
+	{
+		for (const auto& [id, send] : topic.streams)
+		{
+			send(message);
+		}
+	}
+} // namespace kanji::notification
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace kanji
+{
+	class Controller;
+}
+
+namespace kanji::notification
+{
+	// Pushes a learner's due-review count to every open stream when it changes: after writes, when
+	// review dates elapse, and as a heartbeat in between so idle connections survive proxies. One
+	// thread serves every stream and sleeps until the next review falls due; counts come from the
+	// in-memory due queue, so a thousand idle tabs cost no database reads at all.
+	//
+	// Messages are JSON text: {"type":"due","count":n} and {"type":"heartbeat"}.
+	class DueCountBroadcaster
+	{
+	public:
+		using StreamId = std::uint64_t;
+		// Hands one message to a stream; called on the broadcaster's thread, so it must not block
+		using Send = std::function<void(const std::string& message)>;
+
+		static constexpr std::chrono::seconds DEFAULT_HEARTBEAT_INTERVAL{25};
+
+		explicit DueCountBroadcaster(std::chrono::milliseconds in_heartbeat_interval = DEFAULT_HEARTBEAT_INTERVAL);
+
+		void Start();
+		// The stream gets the current count right away, then every change. `owner` keeps whatever
+		// owns `controller` (a learner's shard) alive until the stream is removed.
+		StreamId Subscribe(Controller& controller, std::shared_ptr<void> owner, Send send);
+		void Unsubscribe(StreamId id);
+		// Wakes the broadcaster after a write so it does not wait for the next due date or heartbeat
+		void Notify();
+
+		std::size_t GetStreamCount() const;
+
+	private:
+		// Streams watching the same controller share one count
+		struct Topic
+		{
+			Controller* controller{nullptr};
+			std::shared_ptr<void> owner;
+			std::vector<std::pair<StreamId, Send>> streams;
+			std::optional<std::size_t> sent_count;
+			std::uint64_t seen_revision{0};
+			std::optional<std::chrono::system_clock::time_point> next_due;
+		};
+
+		void Run(std::stop_token stop_token);
+		// Recounts after a write or once the next review fell due, and sends the count if it moved
+		void Refresh(Topic& topic);
+		void Broadcast(const Topic& topic, const std::string& message);
+
+		std::chrono::milliseconds heartbeat_interval;
+		mutable std::mutex mutex;
+		std::condition_variable_any wake;
+		bool notified{false};
+		StreamId next_id{1};
+		std::unordered_map<Controller*, Topic> topics;
+		std::unordered_map<StreamId, Controller*> stream_topics;
+		std::jthread worker;
+	};
+} // namespace kanji::notification
@@ -1,13 +1,13 @@
 #include "review_notifier.h"
-#include "database/database_context.h"
+#include "controller.h"
 #include <spdlog/spdlog.h>
 
 namespace kanji::notification
 {
-	ReviewNotifier::ReviewNotifier(database::DatabaseContext& in_db,
+	ReviewNotifier::ReviewNotifier(Controller& in_controller,
 	                               std::unique_ptr<INotificationService> in_notification_service,
 	                               std::chrono::minutes in_check_interval)
-	    : db{in_db}
+	    : controller{in_controller}
 	    , notification_service{std::move(in_notification_service)}
 	    , check_interval{in_check_interval}
 	{
@@ -22,8 +22,7 @@ namespace kanji::notification
 	{
 		while (!stop_token.stop_requested())
 		{
-			const auto pending = db.GetKanjiRepository().GetKanjiForReview();
-			const int count = static_cast<int>(pending.size());
+			const int count = static_cast<int>(controller.CountDueReviews());
 
 			if (count > 0)
 			{
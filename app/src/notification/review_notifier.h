@@ -5,9 +5,9 @@
 #include <memory>
 #include <thread>
 
-namespace kanji::database
+namespace kanji
 {
-	class DatabaseContext;
+	class Controller;
 }
 
 namespace kanji::notification
@@ -15,7 +15,7 @@ namespace kanji::notification
 	class ReviewNotifier
 	{
 	public:
-		ReviewNotifier(database::DatabaseContext& in_db,
+		ReviewNotifier(Controller& in_controller,
 		               std::unique_ptr<INotificationService> in_notification_service,
 		               std::chrono::minutes in_check_interval = std::chrono::minutes{30});
 
@@ -24,7 +24,7 @@ namespace kanji::notification
 	private:
 		void Run(std::stop_token stop_token);
 
-		database::DatabaseContext& db;
+		Controller& controller;
 		std::unique_ptr<INotificationService> notification_service;
 		std::chrono::minutes check_interval;
 
@@ -0,0 +1,358 @@
+#include "due_queue.h"
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+	std::int64_t ToSeconds(std::chrono::system_clock::time_point time)
+	{
+		return std::chrono::system_clock::to_time_t(time);
+	}
+} // namespace
+
+namespace kanji::scheduler
+{
+	std::vector<std::uint32_t> DueQueue::Snapshot::GetDue(std::chrono::system_clock::time_point now,
+	                                                      std::size_t limit) const
+	{
+		const std::int64_t now_seconds = ToSeconds(now);
+
+		std::vector<std::uint32_t> ids;
+		for (const auto& chunk : chunks)
+		{
+			for (auto it = chunk->begin(); it != chunk->end(); ++it)
+			{
+				if (ids.size() >= limit || it->first >= now_seconds)
+				{
+					return ids;
+				}
+				ids.push_back(it->second);
+			}
+		}
+		return ids;
+	}
+
+	std::size_t DueQueue::Snapshot::CountDue(std::chrono::system_clock::time_point now) const
+	{
+		return CountBefore(Key{ToSeconds(now), 0});
+	}
+
+	std::optional<std::chrono::system_clock::time_point> DueQueue::Snapshot::GetNextDueTime(
+	    std::chrono::system_clock::time_point now) const
+	{
+		const Key key{ToSeconds(now), 0};
+		const std::size_t chunk = FindChunk(key);
+		if (chunk == chunks.size())
+		{
+			return std::nullopt;
+		}
+		const auto next = std::lower_bound(chunks[chunk]->begin(), chunks[chunk]->end(), key);
+		// Dates are compared in whole seconds, so a kanji counts once its second has passed
+		return std::chrono::system_clock::from_time_t(static_cast<std::time_t>(next->first + 1));
+	}
+
+	std::optional<KanjiReviewState> DueQueue::Snapshot::Find(std::uint32_t kanji_id) const
+	{
+		const std::size_t page = kanji_id / PAGE_SIZE;
+		if (kanji_id == 0 || page >= pages.size() || !pages[page])
+		{
+			return std::nullopt;
+		}
+		const auto& state = (*pages[page])[kanji_id % PAGE_SIZE];
+		if (state.kanji_id == 0)
+		{
+			return std::nullopt;
+		}
+		return state;
+	}
+
+	std::size_t DueQueue::Snapshot::Size() const
+	{
+		return size;
+	}
+
+	void DueQueue::Snapshot::ForEach(std::optional<Key> after,
+	                                 const std::function<bool(const KanjiReviewState&)>& visit) const
+	{
+		std::size_t chunk = 0;
+		std::size_t offset = 0;
+		if (after)
+		{
+			const auto first = std::partition_point(chunks.begin(), chunks.end(),
+			                                        [&](const auto& candidate) { return candidate->back() <= *after; });
+			chunk = static_cast<std::size_t>(std::distance(chunks.begin(), first));
+			if (chunk < chunks.size())
+			{
+				const auto& keys = *chunks[chunk];
+				offset = static_cast<std::size_t>(std::distance(keys.begin(), std::upper_bound(keys.begin(), keys.end(), *after)));
+			}
+		}
+
+		for (; chunk < chunks.size(); ++chunk, offset = 0)
+		{
+			const auto& keys = *chunks[chunk];
+			for (auto it = keys.begin() + offset; it != keys.end(); ++it)
+			{
+				if (!visit(GetState(it->second)))
+				{
+					return;
+				}
+			}
+		}
+	}
+
+	std::size_t DueQueue::Snapshot::FindChunk(const Key& key) const
+	{
+		const auto it = std::partition_point(chunks.begin(), chunks.end(),
+		                                     [&](const auto& chunk) { return chunk->back() < key; });
+		return static_cast<std::size_t>(std::distance(chunks.begin(), it));
+	}
+
+	std::size_t DueQueue::Snapshot::CountBefore(const Key& key) const
+	{
+		const std::size_t chunk = FindChunk(key);
+		if (chunk == chunks.size())
+		{
+			return size;
+		}
+		const auto it = std::lower_bound(chunks[chunk]->begin(), chunks[chunk]->end(), key);
+		return chunk_starts[chunk] + static_cast<std::size_t>(std::distance(chunks[chunk]->begin(), it));
+	}
+
+	const KanjiReviewState& DueQueue::Snapshot::GetState(std::uint32_t kanji_id) const
+	{
+		return (*pages[kanji_id / PAGE_SIZE])[kanji_id % PAGE_SIZE];
+	}
+
+	DueQueue::DueQueue()
+	    : current{std::make_shared<const Snapshot>()}
+	{
+	}
+
+	std::shared_ptr<const DueQueue::Snapshot> DueQueue::GetSnapshot() const
+	{
+		return current.load(std::memory_order_acquire);
+	}
+
+	void DueQueue::Load(const std::vector<KanjiReviewState>& states)
+	{
+		std::lock_guard lock{write_mutex};
+		std::vector<std::shared_ptr<Snapshot::Page>> pages;
+		for (const auto& state : states)
+		{
+			const std::size_t page = state.kanji_id / PAGE_SIZE;
+			if (page >= pages.size())
+			{
+				pages.resize(page + 1);
+			}
+			if (!pages[page])
+			{
+				pages[page] = std::make_shared<Snapshot::Page>();
+			}
+			(*pages[page])[state.kanji_id % PAGE_SIZE] = state;
+		}
+
+		std::vector<Key> order;
+		order.reserve(states.size());
+		for (const auto& page : pages)
+		{
+			for (std::size_t slot = 0; page && slot < PAGE_SIZE; ++slot)
+			{
+				if (const auto& state = (*page)[slot]; state.kanji_id != 0)
+				{
+					order.emplace_back(ToSeconds(state.next_review_date), state.kanji_id);
+				}
+			}
+		}
+		std::sort(order.begin(), order.end());
+
+		auto next = std::make_shared<Snapshot>();
+		next->pages.assign(pages.begin(), pages.end());
+		for (std::size_t first = 0; first < order.size(); first += CHUNK_SIZE)
+		{
+			const std::size_t last = std::min(first + CHUNK_SIZE, order.size());
+			next->chunks.push_back(std::make_shared<const Snapshot::Chunk>(order.begin() + first, order.begin() + last));
+		}
+		Index(*next);
+		Publish(std::move(next));
+	}
+
+	void DueQueue::Update(const std::vector<KanjiReviewState>& states)
+	{
+		if (states.empty())
+		{
+			return;
+		}
+
+		std::lock_guard lock{write_mutex};
+		const auto previous = GetSnapshot();
+		auto next = std::make_shared<Snapshot>();
+
+		// Untouched pages are shared with the previous snapshot; each touched one is copied once
+		next->pages = previous->pages;
+		std::vector<std::shared_ptr<Snapshot::Page>> copied(next->pages.size());
+		std::vector<std::uint32_t> touched;
+		touched.reserve(states.size());
+		for (const auto& state : states)
+		{
+			const std::size_t page = state.kanji_id / PAGE_SIZE;
+			if (page >= next->pages.size())
+			{
+				next->pages.resize(page + 1);
+				copied.resize(page + 1);
+			}
+			if (!copied[page])
+			{
+				copied[page] = next->pages[page] ? std::make_shared<Snapshot::Page>(*next->pages[page])
+				                                 : std::make_shared<Snapshot::Page>();
+				next->pages[page] = copied[page];
+			}
+			(*copied[page])[state.kanji_id % PAGE_SIZE] = state;
+			touched.push_back(state.kanji_id);
+		}
+		std::sort(touched.begin(), touched.end());
+		touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+		std::vector<Key> removed;
+		std::vector<Key> added;
+		added.reserve(touched.size());
+		for (const std::uint32_t id : touched)
+		{
+			if (const auto old_state = previous->Find(id))
+			{
+				removed.emplace_back(ToSeconds(old_state->next_review_date), id);
+			}
+			added.emplace_back(ToSeconds(next->GetState(id).next_review_date), id);
+		}
+		std::sort(removed.begin(), removed.end());
+		std::sort(added.begin(), added.end());
+
+		// Every removed key sits in the chunk FindChunk names; an added key goes there too, or into the
+		// last chunk when it sorts after everything. Both lists are sorted, so each chunk's edits are a run.
+		const std::size_t chunk_count = previous->chunks.size();
+		const auto targets = [&](const std::vector<Key>& keys) {
+			std::vector<std::size_t> chunks;
+			chunks.reserve(keys.size());
+			for (const auto& key : keys)
+			{
+				chunks.push_back(std::min(previous->FindChunk(key), chunk_count == 0 ? 0 : chunk_count - 1));
+			}
+			return chunks;
+		};
+		const auto removed_from = targets(removed);
+		const auto added_to = targets(added);
+
+		const auto emit = [&](Snapshot::Chunk&& chunk) {
+			if (chunk.empty())
+			{
+				return;
+			}
+			// A chunk that shrank folds into its neighbour so lookups stay logarithmic in chunk count
+			if (chunk.size() < CHUNK_SIZE / 4 && !next->chunks.empty() &&
+			    next->chunks.back()->size() + chunk.size() <= CHUNK_SIZE)
+			{
+				Snapshot::Chunk merged{*next->chunks.back()};
+				merged.insert(merged.end(), chunk.begin(), chunk.end());
+				next->chunks.back() = std::make_shared<const Snapshot::Chunk>(std::move(merged));
+				return;
+			}
+			if (chunk.size() < 2 * CHUNK_SIZE)
+			{
+				next->chunks.push_back(std::make_shared<const Snapshot::Chunk>(std::move(chunk)));
+				return;
+			}
+			for (std::size_t first = 0; first < chunk.size(); first += CHUNK_SIZE)
+			{
+				const std::size_t last = std::min(first + CHUNK_SIZE, chunk.size());
+				next->chunks.push_back(std::make_shared<const Snapshot::Chunk>(chunk.begin() + first, chunk.begin() + last));
+			}
+		};
+
+		next->chunks.reserve(chunk_count + added.size() / CHUNK_SIZE + 1);
+		std::size_t r = 0;
+		std::size_t a = 0;
+		for (std::size_t c = 0; c < chunk_count || a < added.size(); ++c)
+		{
+			const std::size_t removed_begin = r;
+			while (r < removed.size() && removed_from[r] == c)
+			{
+				++r;
+			}
+			const std::size_t added_begin = a;
+			while (a < added.size() && added_to[a] == c)
+			{
+				++a;
+			}
+
+			if (r == removed_begin && a == added_begin)
+			{
+				next->chunks.push_back(previous->chunks[c]);
+				continue;
+			}
+
+			Snapshot::Chunk kept;
+			if (c < chunk_count)
+			{
+				const auto& base = *previous->chunks[c];
+				kept.reserve(base.size());
+				std::set_difference(base.begin(), base.end(), removed.begin() + removed_begin, removed.begin() + r,
+				                    std::back_inserter(kept));
+			}
+			Snapshot::Chunk edited;
+			edited.reserve(kept.size() + (a - added_begin));
+			std::merge(kept.begin(), kept.end(), added.begin() + added_begin, added.begin() + a, std::back_inserter(edited));
+			emit(std::move(edited));
+		}
+
+		Index(*next);
+		Publish(std::move(next));
+	}
+
+	std::vector<std::uint32_t> DueQueue::GetDue(std::chrono::system_clock::time_point now, std::size_t limit) const
+	{
+		return GetSnapshot()->GetDue(now, limit);
+	}
+
+	std::size_t DueQueue::CountDue(std::chrono::system_clock::time_point now) const
+	{
+		return GetSnapshot()->CountDue(now);
+	}
+
+	std::optional<std::chrono::system_clock::time_point> DueQueue::GetNextDueTime(
+	    std::chrono::system_clock::time_point now) const
+	{
+		return GetSnapshot()->GetNextDueTime(now);
+	}
+
+	std::optional<KanjiReviewState> DueQueue::Find(std::uint32_t kanji_id) const
+	{
+		return GetSnapshot()->Find(kanji_id);
+	}
+
+	std::size_t DueQueue::Size() const
+	{
+		return GetSnapshot()->Size();
+	}
+
+	void DueQueue::ForEach(std::optional<Key> after, const std::function<bool(const KanjiReviewState&)>& visit) const
+	{
+		GetSnapshot()->ForEach(after, visit);
+	}
+
+	void DueQueue::Publish(std::shared_ptr<const Snapshot> snapshot)
+	{
+		current.store(std::move(snapshot), std::memory_order_release);
+	}
+
+	void DueQueue::Index(Snapshot& snapshot)
+	{
+		snapshot.chunk_starts.clear();
+		snapshot.chunk_starts.reserve(snapshot.chunks.size());
+		snapshot.size = 0;
+		for (const auto& chunk : snapshot.chunks)
+		{
+			snapshot.chunk_starts.push_back(snapshot.size);
+			snapshot.size += chunk->size();
+		}
+	}
+} // namespace kanji::scheduler
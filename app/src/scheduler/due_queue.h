@@ -0,0 +1,92 @@
+#pragma once
+
+#include "kanji.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace kanji::scheduler
+{
+	// In-memory index of review states ordered by (next_review_date, kanji_id), the same order
+	// the SQLite due query uses. Lets review selection and due counts skip the database.
+	//
+	// Readers never lock: they take the current immutable snapshot and keep it for as long as they
+	// need, so a full list walk and an answer batch never wait on each other. Writers publish a new
+	// snapshot that shares every untouched chunk of the order and page of states with the old one,
+	// so an answer costs a copy of the two pointer tables plus the few chunks and pages it changes.
+	class DueQueue
+	{
+	public:
+		// (next_review_date in seconds, kanji_id)
+		using Key = std::pair<std::int64_t, std::uint32_t>;
+
+		// Keys per chunk of the sorted order; a chunk is split once it grows to twice this
+		static constexpr std::size_t CHUNK_SIZE = 512;
+		// States per page of the id index
+		static constexpr std::size_t PAGE_SIZE = 512;
+
+		class Snapshot
+		{
+		public:
+			// Ids of up to `limit` kanjis due strictly before `now`, earliest first
+			std::vector<std::uint32_t> GetDue(std::chrono::system_clock::time_point now, std::size_t limit) const;
+			std::size_t CountDue(std::chrono::system_clock::time_point now) const;
+			// When CountDue next grows on its own, or empty when nothing is waiting past `now`
+			std::optional<std::chrono::system_clock::time_point> GetNextDueTime(std::chrono::system_clock::time_point now) const;
+			std::optional<KanjiReviewState> Find(std::uint32_t kanji_id) const;
+			std::size_t Size() const;
+			// Visits states in queue order, strictly after `after` when given, until `visit` returns false
+			void ForEach(std::optional<Key> after, const std::function<bool(const KanjiReviewState&)>& visit) const;
+
+		private:
+			friend class DueQueue;
+
+			using Chunk = std::vector<Key>;
+			using Page = std::array<KanjiReviewState, PAGE_SIZE>;
+
+			// First chunk whose last key is not below `key`, or chunks.size()
+			std::size_t FindChunk(const Key& key) const;
+			// Number of keys strictly below `key`
+			std::size_t CountBefore(const Key& key) const;
+			const KanjiReviewState& GetState(std::uint32_t kanji_id) const;
+
+			// Sorted by (next_review_date, kanji_id) across chunks; no chunk is empty
+			std::vector<std::shared_ptr<const Chunk>> chunks;
+			// Position of each chunk's first key in the whole order
+			std::vector<std::size_t> chunk_starts;
+			std::size_t size{0};
+			// Page i holds kanji ids [i * PAGE_SIZE, (i + 1) * PAGE_SIZE); a kanji_id of 0 marks an empty slot
+			std::vector<std::shared_ptr<const Page>> pages;
+		};
+
+		DueQueue();
+
+		std::shared_ptr<const Snapshot> GetSnapshot() const;
+		void Load(const std::vector<KanjiReviewState>& states);
+		void Update(const std::vector<KanjiReviewState>& states);
+
+		// Shorthands that read the current snapshot
+		std::vector<std::uint32_t> GetDue(std::chrono::system_clock::time_point now, std::size_t limit) const;
+		std::size_t CountDue(std::chrono::system_clock::time_point now) const;
+		std::optional<std::chrono::system_clock::time_point> GetNextDueTime(std::chrono::system_clock::time_point now) const;
+		std::optional<KanjiReviewState> Find(std::uint32_t kanji_id) const;
+		std::size_t Size() const;
+		void ForEach(std::optional<Key> after, const std::function<bool(const KanjiReviewState&)>& visit) const;
+
+	private:
+		void Publish(std::shared_ptr<const Snapshot> snapshot);
+		// Fills chunk_starts and size from chunks
+		static void Index(Snapshot& snapshot);
+
+		std::atomic<std::shared_ptr<const Snapshot>> current;
+		// Serializes writers so no published update is lost
+		std::mutex write_mutex;
+	};
+} // namespace kanji::scheduler
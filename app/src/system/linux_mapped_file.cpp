@@ -0,0 +1,53 @@
+#ifdef __linux__
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace kanji::system
+{
+	std::unique_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path)
+	{
+		const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0)
+		{
+			return nullptr;
+		}
+
+		struct stat info{};
+		if (fstat(fd, &info) != 0 || info.st_size <= 0)
+		{
+			close(fd);
+			return nullptr;
+		}
+
+		const auto size = static_cast<std::size_t>(info.st_size);
+		void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		// The mapping stays valid after the descriptor is closed
+		close(fd);
+		if (address == MAP_FAILED)
+		{
+			return nullptr;
+		}
+
+		std::unique_ptr<MappedFile> file{new MappedFile{}};
+		file->data = static_cast<const std::byte*>(address);
+		file->size = size;
+		return file;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data)
+		{
+			munmap(const_cast<std::byte*>(data), size);
+		}
+	}
+
+	std::span<const std::byte> MappedFile::GetData() const
+	{
+		return {data, size};
+	}
+} // namespace kanji::system
+#endif
@@ -1,5 +1,6 @@
 #ifdef __linux__
 #include "platform_info.h"
+#include <unistd.h>
 
 namespace kanji::system
 {
@@ -7,5 +8,10 @@ namespace kanji::system
 	{
 		return std::filesystem::current_path() / "kanji.db";
 	}
+
+	bool PlatformInfo::SyncFile(std::FILE* file)
+	{
+		return std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+	}
 } // namespace kanji::system
 #endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace kanji::system
+{
+	// Read-only view of a whole file mapped into memory
+	class MappedFile
+	{
+	public:
+		// Null when the file is missing, empty or cannot be mapped
+		static std::unique_ptr<MappedFile> Open(const std::filesystem::path& path);
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		~MappedFile();
+
+		std::span<const std::byte> GetData() const;
+
+	private:
+		MappedFile() = default;
+
+		const std::byte* data{nullptr};
+		std::size_t size{0};
+#ifdef _WIN32
+		void* file_handle{nullptr};
+		void* mapping_handle{nullptr};
+#endif
+	};
+} // namespace kanji::system
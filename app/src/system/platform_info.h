@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdio>
 #include <filesystem>
 
 namespace kanji::system
@@ -8,5 +9,7 @@ namespace kanji::system
 	{
 	public:
 		static std::filesystem::path GetDatabaseLocation();
+		// Flushes stdio buffers and forces the file contents to stable storage
+		static bool SyncFile(std::FILE* file);
 	};
 } // namespace kanji::system
@@ -0,0 +1,67 @@
+#ifdef _WIN32
+#include "mapped_file.h"
+#include <windows.h>
+
+namespace kanji::system
+{
+	std::unique_ptr<MappedFile> MappedFile::Open(const std::filesystem::path& path)
+	{
+		HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+		                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file_handle == INVALID_HANDLE_VALUE)
+		{
+			return nullptr;
+		}
+
+		LARGE_INTEGER file_size{};
+		if (!GetFileSizeEx(file_handle, &file_size) || file_size.QuadPart <= 0)
+		{
+			CloseHandle(file_handle);
+			return nullptr;
+		}
+
+		HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping_handle)
+		{
+			CloseHandle(file_handle);
+			return nullptr;
+		}
+
+		const void* address = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+		if (!address)
+		{
+			CloseHandle(mapping_handle);
+			CloseHandle(file_handle);
+			return nullptr;
+		}
+
+		std::unique_ptr<MappedFile> file{new MappedFile{}};
+		file->data = static_cast<const std::byte*>(address);
+		file->size = static_cast<std::size_t>(file_size.QuadPart);
+		file->file_handle = file_handle;
+		file->mapping_handle = mapping_handle;
+		return file;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (data)
+		{
+			UnmapViewOfFile(data);
+		}
+		if (mapping_handle)
+		{
+			CloseHandle(mapping_handle);
+		}
+		if (file_handle)
+		{
+			CloseHandle(file_handle);
+		}
+	}
+
+	std::span<const std::byte> MappedFile::GetData() const
+	{
+		return {data, size};
+	}
+} // namespace kanji::system
+#endif
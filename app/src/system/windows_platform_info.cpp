@@ -1,6 +1,7 @@
 #ifdef _WIN32
 #include "platform_info.h"
 #include <ShlObj.h>
+#include <io.h>
 #include <windows.h>
 
 namespace
@@ -26,5 +27,10 @@ namespace kanji::system
 	{
 		return GetMainFolder() / "kanji.db";
 	}
+
+	bool PlatformInfo::SyncFile(std::FILE* file)
+	{
+		return std::fflush(file) == 0 && _commit(_fileno(file)) == 0;
+	}
 } // namespace kanji::system
 #endif
@@ -0,0 +1,168 @@
+#include "tenant_registry.h"
+#include "scheduler/wanikani_scheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <spdlog/spdlog.h>
+
+namespace kanji::tenancy
+{
+	Tenant::Tenant(std::filesystem::path shard_path, std::filesystem::path catalog_path,
+	               const config::DatabaseSettings& settings, std::shared_ptr<catalog::CatalogStore> catalog_store)
+	    : db{std::move(shard_path), settings, std::move(catalog_path)}
+	    , controller{db, std::make_unique<scheduler::WaniKaniScheduler>(), std::move(catalog_store), db.GetAnswerJournal()}
+	{
+	}
+
+	TenantRegistry::TenantRegistry(std::filesystem::path in_shard_directory, std::filesystem::path in_catalog_path,
+	                               config::DatabaseSettings in_settings,
+	                               std::shared_ptr<catalog::CatalogStore> in_catalog_store, std::size_t in_capacity)
+	    : shard_directory{std::move(in_shard_directory)}
+	    , catalog_path{std::move(in_catalog_path)}
+	    , settings{std::move(in_settings)}
+	    , catalog_store{std::move(in_catalog_store)}
+	    , capacity{std::max<std::size_t>(in_capacity, 1)}
+	{
+		stats.capacity = capacity;
+	}
+
+	std::shared_ptr<Tenant> TenantRegistry::Acquire(std::string_view user_id)
+	{
+		if (!IsValidUserId(user_id))
+		{
+			spdlog::warn("Rejecting shard for invalid user id '{0}'", user_id);
+			return nullptr;
+		}
+
+		const std::string key{user_id};
+		std::shared_future<std::shared_ptr<Tenant>> pending;
+		std::promise<std::shared_ptr<Tenant>> opening;
+		std::shared_future<void> previous_close;
+		std::uint64_t generation = 0;
+		std::vector<ClosingTenant> evicted;
+		{
+			// Only bookkeeping happens under the lock; SQLite files are opened and closed after it
+			std::lock_guard lock{mutex};
+			if (auto it = open_tenants.find(key); it != open_tenants.end())
+			{
+				++stats.hits;
+				lru.splice(lru.begin(), lru, it->second);
+				pending = it->second->tenant;
+			}
+			else
+			{
+				++stats.misses;
+				std::shared_ptr<Tenant> tenant;
+				if (auto draining_it = draining.find(key); draining_it != draining.end())
+				{
+					tenant = draining_it->second.lock();
+					draining.erase(draining_it);
+				}
+				if (tenant)
+				{
+					opening.set_value(std::move(tenant));
+				}
+				else
+				{
+					generation = ++next_generation;
+					if (auto closing_it = closing.find(key); closing_it != closing.end())
+					{
+						previous_close = closing_it->second;
+					}
+				}
+
+				pending = opening.get_future().share();
+				lru.push_front({key, pending, generation});
+				open_tenants[key] = lru.begin();
+				evicted = Evict();
+				stats.open = lru.size();
+			}
+		}
+
+		for (auto& closing_tenant : evicted)
+		{
+			closing_tenant.tenant.reset();
+			closing_tenant.closed.set_value();
+		}
+
+		if (generation != 0)
+		{
+			// The same shard may still be closing after an eviction
+			if (previous_close.valid())
+			{
+				previous_close.wait();
+			}
+
+			try
+			{
+				opening.set_value(std::make_shared<Tenant>(GetShardPath(user_id), catalog_path, settings, catalog_store));
+			}
+			catch (...)
+			{
+				{
+					std::lock_guard lock{mutex};
+					if (auto it = open_tenants.find(key); it != open_tenants.end() && it->second->generation == generation)
+					{
+						lru.erase(it->second);
+						open_tenants.erase(it);
+						stats.open = lru.size();
+					}
+				}
+				// Requests waiting on this open see the same error
+				opening.set_exception(std::current_exception());
+			}
+		}
+		return pending.get();
+	}
+
+	std::filesystem::path TenantRegistry::GetShardPath(std::string_view user_id) const
+	{
+		return shard_directory / (std::string{user_id} + ".db");
+	}
+
+	TenantStats TenantRegistry::GetStats() const
+	{
+		std::lock_guard lock{mutex};
+		return stats;
+	}
+
+	bool TenantRegistry::IsValidUserId(std::string_view user_id)
+	{
+		return !user_id.empty() && user_id.size() <= 20 &&
+		       std::all_of(user_id.begin(), user_id.end(), [](char c) { return c >= '0' && c <= '9'; });
+	}
+
+	std::vector<TenantRegistry::ClosingTenant> TenantRegistry::Evict()
+	{
+		std::vector<ClosingTenant> evicted;
+		while (lru.size() > capacity)
+		{
+			Entry& entry = lru.back();
+			// A shard still being opened was only just requested; run over capacity until it is ready
+			if (entry.tenant.wait_for(std::chrono::seconds{0}) != std::future_status::ready)
+			{
+				break;
+			}
+
+			auto& closing_tenant = evicted.emplace_back();
+			closing_tenant.tenant = entry.tenant.get();
+			// Beyond the entry and this copy, requests still hold the tenant; it closes when the last one finishes
+			if (closing_tenant.tenant.use_count() > 2)
+			{
+				draining[entry.key] = closing_tenant.tenant;
+			}
+			else
+			{
+				closing[entry.key] = closing_tenant.closed.get_future().share();
+			}
+			open_tenants.erase(entry.key);
+			lru.pop_back();
+			++stats.evictions;
+		}
+
+		std::erase_if(draining, [](const auto& entry) { return entry.second.expired(); });
+		std::erase_if(closing, [](const auto& entry) {
+			return entry.second.wait_for(std::chrono::seconds{0}) == std::future_status::ready;
+		});
+		return evicted;
+	}
+} // namespace kanji::tenancy
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "catalog/catalog_store.h"
+#include "config.h"
+#include "controller.h"
+#include "database/database_context.h"
+#include "http/response_cache.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace kanji::tenancy
+{
+	// One learner's review-state shard and the controller serving it
+	struct Tenant
+	{
+		Tenant(std::filesystem::path shard_path, std::filesystem::path catalog_path,
+		       const config::DatabaseSettings& settings, std::shared_ptr<catalog::CatalogStore> catalog_store);
+
+		database::DatabaseContext db;
+		Controller controller;
+		http::ResponseCache responses;
+	};
+
+	struct TenantStats
+	{
+		std::size_t open{};
+		std::size_t capacity{};
+		std::uint64_t hits{};
+		std::uint64_t misses{};
+		std::uint64_t evictions{};
+	};
+
+	NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE(TenantStats, open, capacity, hits, misses, evictions)
+
+	// Opens learner shards on demand and keeps the most recently used ones open. An evicted shard
+	// stays alive until its last in-flight request lets go, and is handed back if its learner
+	// returns before then, so one shard file is never open twice. Shards are opened and closed
+	// outside the registry lock: a cold shard only holds up requests for that same learner.
+	class TenantRegistry
+	{
+	public:
+		TenantRegistry(std::filesystem::path in_shard_directory, std::filesystem::path in_catalog_path,
+		               config::DatabaseSettings in_settings, std::shared_ptr<catalog::CatalogStore> in_catalog_store,
+		               std::size_t in_capacity);
+
+		// Null when `user_id` is not a valid shard name
+		std::shared_ptr<Tenant> Acquire(std::string_view user_id);
+		std::filesystem::path GetShardPath(std::string_view user_id) const;
+		TenantStats GetStats() const;
+
+		// Shard names are the decimal Telegram user ids carried in the JWT subject
+		static bool IsValidUserId(std::string_view user_id);
+
+	private:
+		struct Entry
+		{
+			std::string key;
+			// Ready once the opening request has built the tenant
+			std::shared_future<std::shared_ptr<Tenant>> tenant;
+			// Tells a failed open's entry apart from a later one for the same learner
+			std::uint64_t generation{};
+		};
+
+		// An evicted tenant released outside the lock; `closed` is set once it is gone
+		struct ClosingTenant
+		{
+			std::shared_ptr<Tenant> tenant;
+			std::promise<void> closed;
+		};
+
+		using LruList = std::list<Entry>;
+
+		std::vector<ClosingTenant> Evict();
+
+		const std::filesystem::path shard_directory;
+		const std::filesystem::path catalog_path;
+		const config::DatabaseSettings settings;
+		const std::shared_ptr<catalog::CatalogStore> catalog_store;
+		const std::size_t capacity;
+
+		mutable std::mutex mutex;
+		// Most recently used first
+		LruList lru;
+		std::unordered_map<std::string, LruList::iterator> open_tenants;
+		// Evicted while still in use
+		std::unordered_map<std::string, std::weak_ptr<Tenant>> draining;
+		// Evicted idle tenants still being closed; reopening waits for them
+		std::unordered_map<std::string, std::shared_future<void>> closing;
+		std::uint64_t next_generation{0};
+		TenantStats stats;
+	};
+} // namespace kanji::tenancy
@@ -2,6 +2,7 @@
 #include <format>
 #include <openssl/evp.h>
 #include <openssl/hmac.h>
+#include <openssl/rand.h>
 
 namespace kanji::utils::crypto
 {
@@ -49,4 +50,15 @@ namespace kanji::utils::crypto
 
 		return hmac;
 	}
+
+	Hash RandomBytes(std::size_t size)
+	{
+		Hash bytes;
+		bytes.value.resize(size);
+		if (RAND_bytes(bytes.value.data(), static_cast<int>(size)) != 1)
+		{
+			bytes.value.clear();
+		}
+		return bytes;
+	}
 } // namespace kanji::utils::crypto
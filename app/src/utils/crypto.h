@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -15,4 +16,6 @@ namespace kanji::utils::crypto
 
 	Hash SHA256(std::string_view view);
 	Hash HMAC_SHA256(std::string_view data_check_string, const Hash& secret_key);
+	// `size` bytes from OpenSSL's CSPRNG; empty if it could not be seeded
+	Hash RandomBytes(std::size_t size);
 } // namespace kanji::utils::crypto
@@ -0,0 +1,530 @@
+#include "json_reader.h"
+#include "utf8.h"
+#include <cstdint>
+#include <cstring>
+
+namespace kanji::utils::json
+{
+	namespace
+	{
+		constexpr std::uint64_t ONES = 0x0101010101010101ull;
+		constexpr std::uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+		// High bit set in every byte of `word` that is '"', '\\', a control character or non-ASCII
+		std::uint64_t SpecialBytes(std::uint64_t word)
+		{
+			const auto zero_byte = [](std::uint64_t x) { return (x - ONES) & ~x & HIGH_BITS; };
+			const std::uint64_t quote = zero_byte(word ^ (ONES * '"'));
+			const std::uint64_t backslash = zero_byte(word ^ (ONES * '\\'));
+			const std::uint64_t control = (word - ONES * 0x20) & ~word & HIGH_BITS;
+			return quote | backslash | control | (word & HIGH_BITS);
+		}
+
+		void AppendUtf8(std::string& out, char32_t codepoint)
+		{
+			if (codepoint < 0x80)
+			{
+				out += static_cast<char>(codepoint);
+			}
+			else if (codepoint < 0x800)
+			{
+				out += static_cast<char>(0xC0 | (codepoint >> 6));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else if (codepoint < 0x10000)
+			{
+				out += static_cast<char>(0xE0 | (codepoint >> 12));
+				out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+			else
+			{
+				out += static_cast<char>(0xF0 | (codepoint >> 18));
+				out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+				out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (codepoint & 0x3F));
+			}
+		}
+
+		bool Put(std::string* out, char c)
+		{
+			if (out)
+			{
+				*out += c;
+			}
+			return true;
+		}
+
+		bool IsDigit(char c)
+		{
+			return c >= '0' && c <= '9';
+		}
+	} // namespace
+
+	Reader::Reader(std::string_view in_text)
+	    : text{in_text}
+	{
+	}
+
+	ValueType Reader::Peek()
+	{
+		SkipWhitespace();
+		if (HasError() || pos >= text.size())
+		{
+			return ValueType::Invalid;
+		}
+
+		switch (text[pos])
+		{
+		case '{':
+			return ValueType::Object;
+		case '[':
+			return ValueType::Array;
+		case '"':
+			return ValueType::String;
+		case 't':
+		case 'f':
+			return ValueType::Boolean;
+		case 'n':
+			return ValueType::Null;
+		default:
+			return text[pos] == '-' || IsDigit(text[pos]) ? ValueType::Number : ValueType::Invalid;
+		}
+	}
+
+	bool Reader::BeginObject()
+	{
+		if (!Expect('{'))
+		{
+			return false;
+		}
+		container_opened = true;
+		return true;
+	}
+
+	bool Reader::NextKey(std::string& key)
+	{
+		key.clear();
+		return NextKey(&key);
+	}
+
+	bool Reader::NextKey(std::string* key)
+	{
+		SkipWhitespace();
+		if (HasError())
+		{
+			return false;
+		}
+		if (pos < text.size() && text[pos] == '}')
+		{
+			++pos;
+			container_opened = false;
+			return false;
+		}
+		if (!container_opened && !Expect(','))
+		{
+			return false;
+		}
+		container_opened = false;
+
+		SkipWhitespace();
+		if (pos >= text.size() || text[pos] != '"')
+		{
+			return Fail("expected a key");
+		}
+		return ScanString(key) && Expect(':');
+	}
+
+	bool Reader::BeginArray()
+	{
+		if (!Expect('['))
+		{
+			return false;
+		}
+		container_opened = true;
+		return true;
+	}
+
+	bool Reader::NextElement()
+	{
+		SkipWhitespace();
+		if (HasError())
+		{
+			return false;
+		}
+		if (pos < text.size() && text[pos] == ']')
+		{
+			++pos;
+			container_opened = false;
+			return false;
+		}
+		if (!container_opened && !Expect(','))
+		{
+			return false;
+		}
+		container_opened = false;
+		return true;
+	}
+
+	bool Reader::ReadString(std::string& out)
+	{
+		out.clear();
+		return ScanString(&out);
+	}
+
+	bool Reader::ScanString(std::string* out)
+	{
+		if (!Expect('"'))
+		{
+			return false;
+		}
+
+		std::size_t run_start = pos;
+		while (true)
+		{
+			// Skip plain ASCII eight bytes at a time
+			while (pos + sizeof(std::uint64_t) <= text.size())
+			{
+				std::uint64_t word;
+				std::memcpy(&word, text.data() + pos, sizeof(word));
+				if (SpecialBytes(word) != 0)
+				{
+					break;
+				}
+				pos += sizeof(word);
+			}
+
+			if (pos >= text.size())
+			{
+				return Fail("unterminated string");
+			}
+
+			const auto byte = static_cast<unsigned char>(text[pos]);
+			if (byte == '"')
+			{
+				if (out)
+				{
+					out->append(text.data() + run_start, pos - run_start);
+				}
+				++pos;
+				return true;
+			}
+			if (byte == '\\')
+			{
+				if (out)
+				{
+					out->append(text.data() + run_start, pos - run_start);
+				}
+				++pos;
+				if (!ReadEscape(out))
+				{
+					return false;
+				}
+				run_start = pos;
+			}
+			else if (byte < 0x20)
+			{
+				return Fail("control character in string");
+			}
+			else if (byte >= 0x80)
+			{
+				std::size_t length = 1;
+				utf8::Decode(text, pos, length);
+				if (length == 1)
+				{
+					return Fail("invalid UTF-8 in string");
+				}
+				pos += length;
+			}
+			else
+			{
+				++pos;
+			}
+		}
+	}
+
+	bool Reader::ReadBoolean(bool& out)
+	{
+		SkipWhitespace();
+		if (text.substr(pos).starts_with("true"))
+		{
+			pos += 4;
+			out = true;
+			return !HasError();
+		}
+		if (text.substr(pos).starts_with("false"))
+		{
+			pos += 5;
+			out = false;
+			return !HasError();
+		}
+		return Fail("expected a boolean");
+	}
+
+	bool Reader::SkipValue()
+	{
+		return SkipValue(0);
+	}
+
+	bool Reader::AtEnd()
+	{
+		SkipWhitespace();
+		return !HasError() && pos == text.size();
+	}
+
+	bool Reader::HasError() const
+	{
+		return !error.empty();
+	}
+
+	const std::string& Reader::GetError() const
+	{
+		return error;
+	}
+
+	bool Reader::Fail(std::string_view message)
+	{
+		if (error.empty())
+		{
+			error = std::string{message} + " at byte " + std::to_string(pos);
+		}
+		return false;
+	}
+
+	void Reader::SkipWhitespace()
+	{
+		while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\n' || text[pos] == '\r' || text[pos] == '\t'))
+		{
+			++pos;
+		}
+	}
+
+	bool Reader::Expect(char c)
+	{
+		SkipWhitespace();
+		if (HasError())
+		{
+			return false;
+		}
+		if (pos >= text.size() || text[pos] != c)
+		{
+			return Fail(std::string{"expected '"} + c + "'");
+		}
+		++pos;
+		return true;
+	}
+
+	bool Reader::ScanNumber(std::string_view& digits, bool& integral)
+	{
+		SkipWhitespace();
+		if (HasError())
+		{
+			return false;
+		}
+
+		const std::size_t start = pos;
+		if (pos < text.size() && text[pos] == '-')
+		{
+			++pos;
+		}
+		if (pos >= text.size() || !IsDigit(text[pos]))
+		{
+			return Fail("expected a number");
+		}
+		// No leading zeros: "0" stands alone
+		if (text[pos] == '0')
+		{
+			++pos;
+		}
+		else
+		{
+			while (pos < text.size() && IsDigit(text[pos]))
+			{
+				++pos;
+			}
+		}
+
+		integral = true;
+		if (pos < text.size() && text[pos] == '.')
+		{
+			integral = false;
+			++pos;
+			if (pos >= text.size() || !IsDigit(text[pos]))
+			{
+				return Fail("expected a digit");
+			}
+			while (pos < text.size() && IsDigit(text[pos]))
+			{
+				++pos;
+			}
+		}
+		if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+		{
+			integral = false;
+			++pos;
+			if (pos < text.size() && (text[pos] == '+' || text[pos] == '-'))
+			{
+				++pos;
+			}
+			if (pos >= text.size() || !IsDigit(text[pos]))
+			{
+				return Fail("expected a digit");
+			}
+			while (pos < text.size() && IsDigit(text[pos]))
+			{
+				++pos;
+			}
+		}
+
+		digits = text.substr(start, pos - start);
+		return true;
+	}
+
+	bool Reader::ReadEscape(std::string* out)
+	{
+		if (pos >= text.size())
+		{
+			return Fail("unterminated string");
+		}
+
+		const char escape = text[pos++];
+		switch (escape)
+		{
+		case '"':
+		case '\\':
+		case '/':
+			return Put(out, escape);
+		case 'b':
+			return Put(out, '\b');
+		case 'f':
+			return Put(out, '\f');
+		case 'n':
+			return Put(out, '\n');
+		case 'r':
+			return Put(out, '\r');
+		case 't':
+			return Put(out, '\t');
+		case 'u':
+			break;
+		default:
+			return Fail("invalid escape");
+		}
+
+		const auto read_hex = [this](char32_t& unit) {
+			if (pos + 4 > text.size())
+			{
+				return Fail("truncated \\u escape");
+			}
+			unit = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				const char c = text[pos++];
+				unit <<= 4;
+				if (IsDigit(c))
+				{
+					unit |= static_cast<char32_t>(c - '0');
+				}
+				else if (c >= 'a' && c <= 'f')
+				{
+					unit |= static_cast<char32_t>(c - 'a' + 10);
+				}
+				else if (c >= 'A' && c <= 'F')
+				{
+					unit |= static_cast<char32_t>(c - 'A' + 10);
+				}
+				else
+				{
+					return Fail("invalid \\u escape");
+				}
+			}
+			return true;
+		};
+
+		char32_t codepoint = 0;
+		if (!read_hex(codepoint))
+		{
+			return false;
+		}
+		if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+		{
+			return Fail("unpaired low surrogate");
+		}
+		if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+		{
+			char32_t low = 0;
+			if (!text.substr(pos).starts_with("\\u"))
+			{
+				return Fail("unpaired high surrogate");
+			}
+			pos += 2;
+			if (!read_hex(low))
+			{
+				return false;
+			}
+			if (low < 0xDC00 || low > 0xDFFF)
+			{
+				return Fail("unpaired high surrogate");
+			}
+			codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+		}
+		if (out)
+		{
+			AppendUtf8(*out, codepoint);
+		}
+		return true;
+	}
+
+	bool Reader::SkipValue(int depth)
+	{
+		if (depth > MAX_DEPTH)
+		{
+			return Fail("nesting too deep");
+		}
+
+		switch (Peek())
+		{
+		case ValueType::Object:
+			BeginObject();
+			while (NextKey(nullptr))
+			{
+				if (!SkipValue(depth + 1))
+				{
+					return false;
+				}
+			}
+			return !HasError();
+		case ValueType::Array:
+			BeginArray();
+			while (NextElement())
+			{
+				if (!SkipValue(depth + 1))
+				{
+					return false;
+				}
+			}
+			return !HasError();
+		case ValueType::String:
+			return ScanString(nullptr);
+		case ValueType::Number:
+		{
+			std::string_view digits;
+			bool integral = true;
+			return ScanNumber(digits, integral);
+		}
+		case ValueType::Boolean:
+		{
+			bool value = false;
+			return ReadBoolean(value);
+		}
+		case ValueType::Null:
+			if (text.substr(pos).starts_with("null"))
+			{
+				pos += 4;
+				return true;
+			}
+			return Fail("expected null");
+		default:
+			return Fail(pos >= text.size() ? "unexpected end of input" : "unexpected character");
+		}
+	}
+} // namespace kanji::utils::json
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace kanji::utils::json
+{
+	enum class ValueType
+	{
+		Object,
+		Array,
+		String,
+		Number,
+		Boolean,
+		Null,
+		Invalid
+	};
+
+	// One-pass pull parser over an in-memory document. Callers walk the shape they expect and decode
+	// values straight into their own structs; anything else is validated and skipped. String bodies
+	// are scanned eight bytes at a time. Nothing throws: the first syntax error sticks and every
+	// later call returns false.
+	//
+	//     reader.BeginObject();
+	//     while (reader.NextKey(key)) { key == "id" ? reader.ReadInteger(id) : reader.SkipValue(); }
+	class Reader
+	{
+	public:
+		static constexpr int MAX_DEPTH = 128;
+
+		explicit Reader(std::string_view in_text);
+
+		// Type of the next value, without consuming it
+		ValueType Peek();
+
+		bool BeginObject();
+		// Reads the next key of the open object, or closes it and returns false at '}'
+		bool NextKey(std::string& key);
+		bool BeginArray();
+		// Moves to the next element of the open array, or closes it and returns false at ']'
+		bool NextElement();
+
+		bool ReadString(std::string& out);
+		bool ReadBoolean(bool& out);
+		// False without an error when the number is valid JSON but not a `T` (a fraction or out of range)
+		template <std::integral T>
+		bool ReadInteger(T& out);
+		bool SkipValue();
+
+		// True when only whitespace follows the root value
+		bool AtEnd();
+
+		bool HasError() const;
+		// "<message> at byte <offset>", empty while no error occurred
+		const std::string& GetError() const;
+		// Records a syntax error at the current position; always returns false
+		bool Fail(std::string_view message);
+
+	private:
+		// Keys and strings are copied into `out` unless it is null (when skipping)
+		bool NextKey(std::string* key);
+		bool ScanString(std::string* out);
+		void SkipWhitespace();
+		bool Expect(char c);
+		bool ScanNumber(std::string_view& digits, bool& integral);
+		bool ReadEscape(std::string* out);
+		bool SkipValue(int depth);
+
+		std::string_view text;
+		std::size_t pos{0};
+		// Set right after '{' or '[' so the first key or element needs no comma
+		bool container_opened{false};
+		std::string error;
+	};
+
+	template <std::integral T>
+	bool Reader::ReadInteger(T& out)
+	{
+		std::string_view digits;
+		bool integral = true;
+		if (!ScanNumber(digits, integral))
+		{
+			return false;
+		}
+		if (!integral)
+		{
+			return false;
+		}
+
+		const auto result = std::from_chars(digits.data(), digits.data() + digits.size(), out);
+		return result.ec == std::errc{} && result.ptr == digits.data() + digits.size();
+	}
+} // namespace kanji::utils::json
@@ -0,0 +1,110 @@
+#include "json_writer.h"
+#include "utf8.h"
+#include <array>
+
+namespace kanji::utils::json
+{
+	namespace
+	{
+		enum ByteClass : unsigned char
+		{
+			PLAIN,
+			ESCAPE,
+			NON_ASCII
+		};
+
+		constexpr std::array<ByteClass, 256> MakeByteClasses()
+		{
+			std::array<ByteClass, 256> classes{};
+			for (int byte = 0; byte < 256; ++byte)
+			{
+				if (byte < 0x20 || byte == '"' || byte == '\\')
+				{
+					classes[byte] = ESCAPE;
+				}
+				else if (byte >= 0x80)
+				{
+					classes[byte] = NON_ASCII;
+				}
+			}
+			return classes;
+		}
+
+		constexpr std::array<ByteClass, 256> BYTE_CLASSES = MakeByteClasses();
+
+		void AppendEscape(std::string& out, unsigned char byte)
+		{
+			switch (byte)
+			{
+			case '"':
+				out += "\\\"";
+				break;
+			case '\\':
+				out += "\\\\";
+				break;
+			case '\b':
+				out += "\\b";
+				break;
+			case '\t':
+				out += "\\t";
+				break;
+			case '\n':
+				out += "\\n";
+				break;
+			case '\f':
+				out += "\\f";
+				break;
+			case '\r':
+				out += "\\r";
+				break;
+			default:
+			{
+				constexpr char HEX[] = "0123456789abcdef";
+				const char escape[] = {'\\', 'u', '0', '0', HEX[byte >> 4], HEX[byte & 0x0F]};
+				out.append(escape, sizeof(escape));
+				break;
+			}
+			}
+		}
+	} // namespace
+
+	void Writer::AppendEscaped(std::string& out, std::string_view text)
+	{
+		std::size_t i = 0;
+		while (i < text.size())
+		{
+			// Copy the longest run that needs no attention in one go
+			const std::size_t run_start = i;
+			while (i < text.size() && BYTE_CLASSES[static_cast<unsigned char>(text[i])] == PLAIN)
+			{
+				++i;
+			}
+			out.append(text.data() + run_start, i - run_start);
+			if (i == text.size())
+			{
+				break;
+			}
+
+			const auto byte = static_cast<unsigned char>(text[i]);
+			if (BYTE_CLASSES[byte] == ESCAPE)
+			{
+				AppendEscape(out, byte);
+				++i;
+				continue;
+			}
+
+			// Only a well-formed sequence decodes to more than one byte
+			std::size_t length = 1;
+			utf8::Decode(text, i, length);
+			if (length > 1)
+			{
+				out.append(text.data() + i, length);
+			}
+			else
+			{
+				out += "\xEF\xBF\xBD";
+			}
+			i += length;
+		}
+	}
+} // namespace kanji::utils::json
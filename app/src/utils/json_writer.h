@@ -0,0 +1,153 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+
+namespace kanji::utils::json
+{
+	// Streams JSON straight into a caller-owned buffer without building a DOM. The output is byte
+	// for byte what nlohmann::json::dump() produces for the same value, as long as objects write their
+	// keys in sorted order. Types outside the built-ins are written by an ADL-found
+	// `WriteJson(Writer&, const T&)`.
+	class Writer
+	{
+	public:
+		explicit Writer(std::string& in_buffer)
+		    : buffer{in_buffer}
+		{
+		}
+
+		void BeginObject()
+		{
+			Separate();
+			buffer += '{';
+			need_comma = false;
+		}
+
+		void EndObject()
+		{
+			buffer += '}';
+			need_comma = true;
+		}
+
+		void BeginArray()
+		{
+			Separate();
+			buffer += '[';
+			need_comma = false;
+		}
+
+		void EndArray()
+		{
+			buffer += ']';
+			need_comma = true;
+		}
+
+		// `key` is written as is, so it must not need escaping
+		void Key(std::string_view key)
+		{
+			Separate();
+			buffer += '"';
+			buffer += key;
+			buffer += "\":";
+			need_comma = false;
+		}
+
+		void Null()
+		{
+			Separate();
+			buffer += "null";
+			need_comma = true;
+		}
+
+		void String(std::string_view text)
+		{
+			Separate();
+			buffer += '"';
+			AppendEscaped(buffer, text);
+			buffer += '"';
+			need_comma = true;
+		}
+
+		template <std::integral T>
+		void Number(T value)
+		{
+			Separate();
+			char digits[24];
+			const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+			buffer.append(digits, result.ptr);
+			need_comma = true;
+		}
+
+		template <typename T>
+		void Write(const T& value)
+		{
+			if constexpr (std::same_as<T, bool>)
+			{
+				Separate();
+				buffer += value ? "true" : "false";
+				need_comma = true;
+			}
+			else if constexpr (std::integral<T>)
+			{
+				Number(value);
+			}
+			else if constexpr (std::convertible_to<const T&, std::string_view>)
+			{
+				String(value);
+			}
+			else if constexpr (requires { value.has_value(); *value; })
+			{
+				value ? Write(*value) : Null();
+			}
+			else if constexpr (std::ranges::input_range<T>)
+			{
+				BeginArray();
+				for (const auto& element : value)
+				{
+					Write(element);
+				}
+				EndArray();
+			}
+			else
+			{
+				WriteJson(*this, value);
+			}
+		}
+
+		template <typename T>
+		void Field(std::string_view key, const T& value)
+		{
+			Key(key);
+			Write(value);
+		}
+
+	private:
+		void Separate()
+		{
+			if (need_comma)
+			{
+				buffer += ',';
+			}
+		}
+
+		// Escapes like nlohmann::json::dump(); invalid UTF-8 becomes U+FFFD instead of throwing
+		static void AppendEscaped(std::string& out, std::string_view text);
+
+		std::string& buffer;
+		bool need_comma{false};
+	};
+
+	// Serializes `value` into `buffer`, replacing its contents but keeping its capacity
+	template <typename T>
+	void Dump(const T& value, std::string& buffer)
+	{
+		buffer.clear();
+		Writer writer{buffer};
+		writer.Write(value);
+	}
+} // namespace kanji::utils::json
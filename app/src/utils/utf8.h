@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace kanji::utils::utf8
+{
+	inline constexpr char32_t REPLACEMENT_CHARACTER = 0xFFFD;
+
+	// Decodes the sequence starting at text[i] and stores its length; malformed input yields
+	// REPLACEMENT_CHARACTER with a length of 1 so decoding always makes progress
+	inline char32_t Decode(std::string_view text, std::size_t i, std::size_t& length)
+	{
+		const auto byte = [&](std::size_t at) { return static_cast<unsigned char>(text[at]); };
+		const auto continuation = [&](std::size_t at) { return at < text.size() && (byte(at) & 0xC0) == 0x80; };
+
+		const unsigned char lead = byte(i);
+		length = 1;
+		if (lead < 0x80)
+		{
+			return lead;
+		}
+		if ((lead & 0xE0) == 0xC0 && lead >= 0xC2 && continuation(i + 1))
+		{
+			length = 2;
+			return ((lead & 0x1F) << 6) | (byte(i + 1) & 0x3F);
+		}
+		if ((lead & 0xF0) == 0xE0 && continuation(i + 1) && continuation(i + 2))
+		{
+			const char32_t codepoint = ((lead & 0x0F) << 12) | ((byte(i + 1) & 0x3F) << 6) | (byte(i + 2) & 0x3F);
+			// Overlong forms and UTF-16 surrogates are not valid scalar values
+			if (codepoint >= 0x800 && (codepoint < 0xD800 || codepoint > 0xDFFF))
+			{
+				length = 3;
+				return codepoint;
+			}
+			return REPLACEMENT_CHARACTER;
+		}
+		if ((lead & 0xF8) == 0xF0 && continuation(i + 1) && continuation(i + 2) && continuation(i + 3))
+		{
+			const char32_t codepoint = ((lead & 0x07) << 18) | ((byte(i + 1) & 0x3F) << 12) | ((byte(i + 2) & 0x3F) << 6) |
+			                           (byte(i + 3) & 0x3F);
+			if (codepoint >= 0x10000 && codepoint <= 0x10FFFF)
+			{
+				length = 4;
+				return codepoint;
+			}
+		}
+		return REPLACEMENT_CHARACTER;
+	}
+
+	// Calls visit(codepoint, byte_offset) for every non-ASCII codepoint. ASCII is skipped eight bytes
+	// at a time (SWAR), which is where most of the time goes on markup-heavy or mixed-script text.
+	template <typename Visit>
+	void ForEachNonAscii(std::string_view text, Visit&& visit)
+	{
+		constexpr std::uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+		std::size_t i = 0;
+		while (i < text.size())
+		{
+			if (i + sizeof(std::uint64_t) <= text.size())
+			{
+				std::uint64_t word;
+				std::memcpy(&word, text.data() + i, sizeof(word));
+				if ((word & HIGH_BITS) == 0)
+				{
+					i += sizeof(word);
+					continue;
+				}
+			}
+
+			if (static_cast<unsigned char>(text[i]) < 0x80)
+			{
+				++i;
+				continue;
+			}
+
+			std::size_t length = 1;
+			const char32_t codepoint = Decode(text, i, length);
+			visit(codepoint, i);
+			i += length;
+		}
+	}
+} // namespace kanji::utils::utf8
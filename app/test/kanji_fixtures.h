@@ -0,0 +1,57 @@
+#pragma once
+
+#include "database/storage.h"
+#include "kanji.h"
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Shape of the kanjis MakeKanjis builds
+struct KanjiSpec
+{
+	// Number of the first kanji, so batches can avoid repeating characters
+	int first = 0;
+	// The first word is "単語<number>", the rest "言葉<index>"
+	int examples = 2;
+	// Followed by the kanji's number
+	std::string meaning = "meaning ";
+};
+
+// `count` kanjis "字<number>" with ids left for the database to assign
+inline std::vector<kanji::KanjiData> MakeKanjis(int count, const KanjiSpec& spec = {})
+{
+	std::vector<kanji::KanjiData> kanjis;
+	kanjis.reserve(count);
+	for (int i = spec.first; i < spec.first + count; ++i)
+	{
+		kanji::KanjiData& entry = kanjis.emplace_back();
+		entry.kanji = "字" + std::to_string(i);
+		entry.meaning = spec.meaning + std::to_string(i);
+		for (int w = 0; w < spec.examples; ++w)
+		{
+			entry.examples.push_back(w == 0 ? kanji::KanjiWord{"単語" + std::to_string(i), "たんご"}
+			                                : kanji::KanjiWord{"言葉" + std::to_string(w), "ことば"});
+		}
+	}
+	return kanjis;
+}
+
+// Reads a GET /api/kanjis body back into records
+inline std::vector<kanji::KanjiRecord> ParseKanjis(std::string_view json)
+{
+	return nlohmann::json::parse(json).get<std::vector<kanji::KanjiRecord>>();
+}
+
+// Reads a paged GET /api/kanjis body back into records and the cursor of the next page
+inline kanji::database::KanjiPage ParseKanjiPage(std::string_view json)
+{
+	const auto parsed = nlohmann::json::parse(json);
+	kanji::database::KanjiPage page{parsed.at("kanjis").get<std::vector<kanji::KanjiRecord>>(), std::nullopt};
+	if (const auto& next = parsed.at("next_cursor"); next.is_string())
+	{
+		page.next = kanji::database::KanjiCursor::Parse(next.get<std::string>());
+	}
+	return page;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string>
+
+// Scratch database file that is removed (with its WAL/SHM/journal/snapshot side files) when the test ends.
+class TempDatabase
+{
+public:
+	TempDatabase()
+	{
+		static const unsigned int seed = std::random_device{}();
+		static std::atomic<int> counter{0};
+		path = std::filesystem::temp_directory_path() /
+		       ("kanji_test_" + std::to_string(seed) + "_" + std::to_string(counter++) + ".db");
+		Remove();
+	}
+
+	~TempDatabase()
+	{
+		Remove();
+	}
+
+	TempDatabase(const TempDatabase&) = delete;
+	TempDatabase& operator=(const TempDatabase&) = delete;
+
+	const std::filesystem::path& GetPath() const
+	{
+		return path;
+	}
+
+private:
+	void Remove()
+	{
+		std::error_code ec;
+		for (const char* suffix : {"", "-wal", "-shm", "-journal"})
+		{
+			std::filesystem::remove(path.string() + suffix, ec);
+		}
+		for (const char* extension : {".answers.log", ".answers.log.failed", ".catalog", ".catalog.tmp"})
+		{
+			std::filesystem::remove(std::filesystem::path{path}.replace_extension(extension), ec);
+		}
+	}
+
+	std::filesystem::path path;
+};
@@ -0,0 +1,120 @@
+#include "http/admission_control.h"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::http;
+using namespace std::chrono_literals;
+
+namespace
+{
+	config::AdmissionSettings Settings(double rate, int burst, int max_inflight)
+	{
+		config::AdmissionSettings settings;
+		settings.writes_per_second = rate;
+		settings.write_burst = burst;
+		settings.max_inflight_writes = max_inflight;
+		return settings;
+	}
+} // namespace
+
+TEST_CASE("Admission gives every user a burst, then the sustained rate", "[http][admission]")
+{
+	AdmissionController admission{Settings(2.0, 3, 100)};
+	const auto start = AdmissionController::Clock::now();
+
+	for (int i = 0; i < 3; ++i)
+	{
+		CHECK(admission.TryAdmit("alice", start).verdict == Admission::Admitted);
+		admission.Release();
+	}
+	const auto limited = admission.TryAdmit("alice", start);
+	CHECK(limited.verdict == Admission::RateLimited);
+	CHECK(limited.retry_after == 1s);
+
+	// Another user has a bucket of their own
+	CHECK(admission.TryAdmit("bob", start).verdict == Admission::Admitted);
+	admission.Release();
+
+	// Two tokens a second: one is back after half a second, a full burst after a second and a half
+	CHECK(admission.TryAdmit("alice", start + 500ms).verdict == Admission::Admitted);
+	admission.Release();
+	CHECK(admission.TryAdmit("alice", start + 600ms).verdict == Admission::RateLimited);
+	for (int i = 0; i < 3; ++i)
+	{
+		CHECK(admission.TryAdmit("alice", start + 10s).verdict == Admission::Admitted);
+		admission.Release();
+	}
+	CHECK(admission.TryAdmit("alice", start + 10s).verdict == Admission::RateLimited);
+
+	const auto stats = admission.GetStats();
+	CHECK(stats.admitted == 8);
+	CHECK(stats.rate_limited == 3);
+	CHECK(stats.overloaded == 0);
+	CHECK(stats.in_flight == 0);
+	CHECK(stats.tracked_users == 2);
+}
+
+TEST_CASE("Admission sheds writes beyond the in-flight cap", "[http][admission]")
+{
+	AdmissionController admission{Settings(100.0, 100, 2)};
+	const auto now = AdmissionController::Clock::now();
+
+	CHECK(admission.TryAdmit("alice", now).verdict == Admission::Admitted);
+	CHECK(admission.TryAdmit("bob", now).verdict == Admission::Admitted);
+	const auto shed = admission.TryAdmit("carol", now);
+	CHECK(shed.verdict == Admission::Overloaded);
+	CHECK(shed.retry_after == 1s);
+	CHECK(admission.GetStats().in_flight == 2);
+
+	// A finished write frees its slot
+	admission.Release();
+	CHECK(admission.TryAdmit("carol", now).verdict == Admission::Admitted);
+	CHECK(admission.GetStats().overloaded == 1);
+}
+
+TEST_CASE("Shed requests do not spend the user's tokens", "[http][admission]")
+{
+	AdmissionController admission{Settings(1.0, 1, 1)};
+	const auto now = AdmissionController::Clock::now();
+
+	CHECK(admission.TryAdmit("alice", now).verdict == Admission::Admitted);
+	for (int i = 0; i < 5; ++i)
+	{
+		CHECK(admission.TryAdmit("bob", now).verdict == Admission::Overloaded);
+	}
+	admission.Release();
+	CHECK(admission.TryAdmit("bob", now).verdict == Admission::Admitted);
+}
+
+TEST_CASE("Admission forgets users whose buckets have refilled", "[http][admission]")
+{
+	AdmissionController admission{Settings(10.0, 5, 1)};
+	const auto start = AdmissionController::Clock::now();
+
+	for (std::size_t i = 0; i < AdmissionController::MAX_TRACKED_USERS; ++i)
+	{
+		admission.TryAdmit("user" + std::to_string(i), start);
+		admission.Release();
+	}
+	CHECK(admission.GetStats().admitted == AdmissionController::MAX_TRACKED_USERS);
+	CHECK(admission.GetStats().tracked_users == AdmissionController::MAX_TRACKED_USERS);
+
+	// One more user tips the table over; everyone idle long enough to refill is dropped
+	CHECK(admission.TryAdmit("latecomer", start + 1s).verdict == Admission::Admitted);
+	CHECK(admission.GetStats().tracked_users == 1);
+}
+
+TEST_CASE("Only the database write routes are admission controlled", "[http][admission]")
+{
+	CHECK(IsWriteRoute("POST", "/api/answers"));
+	CHECK(IsWriteRoute("POST", "/api/learn-more"));
+	CHECK(IsWriteRoute("POST", "/api/kanjis"));
+
+	// Annotate is a read that happens to carry a body
+	CHECK_FALSE(IsWriteRoute("POST", "/api/annotate"));
+	CHECK_FALSE(IsWriteRoute("POST", "/api/login"));
+	CHECK_FALSE(IsWriteRoute("POST", "/api/admin/backup"));
+	CHECK_FALSE(IsWriteRoute("GET", "/api/kanjis"));
+	CHECK_FALSE(IsWriteRoute("GET", "/api/reviews"));
+}
@@ -0,0 +1,129 @@
+#include "database/answer_journal.h"
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "database/review_state_repository.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+#include <sqlite3.h>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::database;
+
+namespace
+{
+	config::WriteBehindSettings ManualFlushSettings()
+	{
+		// Long interval so only explicit Flush() calls reach the database
+		return {true, 60'000, 500, config::FsyncPolicy::Never};
+	}
+
+	std::filesystem::path JournalPath(const TempDatabase& temp)
+	{
+		return std::filesystem::path{temp.GetPath()}.replace_extension(".answers.log");
+	}
+
+	int LevelOf(ReviewStateRepository& repo, std::uint32_t kanji_id)
+	{
+		const auto states = repo.GetReviewStates({kanji_id});
+		return states.empty() ? -1 : states.front().level;
+	}
+} // namespace
+
+TEST_CASE("AnswerJournal commits appended states on Flush", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	const auto ids = kanji_repo.BatchInsertKanjis({{0, "一", "one", {}}, {0, "二", "two", {}}});
+	REQUIRE(ids.size() == 2);
+
+	AnswerJournal journal{JournalPath(temp), ManualFlushSettings(), review_repo};
+	REQUIRE(journal.Open());
+
+	const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+	REQUIRE(journal.Append({{ids[0], 1, now, now}}));
+	REQUIRE(journal.Append({{ids[0], 2, now, now}, {ids[1], 3, now, now}}));
+	CHECK(journal.GetStats().queue_depth == 2);
+	CHECK(LevelOf(review_repo, ids[0]) == 0);
+
+	journal.Flush();
+	CHECK(LevelOf(review_repo, ids[0]) == 2);
+	CHECK(LevelOf(review_repo, ids[1]) == 3);
+
+	const auto stats = journal.GetStats();
+	CHECK(stats.queue_depth == 0);
+	CHECK(stats.commits == 1);
+	CHECK(stats.committed_states == 2);
+	CHECK(std::filesystem::file_size(JournalPath(temp)) == 0);
+}
+
+TEST_CASE("AnswerJournal replays records left by a previous run", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	const auto ids = kanji_repo.BatchInsertKanjis({{0, "一", "one", {}}, {0, "二", "two", {}}});
+	REQUIRE(ids.size() == 2);
+
+	{
+		std::ofstream out{JournalPath(temp), std::ios::binary};
+		out << ids[0] << " 4 1700000000\n";
+		// Torn final record from a crash mid-write
+		out << ids[1] << " 5 17";
+	}
+
+	AnswerJournal journal{JournalPath(temp), ManualFlushSettings(), review_repo};
+	REQUIRE(journal.Open());
+
+	CHECK(LevelOf(review_repo, ids[0]) == 4);
+	CHECK(LevelOf(review_repo, ids[1]) == 0);
+	CHECK(std::filesystem::file_size(JournalPath(temp)) == 0);
+}
+
+TEST_CASE("AnswerJournal moves a journal that failed to replay aside", "[database]")
+{
+	TempDatabase temp;
+	config::DatabaseSettings settings;
+	// Fail at once instead of waiting out the lock held below
+	settings.busy_timeout_ms = 0;
+	ConnectionPool pool{temp.GetPath(), settings};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	const auto ids = kanji_repo.BatchInsertKanjis({{0, "一", "one", {}}});
+	REQUIRE(ids.size() == 1);
+
+	{
+		std::ofstream out{JournalPath(temp), std::ios::binary};
+		out << ids[0] << " 4 1700000000\n";
+	}
+
+	// Another writer holds the database, so the replay fails
+	sqlite3* blocker = nullptr;
+	REQUIRE(sqlite3_open(temp.GetPath().string().c_str(), &blocker) == SQLITE_OK);
+	REQUIRE(sqlite3_exec(blocker, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr) == SQLITE_OK);
+	{
+		AnswerJournal journal{JournalPath(temp), ManualFlushSettings(), review_repo};
+		CHECK_FALSE(journal.Open());
+	}
+	sqlite3_exec(blocker, "ROLLBACK;", nullptr, nullptr, nullptr);
+	sqlite3_close(blocker);
+
+	CHECK_FALSE(std::filesystem::exists(JournalPath(temp)));
+	CHECK(std::filesystem::exists(std::filesystem::path{JournalPath(temp)} += ".failed"));
+
+	// Answers go straight to the database while the journal is unavailable
+	const auto now = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+	REQUIRE(review_repo.SaveReviewStates({{ids[0], 6, now, now}}));
+
+	// The next start must not roll that answer back to the stale journal
+	AnswerJournal restarted{JournalPath(temp), ManualFlushSettings(), review_repo};
+	REQUIRE(restarted.Open());
+	CHECK(LevelOf(review_repo, ids[0]) == 6);
+}
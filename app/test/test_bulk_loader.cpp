@@ -0,0 +1,116 @@
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "importer/bulk_loader.h"
+#include "importer/dictionary_parser.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+#include <sstream>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::importer;
+
+namespace
+{
+	int CountIndexes(sqlite3* db)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		sqlite3_prepare_v2(db, "SELECT count(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_%';", -1,
+		                   &stmt, nullptr);
+		const int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+		sqlite3_finalize(stmt);
+		return count;
+	}
+} // namespace
+
+TEST_CASE("Dictionary parsers read JSON lines and KANJIDIC characters", "[importer]")
+{
+	std::string error;
+
+	const auto line = ParseJsonLine(R"({"kanji": "日", "meaning": "day", "examples": [{"word": "日本", "reading": "にほん"}]})", error);
+	REQUIRE(line);
+	CHECK(line->kanji == "日");
+	CHECK(line->examples.size() == 1);
+
+	CHECK_FALSE(ParseJsonLine(R"({"meaning": "no kanji"})", error));
+	CHECK_FALSE(ParseJsonLine("not json", error));
+
+	const auto character = ParseKanjidicCharacter(
+	    "<character><literal>日</literal><reading_meaning><rmgroup>"
+	    "<reading r_type=\"pinyin\">ri4</reading><reading r_type=\"ja_on\">ニチ</reading>"
+	    "<reading r_type=\"ja_kun\">ひ</reading><meaning>day</meaning><meaning>sun &amp; Japan</meaning>"
+	    "<meaning m_lang=\"fr\">jour</meaning></rmgroup></reading_meaning></character>",
+	    error);
+	REQUIRE(character);
+	CHECK(character->kanji == "日");
+	CHECK(character->meaning == "day, sun & Japan");
+	REQUIRE(character->examples.size() == 2);
+	CHECK(character->examples[0].reading == "ニチ");
+
+	CHECK_FALSE(ParseKanjidicCharacter("<character><meaning>x</meaning></character>", error));
+}
+
+TEST_CASE("BulkLoader inserts dumps in input order and restores indexes", "[importer][database]")
+{
+	TempDatabase temp;
+	database::ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	database::KanjiRepository repo{pool};
+
+	SECTION("JSON lines")
+	{
+		std::string dump;
+		for (int i = 0; i < 50; ++i)
+		{
+			dump += R"({"kanji": "字)" + std::to_string(i) + R"(", "meaning": "m"})" "\n";
+		}
+		dump += "{broken\n\n";
+
+		std::istringstream input{dump};
+		const auto report = BulkLoader{pool, {DumpFormat::JsonLines, 7, 3, 16}}.Load(input);
+		CHECK(report.records == 51);
+		CHECK(report.inserted == 50);
+		CHECK(report.rejected == 1);
+		CHECK(report.chunks == 8);
+
+		const auto kanjis = repo.GetKanjis();
+		REQUIRE(kanjis.size() == 50);
+		for (const auto& kanji : kanjis)
+		{
+			CHECK(kanji.kanji == "字" + std::to_string(kanji.id - 1));
+		}
+	}
+
+	SECTION("KANJIDIC XML")
+	{
+		std::istringstream input{"<?xml version=\"1.0\"?>\n<kanjidic2>\n<header><file_version>4</file_version></header>\n"
+		                         "<character>\n<literal>一</literal>\n<meaning>one</meaning>\n</character>\n"
+		                         "<character><literal>二</literal><meaning>two</meaning></character>\n</kanjidic2>\n"};
+		const auto report = BulkLoader{pool, {DumpFormat::Kanjidic, 1, 2, 16}}.Load(input);
+		CHECK(report.inserted == 2);
+		CHECK(report.chunks == 2);
+		CHECK(repo.GetKanjis().size() == 2);
+	}
+
+	auto writer = pool.AcquireWriter();
+	CHECK(CountIndexes(writer) == 2);
+}
+
+TEST_CASE("Opening a database recreates indexes an interrupted bulk load dropped", "[importer][database]")
+{
+	TempDatabase temp;
+	{
+		database::ConnectionPool pool{temp.GetPath()};
+		REQUIRE(pool.Initialize());
+		auto writer = pool.AcquireWriter();
+		REQUIRE(sqlite3_exec(writer, "DROP INDEX idx_review_state_due; DROP INDEX idx_kanji_words_kanji;", nullptr,
+		                     nullptr, nullptr) == SQLITE_OK);
+		CHECK(CountIndexes(writer) == 0);
+	}
+
+	database::ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	auto writer = pool.AcquireWriter();
+	CHECK(CountIndexes(writer) == 2);
+}
@@ -0,0 +1,152 @@
+#include "catalog/catalog_snapshot.h"
+#include "controller.h"
+#include "database/database_context.h"
+#include "kanji_fixtures.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <fstream>
+#include <sqlite3.h>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::catalog;
+
+namespace
+{
+	void FlipByte(const std::filesystem::path& path, std::streamoff offset)
+	{
+		std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+		file.seekg(offset);
+		char byte = 0;
+		file.get(byte);
+		file.seekp(offset);
+		file.put(static_cast<char>(byte ^ 0x5a));
+	}
+} // namespace
+
+TEST_CASE("CatalogSnapshot round-trips and rejects stale or corrupt files", "[catalog]")
+{
+	TempDatabase temp;
+	const auto path = std::filesystem::path{temp.GetPath()}.replace_extension(".catalog");
+
+	KanjiCatalog::Builder builder;
+	for (std::uint32_t id = 1; id <= 20; ++id)
+	{
+		builder.Add(id, MakeKanjis(20)[id - 1]);
+	}
+	const auto original = builder.Build();
+	REQUIRE(CatalogSnapshot::Save(*original, path, 42));
+
+	const auto mapped = CatalogSnapshot::Load(path, 42);
+	REQUIRE(mapped);
+	REQUIRE(mapped->Size() == original->Size());
+	for (std::uint32_t id = 1; id <= 20; ++id)
+	{
+		const auto expected = original->ToKanjiData(*original->Find(id));
+		const auto actual = mapped->ToKanjiData(*mapped->Find(id));
+		CHECK(actual.kanji == expected.kanji);
+		CHECK(actual.meaning == expected.meaning);
+		REQUIRE(actual.examples.size() == expected.examples.size());
+		CHECK(actual.examples[0].word == expected.examples[0].word);
+	}
+
+	CHECK_FALSE(CatalogSnapshot::Load(path, 43));
+
+	SECTION("corrupt payload")
+	{
+		FlipByte(path, static_cast<std::streamoff>(std::filesystem::file_size(path)) - 3);
+		CHECK_FALSE(CatalogSnapshot::Load(path, 42));
+	}
+
+	SECTION("truncated file")
+	{
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+		CHECK_FALSE(CatalogSnapshot::Load(path, 42));
+	}
+
+	SECTION("missing file")
+	{
+		std::filesystem::remove(path);
+		CHECK_FALSE(CatalogSnapshot::Load(path, 42));
+	}
+}
+
+TEST_CASE("Controller writes a snapshot that the next startup maps", "[catalog][database]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	const auto snapshot_path = db.GetCatalogSnapshotPath();
+
+	{
+		Controller controller{db, std::make_unique<scheduler::WaniKaniScheduler>(),
+		                      std::make_shared<catalog::CatalogStore>(db, snapshot_path)};
+		controller.BatchAddKanjis(MakeKanjis(30));
+	}
+
+	const auto fingerprint = db.GetKanjiRepository().GetCatalogFingerprint();
+	const auto mapped = CatalogSnapshot::Load(snapshot_path, fingerprint);
+	REQUIRE(mapped);
+	CHECK(mapped->Size() == 30);
+
+	// Rows added behind the controller's back make the snapshot stale
+	db.GetKanjiRepository().BatchInsertKanjis(MakeKanjis(1));
+	CHECK_FALSE(CatalogSnapshot::Load(snapshot_path, db.GetKanjiRepository().GetCatalogFingerprint()));
+
+	Controller restarted{db, std::make_unique<scheduler::WaniKaniScheduler>(),
+	                     std::make_shared<catalog::CatalogStore>(db, snapshot_path)};
+	CHECK(restarted.GetCatalogStats().kanjis == 31);
+	CHECK(CatalogSnapshot::Load(snapshot_path, db.GetKanjiRepository().GetCatalogFingerprint()));
+}
+
+TEST_CASE("Edits that keep counts and ids make the snapshot stale", "[catalog][database]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	auto& repo = db.GetKanjiRepository();
+	repo.BatchInsertKanjis(MakeKanjis(3));
+	const auto snapshot_path = db.GetCatalogSnapshotPath();
+
+	const auto edit = [&](const char* sql) {
+		REQUIRE(CatalogSnapshot::Save(*repo.LoadCatalog(), snapshot_path, repo.GetCatalogFingerprint()));
+		REQUIRE(CatalogSnapshot::Load(snapshot_path, repo.GetCatalogFingerprint()));
+		// Behind the server's back, the way a maintenance script would
+		sqlite3* editor = nullptr;
+		REQUIRE(sqlite3_open(temp.GetPath().string().c_str(), &editor) == SQLITE_OK);
+		CHECK(sqlite3_exec(editor, sql, nullptr, nullptr, nullptr) == SQLITE_OK);
+		sqlite3_close(editor);
+	};
+
+	edit("UPDATE kanjis SET meaning = 'edited' WHERE id = 2;");
+	CHECK_FALSE(CatalogSnapshot::Load(snapshot_path, repo.GetCatalogFingerprint()));
+
+	edit("UPDATE kanji_words SET reading = 'edited' WHERE id = 1;");
+	CHECK_FALSE(CatalogSnapshot::Load(snapshot_path, repo.GetCatalogFingerprint()));
+
+	// Same count and highest id afterwards
+	edit("DELETE FROM kanjis WHERE id = 1; INSERT INTO kanjis (id, kanji, meaning) VALUES (1, '新', 'new');");
+	CHECK_FALSE(CatalogSnapshot::Load(snapshot_path, repo.GetCatalogFingerprint()));
+}
+
+TEST_CASE("Catalog startup: SQLite vs mapped snapshot, 50k kanjis", "[.benchmark][catalog]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	auto& repo = db.GetKanjiRepository();
+	repo.BatchInsertKanjis(MakeKanjis(50'000));
+
+	const auto snapshot_path = db.GetCatalogSnapshotPath();
+	const auto fingerprint = repo.GetCatalogFingerprint();
+	REQUIRE(CatalogSnapshot::Save(*repo.LoadCatalog(), snapshot_path, fingerprint));
+
+	BENCHMARK("SQLite LoadCatalog")
+	{
+		return repo.LoadCatalog();
+	};
+
+	BENCHMARK("Mapped snapshot")
+	{
+		return CatalogSnapshot::Load(snapshot_path, repo.GetCatalogFingerprint());
+	};
+}
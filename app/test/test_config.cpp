@@ -0,0 +1,64 @@
+#include "config.h"
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using namespace kanji;
+
+namespace
+{
+	struct TempConfig
+	{
+		explicit TempConfig(const nlohmann::json& contents)
+		    : path{std::filesystem::temp_directory_path() / "kanji_test_config.json"}
+		{
+			std::ofstream{path} << contents.dump();
+		}
+
+		~TempConfig()
+		{
+			std::error_code ec;
+			std::filesystem::remove(path, ec);
+		}
+
+		std::filesystem::path path;
+	};
+
+	nlohmann::json MinimalConfig()
+	{
+		return {{"notification", {{"refresh_interval", 30}, {"telegram", {{"bot_token", "token"}, {"chat_id", 42}}}}},
+		        {"auth", {{"jwt_secret", "secret"}, {"token_expiry_hours", 24}}}};
+	}
+} // namespace
+
+TEST_CASE("Config defaults only the tuning blocks", "[config]")
+{
+	TempConfig file{MinimalConfig()};
+	const auto config = config::KanjiAppConfig::LoadFromFile(file.path);
+	CHECK(config.notification.telegram.chat_id == 42);
+	CHECK(config.database.wal_mode);
+	CHECK(config.admission.enabled);
+}
+
+TEST_CASE("Config refuses to start without Telegram or auth settings", "[config]")
+{
+	auto without_notification = MinimalConfig();
+	without_notification.erase("notification");
+	auto without_auth = MinimalConfig();
+	without_auth.erase("auth");
+	// An empty bot token keys login verification with a hash anyone can compute
+	auto empty_token = MinimalConfig();
+	empty_token["notification"]["telegram"]["bot_token"] = "";
+	auto zero_chat = MinimalConfig();
+	zero_chat["notification"]["telegram"]["chat_id"] = 0;
+	auto empty_secret = MinimalConfig();
+	empty_secret["auth"]["jwt_secret"] = "";
+
+	for (const auto& contents : {without_notification, without_auth, empty_token, zero_chat, empty_secret})
+	{
+		TempConfig file{contents};
+		CHECK_THROWS(config::KanjiAppConfig::LoadFromFile(file.path));
+	}
+}
@@ -0,0 +1,87 @@
+#include "database/connection_pool.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+
+using namespace kanji::database;
+
+namespace
+{
+	std::string QueryText(sqlite3* db, const char* sql)
+	{
+		sqlite3_stmt* stmt = nullptr;
+		sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+		std::string result;
+		if (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			result = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+		}
+		sqlite3_finalize(stmt);
+		return result;
+	}
+} // namespace
+
+TEST_CASE("Connection pool runs in WAL mode with read-only readers", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+
+	REQUIRE(QueryText(pool.AcquireWriter(), "PRAGMA journal_mode;") == "wal");
+
+	auto reader = pool.AcquireReader();
+	REQUIRE(sqlite3_db_readonly(reader, "main") == 1);
+	REQUIRE(sqlite3_exec(reader, "INSERT INTO kanjis (kanji, meaning) VALUES ('a', 'b');", nullptr, nullptr, nullptr) != SQLITE_OK);
+}
+
+TEST_CASE("Connection pool gives each thread its own reader", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+
+	const SQLiteConnection* main_reader = &*pool.AcquireReader();
+	REQUIRE(&*pool.AcquireReader() == main_reader);
+
+	const SQLiteConnection* other_reader = nullptr;
+	std::thread{[&] { other_reader = &*pool.AcquireReader(); }}.join();
+	REQUIRE(other_reader != nullptr);
+	REQUIRE(other_reader != main_reader);
+}
+
+TEST_CASE("Connection pool readers see committed writes and the writer sees its own", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_exec(writer, "BEGIN; INSERT INTO kanjis (kanji, meaning) VALUES ('水', 'water');", nullptr, nullptr, nullptr);
+
+		// Inside the write the same thread reads through the writer
+		REQUIRE(QueryText(pool.AcquireReader(), "SELECT count(*) FROM kanjis;") == "1");
+
+		std::string other_count;
+		std::thread{[&] { other_count = QueryText(pool.AcquireReader(), "SELECT count(*) FROM kanjis;"); }}.join();
+		REQUIRE(other_count == "0");
+
+		sqlite3_exec(writer, "COMMIT;", nullptr, nullptr, nullptr);
+	}
+
+	REQUIRE(QueryText(pool.AcquireReader(), "SELECT count(*) FROM kanjis;") == "1");
+}
+
+TEST_CASE("Connection pool falls back to the writer beyond max_readers", "[database]")
+{
+	TempDatabase temp;
+	kanji::config::DatabaseSettings settings;
+	settings.max_readers = 0;
+	ConnectionPool pool{temp.GetPath(), settings};
+	REQUIRE(pool.Initialize());
+
+	auto reader = pool.AcquireReader();
+	REQUIRE(sqlite3_db_readonly(reader, "main") == 0);
+}
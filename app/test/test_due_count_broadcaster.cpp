@@ -0,0 +1,152 @@
+#include "controller.h"
+#include "database/memory_storage.h"
+#include "kanji_fixtures.h"
+#include "notification/due_count_broadcaster.h"
+#include "scheduler/wanikani_scheduler.h"
+#include <catch2/catch_test_macros.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace kanji;
+using namespace kanji::notification;
+
+namespace
+{
+	// Collects what the broadcaster sends to one stream
+	class Inbox
+	{
+	public:
+		DueCountBroadcaster::Send Sink()
+		{
+			return [this](const std::string& message) {
+				std::lock_guard lock{mutex};
+				messages.push_back(message);
+				arrived.notify_all();
+			};
+		}
+
+		// Waits until `message` has arrived, at most a few seconds
+		bool WaitFor(const std::string& message)
+		{
+			std::unique_lock lock{mutex};
+			return arrived.wait_for(lock, std::chrono::seconds{5},
+			                        [&] { return std::ranges::find(messages, message) != messages.end(); });
+		}
+
+		std::vector<std::string> Take()
+		{
+			std::lock_guard lock{mutex};
+			return std::exchange(messages, {});
+		}
+
+	private:
+		std::mutex mutex;
+		std::condition_variable arrived;
+		std::vector<std::string> messages;
+	};
+
+	// Storage with `due` of its kanjis overdue for review and the rest due tomorrow
+	void SeedDueReviews(database::MemoryStorage& storage, std::uint32_t kanjis, std::uint32_t due)
+	{
+		Controller seeder{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+		seeder.BatchAddKanjis(MakeKanjis(static_cast<int>(kanjis), {.examples = 0}));
+		const auto now = std::chrono::system_clock::now();
+		std::vector<KanjiReviewState> states;
+		for (std::uint32_t id = 1; id <= kanjis; ++id)
+		{
+			const auto date = id <= due ? now - std::chrono::hours{1} : now + std::chrono::hours{24};
+			states.push_back({id, 2, date, now});
+		}
+		REQUIRE(storage.GetReviewStateRepository().SaveReviewStates(states));
+	}
+} // namespace
+
+TEST_CASE("Due-count streams get the count on subscribe and after writes", "[notification]")
+{
+	database::MemoryStorage storage;
+	SeedDueReviews(storage, 10, 5);
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	DueCountBroadcaster broadcaster{std::chrono::hours{1}};
+	broadcaster.Start();
+
+	Inbox first;
+	Inbox second;
+	const auto first_id = broadcaster.Subscribe(controller, nullptr, first.Sink());
+	broadcaster.Subscribe(controller, nullptr, second.Sink());
+	CHECK(first.Take() == std::vector<std::string>{R"({"type":"due","count":5})"});
+	CHECK(second.Take() == std::vector<std::string>{R"({"type":"due","count":5})"});
+	CHECK(broadcaster.GetStreamCount() == 2);
+
+	// A correct answer moves the review into the future
+	controller.SetAnswers({{1, 0}, {2, 0}});
+	broadcaster.Notify();
+	CHECK(first.WaitFor(R"({"type":"due","count":3})"));
+	CHECK(second.WaitFor(R"({"type":"due","count":3})"));
+
+	SECTION("Unchanged counts are not resent")
+	{
+		first.Take();
+		broadcaster.Notify();
+		broadcaster.Unsubscribe(first_id);
+		controller.SetAnswers({{3, 0}});
+		broadcaster.Notify();
+		CHECK(second.WaitFor(R"({"type":"due","count":2})"));
+		CHECK(first.Take().empty());
+		CHECK(broadcaster.GetStreamCount() == 1);
+	}
+}
+
+TEST_CASE("Due-count streams hear about reviews falling due without any write", "[notification]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	DueCountBroadcaster broadcaster{std::chrono::hours{1}};
+	broadcaster.Start();
+	Inbox inbox;
+	broadcaster.Subscribe(controller, nullptr, inbox.Sink());
+	CHECK(inbox.WaitFor(R"({"type":"due","count":0})"));
+
+	// New kanjis are due from the current second on, so they count once it has passed
+	controller.BatchAddKanjis(MakeKanjis(4, {.examples = 0}));
+	broadcaster.Notify();
+	CHECK(inbox.WaitFor(R"({"type":"due","count":4})"));
+}
+
+TEST_CASE("Due-count streams get heartbeats", "[notification]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	DueCountBroadcaster broadcaster{std::chrono::milliseconds{20}};
+	broadcaster.Start();
+	Inbox inbox;
+	const auto id = broadcaster.Subscribe(controller, nullptr, inbox.Sink());
+	CHECK(inbox.WaitFor(R"({"type":"heartbeat"})"));
+
+	broadcaster.Unsubscribe(id);
+	CHECK(broadcaster.GetStreamCount() == 0);
+	// Unknown ids are ignored
+	broadcaster.Unsubscribe(id);
+}
+
+TEST_CASE("Due-count streams keep their owner alive until the last one leaves", "[notification]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+	DueCountBroadcaster broadcaster;
+
+	auto owner = std::make_shared<int>(7);
+	std::weak_ptr<int> watch = owner;
+	Inbox inbox;
+	const auto a = broadcaster.Subscribe(controller, std::move(owner), inbox.Sink());
+	const auto b = broadcaster.Subscribe(controller, nullptr, inbox.Sink());
+
+	broadcaster.Unsubscribe(a);
+	CHECK_FALSE(watch.expired());
+	broadcaster.Unsubscribe(b);
+	CHECK(watch.expired());
+}
@@ -0,0 +1,303 @@
+#include "controller.h"
+#include "database/database_context.h"
+#include "kanji_fixtures.h"
+#include "scheduler/due_queue.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <algorithm>
+#include <atomic>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <map>
+#include <random>
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+
+using namespace kanji;
+using namespace kanji::scheduler;
+
+namespace
+{
+	std::chrono::system_clock::time_point At(std::int64_t seconds)
+	{
+		return std::chrono::system_clock::from_time_t(seconds);
+	}
+
+	std::vector<KanjiReviewState> MakeStates(std::uint32_t count, std::int64_t base)
+	{
+		std::vector<KanjiReviewState> states;
+		for (std::uint32_t id = 1; id <= count; ++id)
+		{
+			states.push_back({id, 1, At(base + id % 97), At(0)});
+		}
+		return states;
+	}
+} // namespace
+
+TEST_CASE("DueQueue orders by review date then kanji id", "[due_queue]")
+{
+	DueQueue queue;
+	queue.Load({{3, 1, At(100), At(0)}, {1, 1, At(200), At(0)}, {2, 1, At(100), At(0)}, {4, 1, At(900), At(0)}});
+
+	REQUIRE(queue.GetDue(At(300), 10) == std::vector<std::uint32_t>{2, 3, 1});
+	REQUIRE(queue.GetDue(At(300), 2) == std::vector<std::uint32_t>{2, 3});
+	REQUIRE(queue.GetDue(At(100), 10).empty());
+	REQUIRE(queue.CountDue(At(300)) == 3);
+	REQUIRE(queue.CountDue(At(1000)) == 4);
+}
+
+TEST_CASE("DueQueue knows when its due count next grows", "[due_queue]")
+{
+	DueQueue queue;
+	REQUIRE_FALSE(queue.GetNextDueTime(At(0)));
+
+	queue.Load({{1, 1, At(100), At(0)}, {2, 1, At(200), At(0)}});
+	// A review counts once its second has passed
+	REQUIRE(queue.GetNextDueTime(At(50)) == At(101));
+	REQUIRE(queue.CountDue(At(100)) == 0);
+	REQUIRE(queue.CountDue(At(101)) == 1);
+	REQUIRE(queue.GetNextDueTime(At(101)) == At(201));
+	REQUIRE_FALSE(queue.GetNextDueTime(At(201)));
+}
+
+TEST_CASE("DueQueue updates move entries", "[due_queue]")
+{
+	DueQueue queue;
+	queue.Load({{1, 1, At(100), At(0)}, {2, 1, At(200), At(0)}});
+
+	queue.Update({{1, 2, At(500), At(0)}, {3, 0, At(50), At(0)}});
+
+	REQUIRE(queue.Size() == 3);
+	REQUIRE(queue.GetDue(At(1000), 10) == std::vector<std::uint32_t>{3, 2, 1});
+	REQUIRE(queue.Find(1)->level == 2);
+	REQUIRE_FALSE(queue.Find(42).has_value());
+}
+
+TEST_CASE("DueQueue selection matches the SQLite due query", "[due_queue][database]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	db.GetKanjiRepository().BatchInsertKanjis(MakeKanjis(50, {.examples = 1}));
+
+	// Every kanji already due, several sharing a second, so neither path depends on the wall clock
+	const auto past = std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()) - std::chrono::hours{1};
+	std::vector<KanjiReviewState> backdated;
+	for (std::uint32_t id = 1; id <= 50; ++id)
+	{
+		backdated.push_back({id, 0, past - std::chrono::seconds{id % 7}, past});
+	}
+	REQUIRE(db.GetReviewStateRepository().SaveReviewStates(backdated));
+	Controller controller{db, std::make_unique<WaniKaniScheduler>()};
+
+	// Push half of the deck into the future with random answers
+	std::mt19937 rng{42};
+	std::vector<KanjiAnswer> answers;
+	for (std::uint32_t id = 1; id <= 50; id += 2)
+	{
+		answers.push_back({id, static_cast<int>(rng() % 3)});
+	}
+	controller.SetAnswers(answers);
+
+	const auto from_sqlite = db.GetKanjiRepository().GetKanjiForReview();
+	const auto from_queue = controller.GetReviewKanjis();
+	REQUIRE(from_queue.size() == from_sqlite.size());
+	for (size_t i = 0; i < from_queue.size(); ++i)
+	{
+		REQUIRE(from_queue[i].id == from_sqlite[i].id);
+		REQUIRE(from_queue[i].examples.size() == from_sqlite[i].examples.size());
+	}
+	REQUIRE(controller.CountDueReviews() == 25);
+}
+
+TEST_CASE("DueQueue updates collapse repeated kanjis and leave old snapshots untouched", "[due_queue]")
+{
+	DueQueue queue;
+	queue.Load({{1, 1, At(100), At(0)}, {2, 1, At(200), At(0)}});
+	const auto before = queue.GetSnapshot();
+
+	queue.Update({{2, 2, At(50), At(0)}, {5, 0, At(10), At(0)}, {2, 3, At(300), At(0)}});
+
+	CHECK(queue.Size() == 3);
+	CHECK(queue.GetDue(At(1000), 10) == std::vector<std::uint32_t>{5, 1, 2});
+	CHECK(queue.Find(2)->level == 3);
+	CHECK_FALSE(queue.Find(3).has_value());
+	CHECK_FALSE(queue.Find(0).has_value());
+
+	CHECK(before->Size() == 2);
+	CHECK(before->GetDue(At(1000), 10) == std::vector<std::uint32_t>{1, 2});
+	CHECK(before->Find(2)->level == 1);
+}
+
+TEST_CASE("DueQueue chunks split and fold without losing order", "[due_queue]")
+{
+	// Enough kanjis for several chunks and pages, moved around in batches of every size
+	constexpr std::uint32_t KANJI_COUNT = 5 * DueQueue::CHUNK_SIZE;
+	std::mt19937 random{7};
+	std::uniform_int_distribution<std::uint32_t> pick_id{1, KANJI_COUNT};
+	std::uniform_int_distribution<std::int64_t> pick_date{0, 300};
+
+	DueQueue queue;
+	std::map<std::uint32_t, std::int64_t> expected;
+	queue.Load({});
+	for (int round = 0; round < 200; ++round)
+	{
+		std::vector<KanjiReviewState> batch;
+		// Mostly small answer batches, now and then one that lands many keys in a single chunk
+		const std::size_t batch_size = round % 25 == 0 ? 3 * DueQueue::CHUNK_SIZE : 1 + round % 20;
+		for (std::size_t i = 0; i < batch_size; ++i)
+		{
+			const std::uint32_t id = pick_id(random);
+			const std::int64_t date = round % 50 == 0 ? 500 : pick_date(random);
+			batch.push_back({id, round, At(date), At(0)});
+			expected[id] = date;
+		}
+		queue.Update(batch);
+	}
+
+	std::vector<DueQueue::Key> order;
+	for (const auto& [id, date] : expected)
+	{
+		order.emplace_back(date, id);
+	}
+	std::sort(order.begin(), order.end());
+
+	std::vector<DueQueue::Key> walked;
+	queue.ForEach(std::nullopt, [&](const KanjiReviewState& state) {
+		walked.emplace_back(std::chrono::system_clock::to_time_t(state.next_review_date), state.kanji_id);
+		return true;
+	});
+	REQUIRE(walked == order);
+	CHECK(queue.Size() == order.size());
+
+	for (const std::int64_t now : {0, 1, 150, 300, 301, 501})
+	{
+		const auto due = std::lower_bound(order.begin(), order.end(), DueQueue::Key{now, 0});
+		CHECK(queue.CountDue(At(now)) == static_cast<std::size_t>(due - order.begin()));
+	}
+
+	// Resuming after any key continues with the next one
+	for (std::size_t i = 0; i + 1 < order.size(); i += 97)
+	{
+		std::optional<DueQueue::Key> next;
+		queue.ForEach(order[i], [&](const KanjiReviewState& state) {
+			next = DueQueue::Key{std::chrono::system_clock::to_time_t(state.next_review_date), state.kanji_id};
+			return false;
+		});
+		CHECK(next == order[i + 1]);
+	}
+
+	std::size_t misplaced = 0;
+	for (std::uint32_t id = 1; id <= KANJI_COUNT; ++id)
+	{
+		const auto state = queue.Find(id);
+		misplaced += state.has_value() != expected.contains(id) ||
+		             (state && std::chrono::system_clock::to_time_t(state->next_review_date) != expected[id]);
+	}
+	CHECK(misplaced == 0);
+}
+
+TEST_CASE("DueQueue readers see whole updates while writers publish", "[due_queue]")
+{
+	constexpr std::uint32_t KANJI_COUNT = 2000;
+	DueQueue queue;
+	queue.Load(MakeStates(KANJI_COUNT, 1000));
+
+	// Every update moves all kanjis together, so a reader must never see two different bases
+	std::atomic<bool> done{false};
+	std::thread writer{[&] {
+		for (std::int64_t round = 1; round <= 50; ++round)
+		{
+			queue.Update(MakeStates(KANJI_COUNT, 1000 + round * 1000));
+		}
+		done = true;
+	}};
+
+	std::size_t torn = 0;
+	std::size_t reads = 0;
+	while (!done || reads == 0)
+	{
+		std::size_t visited = 0;
+		std::int64_t base = -1;
+		queue.ForEach(std::nullopt, [&](const KanjiReviewState& state) {
+			const std::int64_t state_base = std::chrono::system_clock::to_time_t(state.next_review_date) / 1000 * 1000;
+			if (base != -1 && state_base != base)
+			{
+				++torn;
+			}
+			base = state_base;
+			++visited;
+			return true;
+		});
+		if (visited != KANJI_COUNT)
+		{
+			++torn;
+		}
+		++reads;
+	}
+	writer.join();
+
+	CHECK(torn == 0);
+	CHECK(queue.Find(KANJI_COUNT)->next_review_date == At(51'000 + KANJI_COUNT % 97));
+}
+
+TEST_CASE("DueQueue list walk: idle vs during answer batches, 20k kanjis", "[.benchmark][due_queue]")
+{
+	constexpr std::uint32_t KANJI_COUNT = 20'000;
+	DueQueue queue;
+	queue.Load(MakeStates(KANJI_COUNT, 1000));
+
+	const auto walk = [&] {
+		std::size_t visited = 0;
+		queue.ForEach(std::nullopt, [&](const KanjiReviewState&) {
+			++visited;
+			return true;
+		});
+		return visited;
+	};
+
+	BENCHMARK("ForEach, no writers")
+	{
+		return walk();
+	};
+
+	std::atomic<bool> stop{false};
+	std::thread writer{[&] {
+		std::uint32_t id = 1;
+		while (!stop)
+		{
+			std::vector<KanjiReviewState> batch;
+			for (int i = 0; i < 20; ++i, id = id % KANJI_COUNT + 1)
+			{
+				batch.push_back({id, 2, At(5000 + id), At(0)});
+			}
+			queue.Update(batch);
+		}
+	}};
+
+	BENCHMARK("ForEach, answer batches publishing")
+	{
+		return walk();
+	};
+
+	stop = true;
+	writer.join();
+}
+
+TEST_CASE("DueQueue publish cost by queue size", "[.benchmark][due_queue]")
+{
+	// One answer copies the chunk and page tables plus one chunk and one page, so the cost grows
+	// with size / CHUNK_SIZE rather than with size
+	for (const std::uint32_t count : {20'000u, 200'000u})
+	{
+		DueQueue queue;
+		queue.Load(MakeStates(count, 1000));
+		std::uint32_t id = 1;
+		BENCHMARK("Update, one answer, " + std::to_string(count) + " kanjis")
+		{
+			id = id % count + 1;
+			queue.Update({{id, 2, At(5000 + id), At(0)}});
+			return queue.Size();
+		};
+	}
+}
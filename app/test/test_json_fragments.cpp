@@ -0,0 +1,113 @@
+#include "catalog/json_fragments.h"
+#include "controller.h"
+#include "database/database_context.h"
+#include "database/memory_storage.h"
+#include "kanji_fixtures.h"
+#include "kanji_json.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace kanji;
+
+namespace
+{
+	std::string PageJson(const database::KanjiPage& page)
+	{
+		nlohmann::json j = {{"kanjis", page.kanjis}, {"next_cursor", nullptr}};
+		if (page.next)
+		{
+			j["next_cursor"] = page.next->ToString();
+		}
+		return j.dump();
+	}
+} // namespace
+
+TEST_CASE("JSON fragments reproduce the serialized catalog types", "[json][catalog]")
+{
+	catalog::KanjiCatalog::Builder builder;
+	builder.Add(3, {3, "日", "sun, \"day\"", {{"日本", "にほん"}}});
+	builder.Add(9, {9, "\t", "", {}});
+	const catalog::JsonFragments fragments{builder.Build()};
+
+	std::string json;
+	REQUIRE(fragments.AppendKanjiData(json, 3));
+	CHECK(json == nlohmann::json(KanjiData{3, "日", "sun, \"day\"", {{"日本", "にほん"}}}).dump());
+
+	json.clear();
+	REQUIRE(fragments.AppendKanjiRecord(json, 9, -1, 1'700'000'000));
+	CHECK(json == nlohmann::json(KanjiRecord{9, "\t", "", -1, 1'700'000'000}).dump());
+
+	json.clear();
+	CHECK_FALSE(fragments.AppendKanjiData(json, 4));
+	CHECK_FALSE(fragments.AppendKanjiRecord(json, 0, 0, 0));
+	CHECK(json.empty());
+}
+
+TEST_CASE("Controller JSON lists match serializing the SQLite queries", "[json][controller]")
+{
+	TempDatabase temp;
+	database::DatabaseContext storage{temp.GetPath()};
+	auto& repo = storage.GetKanjiRepository();
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+	CHECK(controller.GetKanjisJson() == "[]");
+	CHECK(controller.GetReviewKanjisJson() == "[]");
+	CHECK(controller.GetKanjiPageJson(std::nullopt, 5) == R"({"kanjis":[],"next_cursor":null})");
+
+	controller.BatchAddKanjis(MakeKanjis(12, {.meaning = "meaning \"\n"}));
+	const auto past = std::chrono::system_clock::now() - std::chrono::hours{1};
+	std::vector<KanjiReviewState> due;
+	for (std::uint32_t id = 1; id <= 7; ++id)
+	{
+		due.push_back({id, 2, past - std::chrono::minutes{id}, past});
+	}
+	REQUIRE(storage.GetReviewStateRepository().SaveReviewStates(due));
+	Controller reloaded{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	CHECK(reloaded.GetReviewKanjisJson() == nlohmann::json(reloaded.GetReviewKanjis()).dump());
+	CHECK(reloaded.GetKanjisJson() == nlohmann::json(repo.GetKanjis()).dump());
+
+	std::optional<database::KanjiCursor> cursor;
+	int pages = 0;
+	do
+	{
+		const auto page = repo.GetKanjiPage(cursor, 5);
+		CHECK(reloaded.GetKanjiPageJson(cursor, 5) == PageJson(page));
+		cursor = page.next;
+		++pages;
+	} while (cursor);
+	CHECK(pages == 3);
+
+	SECTION("Fragments follow the catalog when kanjis are added")
+	{
+		const auto before = reloaded.GetCatalogStore()->GetJsonFragments();
+		reloaded.BatchAddKanjis(MakeKanjis(1, {.first = 12, .meaning = "meaning \"\n"}));
+		CHECK(reloaded.GetCatalogStore()->GetJsonFragments() != before);
+		CHECK(reloaded.GetKanjisJson() == nlohmann::json(repo.GetKanjis()).dump());
+		CHECK(reloaded.GetCatalogStats().fragment_bytes > 0);
+	}
+}
+
+TEST_CASE("GET /api/kanjis body: streaming writer vs fragments, 10k kanjis", "[.benchmark][json]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+	controller.BatchAddKanjis(MakeKanjis(10'000));
+	const auto records = ParseKanjis(controller.GetKanjisJson());
+
+	BENCHMARK("utils::json::Dump(records)")
+	{
+		std::string body;
+		utils::json::Dump(records, body);
+		return body;
+	};
+
+	BENCHMARK("GetKanjisJson()")
+	{
+		return controller.GetKanjisJson();
+	};
+}
@@ -0,0 +1,186 @@
+#include "http/request_parsers.h"
+#include "importer/kanji_importer.h"
+#include "kanji_json.h"
+#include "utils/json_reader.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::utils::json;
+
+namespace
+{
+	std::string ReadOneString(std::string_view document)
+	{
+		Reader reader{document};
+		std::string out;
+		REQUIRE(reader.ReadString(out));
+		REQUIRE(reader.AtEnd());
+		return out;
+	}
+
+	bool IsRejected(std::string_view document)
+	{
+		Reader reader{document};
+		return !(reader.SkipValue() && reader.AtEnd());
+	}
+
+	std::string MakeImportBody(std::size_t target_bytes)
+	{
+		std::string body = R"({"kanjis": [)";
+		for (int i = 0; body.size() < target_bytes; ++i)
+		{
+			body += i == 0 ? "" : ",";
+			body += R"({"id": 0, "kanji": "字", "meaning": "character, letter \")" + std::to_string(i) +
+			        R"(\"", "examples": [{"word": "文字", "reading": "もじ"}, {"word": "漢字", "reading": "かんじ"}]})";
+		}
+		return body + "]}";
+	}
+} // namespace
+
+TEST_CASE("JSON reader decodes strings like nlohmann", "[json]")
+{
+	for (const std::string document : {R"("plain ascii that spans several words")", R"("日本語 and 😀")",
+	                                   R"("esc \" \\ \/ \b \f \n \r \t")", R"("é日😀")", R"("")"})
+	{
+		CHECK(ReadOneString(document) == nlohmann::json::parse(document).get<std::string>());
+	}
+
+	CHECK(IsRejected("\"unterminated"));
+	CHECK(IsRejected("\"tab\tinside\""));
+	CHECK(IsRejected("\"bad \\x escape\""));
+	CHECK(IsRejected("\"lone \\uD800 surrogate\""));
+	CHECK(IsRejected("\"lone \\uDC00 surrogate\""));
+	CHECK(IsRejected("\"invalid \xff utf-8\""));
+}
+
+TEST_CASE("JSON reader validates everything it skips", "[json]")
+{
+	CHECK_FALSE(IsRejected(R"({"a": [1, -2.5e+3, true, false, null, {"b": "c"}], "d": {}})"));
+	CHECK_FALSE(IsRejected(" [ ] "));
+
+	CHECK(IsRejected(""));
+	CHECK(IsRejected("{"));
+	CHECK(IsRejected(R"({"a" 1})"));
+	CHECK(IsRejected(R"({"a": 1,})"));
+	CHECK(IsRejected("[1 2]"));
+	CHECK(IsRejected("[01]"));
+	CHECK(IsRejected("[1.]"));
+	CHECK(IsRejected("[tru]"));
+	CHECK(IsRejected("{} {}"));
+	CHECK(IsRejected(std::string(Reader::MAX_DEPTH + 2, '[') + std::string(Reader::MAX_DEPTH + 2, ']')));
+
+	Reader reader{"[1, oops]"};
+	CHECK_FALSE(reader.SkipValue());
+	CHECK(reader.GetError() == "unexpected character at byte 4");
+}
+
+TEST_CASE("JSON reader integers reject fractions and overflow without failing the document", "[json]")
+{
+	Reader reader{"[42, 1.5, 70000, -1]"};
+	std::int16_t value = 0;
+	std::uint32_t unsigned_value = 0;
+	REQUIRE(reader.BeginArray());
+	REQUIRE(reader.NextElement());
+	CHECK(reader.ReadInteger(value));
+	CHECK(value == 42);
+	REQUIRE(reader.NextElement());
+	CHECK_FALSE(reader.ReadInteger(value));
+	REQUIRE(reader.NextElement());
+	CHECK_FALSE(reader.ReadInteger(value));
+	REQUIRE(reader.NextElement());
+	CHECK_FALSE(reader.ReadInteger(unsigned_value));
+	CHECK_FALSE(reader.NextElement());
+	CHECK(reader.AtEnd());
+}
+
+TEST_CASE("Kanji types decode in one pass and report rows of the wrong shape", "[json]")
+{
+	const std::string document =
+	    R"([{"id": 7, "kanji": "日", "meaning": "sun", "examples": [{"word": "日本", "reading": "にほん", "extra": [1]}], "note": null},
+	        {"kanji": 5, "id": 1, "meaning": "m", "examples": []},
+	        {"id": 1, "kanji": "月", "meaning": "moon"},
+	        "not an object",
+	        {"id": 2, "kanji": "火", "meaning": "fire", "examples": [{"word": "火山"}]}])";
+
+	Reader reader{document};
+	std::string error;
+	std::vector<std::string> errors;
+	std::vector<KanjiData> kanjis;
+	REQUIRE(reader.BeginArray());
+	while (reader.NextElement())
+	{
+		KanjiData kanji{};
+		if (ReadJson(reader, kanji, error))
+		{
+			kanjis.push_back(kanji);
+		}
+		else
+		{
+			REQUIRE_FALSE(reader.HasError());
+			errors.push_back(error);
+		}
+	}
+	REQUIRE(reader.AtEnd());
+
+	REQUIRE(kanjis.size() == 1);
+	CHECK(nlohmann::json(kanjis[0]) == nlohmann::json::parse(document)[0].get<KanjiData>());
+	CHECK(errors == std::vector<std::string>{"\"kanji\" must be a string", "missing \"examples\"", "expected an object",
+	                                         "examples[0]: missing \"reading\""});
+}
+
+TEST_CASE("Answers body parses in one pass and rejects malformed input", "[json][http]")
+{
+	std::string error;
+	const auto answers = http::ParseAnswers(
+	    R"({"session": {"started": 1}, "answers": [{"kanji_id": 3, "incorrect_streak": 0}, {"incorrect_streak": 2, "kanji_id": 9}]})",
+	    error);
+	REQUIRE(answers);
+	REQUIRE(answers->size() == 2);
+	CHECK(answers->at(1).kanji_id == 9);
+	CHECK(answers->at(1).incorrect_streak == 2);
+
+	CHECK(http::ParseAnswers(R"({"answers": []})", error)->empty());
+
+	for (const char* body : {"", "[]", "{", R"({"answers": 5})", R"({"other": []})", R"({"answers": [{"kanji_id": 1}]})",
+	                         R"({"answers": [{"kanji_id": -1, "incorrect_streak": 0}]})", R"({"answers": []} trailing)"})
+	{
+		error.clear();
+		CHECK_FALSE(http::ParseAnswers(body, error));
+		CHECK_FALSE(error.empty());
+	}
+}
+
+TEST_CASE("Import body: nlohmann DOM vs SAX vs pull reader, 5 MB", "[.benchmark][json][importer]")
+{
+	// Keep per-chunk logging out of the measurement
+	const auto level = spdlog::get_level();
+	spdlog::set_level(spdlog::level::warn);
+	const std::string body = MakeImportBody(5 << 20);
+	const auto discard = [](const std::vector<KanjiData>& chunk) { return std::vector<std::uint32_t>(chunk.size(), 1); };
+	importer::KanjiImporter importer{discard};
+
+	const std::size_t rows = nlohmann::json::parse(body)["kanjis"].size();
+	REQUIRE(importer.Import(body).inserted == rows);
+
+	BENCHMARK("nlohmann::json::parse + get<std::vector<KanjiData>>")
+	{
+		return nlohmann::json::parse(body)["kanjis"].get<std::vector<KanjiData>>().size();
+	};
+
+	const auto msgpack = nlohmann::json::to_msgpack(nlohmann::json::parse(body));
+	const std::string_view msgpack_body{reinterpret_cast<const char*>(msgpack.data()), msgpack.size()};
+	BENCHMARK("KanjiImporter over the MessagePack body (SAX)")
+	{
+		return importer.Import(msgpack_body, nlohmann::json::input_format_t::msgpack).inserted;
+	};
+
+	BENCHMARK("KanjiImporter over the body (pull reader)")
+	{
+		return importer.Import(body).inserted;
+	};
+	spdlog::set_level(level);
+}
@@ -0,0 +1,122 @@
+#include "kanji_json.h"
+#include "utils/json_writer.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <string>
+
+using namespace kanji;
+
+namespace
+{
+	template <typename T>
+	std::string Dump(const T& value)
+	{
+		std::string buffer;
+		utils::json::Dump(value, buffer);
+		return buffer;
+	}
+
+	std::vector<KanjiRecord> MakeRecords(int count)
+	{
+		std::vector<KanjiRecord> records;
+		records.reserve(count);
+		for (int i = 0; i < count; ++i)
+		{
+			records.push_back({static_cast<std::uint32_t>(i + 1), "字", "character, letter " + std::to_string(i), i % 10,
+			                   1'700'000'000 + i * 3600});
+		}
+		return records;
+	}
+} // namespace
+
+TEST_CASE("JSON writer matches nlohmann::json::dump byte for byte", "[json]")
+{
+	SECTION("Strings")
+	{
+		const std::vector<std::string> strings = {
+		    "",
+		    "plain ascii",
+		    "quote \" backslash \\ slash / del \x7f",
+		    "\b\f\n\r\t",
+		    std::string{"\x00\x01\x1f", 3},
+		    "日本語のテキスト",
+		    "emoji 😀 and U+FFFD \xEF\xBF\xBD",
+		    "mixed 漢字\nwith \"escapes\"",
+		};
+		for (const auto& text : strings)
+		{
+			CHECK(Dump(text) == nlohmann::json(text).dump());
+		}
+	}
+
+	SECTION("Kanji types")
+	{
+		const std::vector<KanjiData> kanjis = {
+		    {1, "日", "sun, \"day\"", {{"日本", "にほん"}, {"毎日", "まいにち"}}},
+		    {4294967295u, "\t", "", {}},
+		};
+		CHECK(Dump(kanjis) == nlohmann::json(kanjis).dump());
+
+		const auto records = MakeRecords(50);
+		CHECK(Dump(records) == nlohmann::json(records).dump());
+		CHECK(Dump(KanjiRecord{7, "水", "water", -1, -42}) == nlohmann::json(KanjiRecord{7, "水", "water", -1, -42}).dump());
+	}
+
+	SECTION("Objects, optionals and nesting")
+	{
+		std::string buffer;
+		utils::json::Writer writer{buffer};
+		writer.BeginObject();
+		writer.Field("empty", std::vector<int>{});
+		writer.Field("ids", std::vector<std::uint32_t>{1, 2, 3});
+		writer.Field("next_cursor", std::optional<std::string>{});
+		writer.Field("ok", true);
+		writer.EndObject();
+
+		const nlohmann::json expected = {{"empty", nlohmann::json::array()},
+		                                 {"ids", {1, 2, 3}},
+		                                 {"next_cursor", nullptr},
+		                                 {"ok", true}};
+		CHECK(buffer == expected.dump());
+	}
+}
+
+TEST_CASE("JSON writer replaces invalid UTF-8 instead of throwing", "[json]")
+{
+	CHECK(Dump(std::string{"a\xff" "b"}) == "\"a\xEF\xBF\xBD" "b\"");
+	// Truncated three-byte sequence, an overlong encoding and a UTF-16 surrogate
+	CHECK(Dump(std::string{"\xE6\x97"}) == "\"\xEF\xBF\xBD\xEF\xBF\xBD\"");
+	CHECK(Dump(std::string{"\xC0\xAF"}) == "\"\xEF\xBF\xBD\xEF\xBF\xBD\"");
+	CHECK(Dump(std::string{"\xED\xA0\x80"}) == "\"\xEF\xBF\xBD\xEF\xBF\xBD\xEF\xBF\xBD\"");
+}
+
+TEST_CASE("JSON writer keeps the buffer's capacity between dumps", "[json]")
+{
+	std::string buffer;
+	utils::json::Dump(MakeRecords(100), buffer);
+	const auto capacity = buffer.capacity();
+	const auto data = buffer.data();
+
+	utils::json::Dump(MakeRecords(10), buffer);
+	CHECK(buffer.capacity() == capacity);
+	CHECK(buffer.data() == data);
+	CHECK(buffer == nlohmann::json(MakeRecords(10)).dump());
+}
+
+TEST_CASE("GET /api/kanjis body: nlohmann DOM vs streaming writer, 10k records", "[.benchmark][json]")
+{
+	const auto records = MakeRecords(10'000);
+	std::string buffer;
+
+	BENCHMARK("nlohmann::json(records).dump()")
+	{
+		return nlohmann::json(records).dump();
+	};
+
+	BENCHMARK("utils::json::Dump into a reused buffer")
+	{
+		utils::json::Dump(records, buffer);
+		return buffer.size();
+	};
+}
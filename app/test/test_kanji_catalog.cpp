@@ -0,0 +1,138 @@
+#include "catalog/kanji_catalog.h"
+#include "controller.h"
+#include "database/database_context.h"
+#include "kanji_fixtures.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::catalog;
+
+TEST_CASE("KanjiCatalog stores kanjis in one arena", "[catalog]")
+{
+	KanjiCatalog::Builder builder;
+	builder.Add(7, {0, "日", "sun", {{"日本", "にほん"}}});
+	builder.Add(3, "山", "mountain");
+	const auto catalog = builder.Build();
+
+	REQUIRE(catalog->Size() == 2);
+	CHECK(catalog->GetEntries()[0].id == 3);
+	CHECK(catalog->Find(5) == nullptr);
+	CHECK(catalog->Find(100) == nullptr);
+
+	const auto* sun = catalog->Find(7);
+	REQUIRE(sun);
+	CHECK(catalog->GetString(sun->kanji) == "日");
+	REQUIRE(catalog->GetExamples(*sun).size() == 1);
+	CHECK(catalog->GetString(catalog->GetExamples(*sun)[0].reading) == "にほん");
+
+	// Extending copies the snapshot; the original stays untouched
+	KanjiCatalog::Builder extended{*catalog};
+	extended.Add(9, "川", "river");
+	const auto next = extended.Build();
+	CHECK(next->Size() == 3);
+	CHECK(catalog->Size() == 2);
+	CHECK(next->ToKanjiData(*next->Find(7)).examples[0].word == "日本");
+}
+
+TEST_CASE("KanjiCatalog::Appender grows one set of tables across chunks", "[catalog]")
+{
+	KanjiCatalog::Builder builder;
+	builder.Add(1, "一", "one");
+	const auto base = builder.Build();
+
+	KanjiCatalog::Appender appender{base};
+	const std::vector<std::uint32_t> first_ids{2, 3};
+	const auto first = appender.Append(first_ids, MakeKanjis(2));
+	REQUIRE(first);
+	const std::vector<std::uint32_t> second_ids{4};
+	const auto second = appender.Append(second_ids, MakeKanjis(1));
+	REQUIRE(second);
+	CHECK(appender.GetLatest() == second);
+
+	CHECK(base->Size() == 1);
+	CHECK(first->Size() == 3);
+	CHECK(first->Find(4) == nullptr);
+	REQUIRE(second->Size() == 4);
+	CHECK(second->ToKanjiData(*second->Find(4)).examples.size() == 2);
+	CHECK(second->GetString(second->Find(1)->kanji) == "一");
+
+	// The second chunk fit in the room left by the first, so both snapshots share one arena
+	CHECK(first->GetString(first->Find(2)->kanji).data() == second->GetString(second->Find(2)->kanji).data());
+
+	// Ids below the current maximum would break the id order; the caller rebuilds instead
+	const std::vector<std::uint32_t> stale_ids{3};
+	CHECK_FALSE(appender.Append(stale_ids, MakeKanjis(1)));
+	CHECK(appender.GetLatest() == second);
+}
+
+TEST_CASE("Controller serves kanjis from the catalog", "[catalog][database]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	db.GetKanjiRepository().BatchInsertKanjis(MakeKanjis(10));
+
+	Controller controller{db, std::make_unique<scheduler::WaniKaniScheduler>()};
+	controller.BatchAddKanjis(MakeKanjis(5));
+
+	const auto loaded = db.GetKanjiRepository().LoadCatalog();
+	CHECK(loaded->Size() == 15);
+	CHECK(controller.GetCatalogStats().kanjis == 15);
+	CHECK(controller.GetCatalogStats().examples == 30);
+
+	const auto from_catalog = ParseKanjis(controller.GetKanjisJson());
+	const auto from_sqlite = db.GetKanjiRepository().GetKanjis();
+	REQUIRE(from_catalog.size() == from_sqlite.size());
+	for (std::size_t i = 0; i < from_catalog.size(); ++i)
+	{
+		CHECK(from_catalog[i].id == from_sqlite[i].id);
+		CHECK(from_catalog[i].kanji == from_sqlite[i].kanji);
+		CHECK(from_catalog[i].meaning == from_sqlite[i].meaning);
+		CHECK(from_catalog[i].next_review_date == from_sqlite[i].next_review_date);
+	}
+
+	const auto page = ParseKanjiPage(controller.GetKanjiPageJson(std::nullopt, 4));
+	REQUIRE(page.next);
+	CHECK(page.kanjis.size() == 4);
+	CHECK(ParseKanjiPage(controller.GetKanjiPageJson(page.next, 100)).kanjis.size() == 11);
+}
+
+TEST_CASE("Kanji lookup: catalog vs SQLite", "[.benchmark][catalog]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	auto& repo = db.GetKanjiRepository();
+	repo.BatchInsertKanjis(MakeKanjis(5000));
+	const auto catalog = repo.LoadCatalog();
+
+	const std::vector<std::uint32_t> ids{17, 900, 2500, 3333, 4999};
+
+	BENCHMARK("SQLite GetKanjisByIds")
+	{
+		return repo.GetKanjisByIds(ids);
+	};
+
+	BENCHMARK("Catalog ToKanjiData")
+	{
+		std::vector<KanjiData> kanjis;
+		for (const auto id : ids)
+		{
+			kanjis.push_back(catalog->ToKanjiData(*catalog->Find(id)));
+		}
+		return kanjis;
+	};
+
+	BENCHMARK("Catalog views")
+	{
+		std::size_t bytes = 0;
+		for (const auto id : ids)
+		{
+			const auto* entry = catalog->Find(id);
+			bytes += catalog->GetString(entry->kanji).size() + catalog->GetString(entry->meaning).size();
+		}
+		return bytes;
+	};
+}
@@ -0,0 +1,134 @@
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "importer/kanji_importer.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::importer;
+
+namespace
+{
+	std::string MakePayload(int count)
+	{
+		std::string payload = R"({"source": {"name": "deck", "kanjis": []}, "kanjis": [)";
+		for (int i = 0; i < count; ++i)
+		{
+			payload += i == 0 ? "" : ",";
+			payload += R"({"id": 0, "kanji": "字)" + std::to_string(i) +
+			           R"(", "meaning": "m", "examples": [{"word": "w", "reading": "r"}]})";
+		}
+		return payload + "]}";
+	}
+} // namespace
+
+TEST_CASE("KanjiImporter hands rows to the sink in bounded chunks", "[importer]")
+{
+	std::vector<std::size_t> chunk_sizes;
+	std::uint32_t next_id = 1;
+	KanjiImporter importer{[&](const std::vector<KanjiData>& chunk) {
+		                       chunk_sizes.push_back(chunk.size());
+		                       std::vector<std::uint32_t> ids;
+		                       for (const auto& kanji : chunk)
+		                       {
+			                       CHECK(kanji.examples.size() == 1);
+			                       ids.push_back(next_id++);
+		                       }
+		                       return ids;
+	                       },
+	                       4};
+
+	const auto report = importer.Import(MakePayload(10));
+	CHECK(report.error.empty());
+	CHECK(report.received == 10);
+	CHECK(report.inserted == 10);
+	CHECK(chunk_sizes == std::vector<std::size_t>{4, 4, 2});
+	REQUIRE(report.chunks.size() == 3);
+	CHECK(report.chunks[2].chunk == 2);
+}
+
+TEST_CASE("KanjiImporter reports invalid rows and malformed payloads", "[importer]")
+{
+	const auto count_sink = [](const std::vector<KanjiData>& chunk) {
+		return std::vector<std::uint32_t>(chunk.size(), 1);
+	};
+
+	SECTION("invalid row is skipped with an error")
+	{
+		KanjiImporter importer{count_sink, 10};
+		const auto report =
+		    importer.Import(R"({"kanjis": [{"id": 0, "kanji": "一", "meaning": "one", "examples": []}, {"kanji": 5}]})");
+		CHECK(report.error.empty());
+		CHECK(report.received == 2);
+		CHECK(report.inserted == 1);
+		REQUIRE(report.chunks.size() == 1);
+		REQUIRE(report.chunks[0].errors.size() == 1);
+		CHECK(report.chunks[0].errors[0].starts_with("kanjis[1]"));
+	}
+
+	SECTION("syntax error keeps rows parsed before it")
+	{
+		KanjiImporter importer{count_sink, 10};
+		const auto report = importer.Import(R"({"kanjis": [{"id": 0, "kanji": "一", "meaning": "one", "examples": []}, {"id": )");
+		CHECK_FALSE(report.error.empty());
+		CHECK(report.inserted == 1);
+	}
+
+	SECTION("missing kanjis array")
+	{
+		KanjiImporter importer{count_sink, 10};
+		const auto report = importer.Import(R"({"items": []})");
+		CHECK_FALSE(report.error.empty());
+		CHECK(report.received == 0);
+	}
+}
+
+TEST_CASE("KanjiImporter commits each chunk through BatchInsertKanjis", "[importer][database]")
+{
+	TempDatabase temp;
+	database::ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	database::KanjiRepository repo{pool};
+
+	KanjiImporter importer{[&](const std::vector<KanjiData>& chunk) { return repo.BatchInsertKanjis(chunk); }, 3};
+	const auto report = importer.Import(MakePayload(7));
+
+	CHECK(report.error.empty());
+	CHECK(report.inserted == 7);
+	CHECK(report.chunks.size() == 3);
+	CHECK(repo.GetKanjis().size() == 7);
+}
+
+TEST_CASE("KanjiImporter decodes MessagePack and CBOR payloads without transcoding", "[importer]")
+{
+	using json = nlohmann::json;
+	std::size_t inserted = 0;
+	KanjiImporter importer{[&](const std::vector<KanjiData>& chunk) {
+		                       inserted += chunk.size();
+		                       return std::vector<std::uint32_t>(chunk.size(), 1);
+	                       },
+	                       4};
+	const auto document = json::parse(MakePayload(10));
+	const auto as_view = [](const std::vector<std::uint8_t>& bytes) {
+		return std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+	};
+
+	const auto msgpack = json::to_msgpack(document);
+	const auto from_msgpack = importer.Import(as_view(msgpack), json::input_format_t::msgpack);
+	CHECK(from_msgpack.error.empty());
+	CHECK(from_msgpack.inserted == 10);
+	CHECK(from_msgpack.chunks.size() == 3);
+
+	const auto cbor = json::to_cbor(document);
+	const auto from_cbor = importer.Import(as_view(cbor), json::input_format_t::cbor);
+	CHECK(from_cbor.error.empty());
+	CHECK(from_cbor.inserted == 10);
+	CHECK(inserted == 20);
+
+	// Rows before a truncation are kept, like JSON
+	const auto truncated = importer.Import(as_view(msgpack).substr(0, msgpack.size() / 2), json::input_format_t::msgpack);
+	CHECK_FALSE(truncated.error.empty());
+	CHECK(truncated.inserted > 0);
+	CHECK(truncated.inserted < 10);
+}
@@ -0,0 +1,121 @@
+#include "database/kanji_repository.h"
+#include "database/connection_pool.h"
+#include "kanji_fixtures.h"
+#include "temp_database.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::database;
+
+namespace
+{
+	// Makes every review due, ordered by kanji id
+	void MakeAllDue(ConnectionPool& pool)
+	{
+		auto connection = pool.AcquireWriter();
+		sqlite3_exec(connection, "UPDATE kanji_review_state SET next_review_date = kanji_id;", nullptr, nullptr, nullptr);
+	}
+} // namespace
+
+TEST_CASE("GetKanjiForReview returns due kanjis with their examples", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository repo{pool};
+
+	auto kanjis = MakeKanjis(7);
+	kanjis[1].examples.clear();
+	repo.BatchInsertKanjis(kanjis);
+	MakeAllDue(pool);
+
+	const auto due = repo.GetKanjiForReview();
+	REQUIRE(due.size() == KanjiRepository::DEFAULT_REVIEW_BATCH_SIZE);
+	for (size_t i = 0; i < due.size(); ++i)
+	{
+		REQUIRE(due[i].kanji == kanjis[i].kanji);
+		REQUIRE(due[i].meaning == kanjis[i].meaning);
+		REQUIRE(due[i].examples.size() == kanjis[i].examples.size());
+		for (size_t w = 0; w < due[i].examples.size(); ++w)
+		{
+			REQUIRE(due[i].examples[w].word == kanjis[i].examples[w].word);
+			REQUIRE(due[i].examples[w].reading == kanjis[i].examples[w].reading);
+		}
+	}
+
+	REQUIRE(repo.GetKanjiForReview(100).size() == kanjis.size());
+}
+
+TEST_CASE("GetKanjiPage walks the kanji list with a keyset cursor", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository repo{pool};
+
+	repo.BatchInsertKanjis(MakeKanjis(25, {.examples = 0}));
+	{
+		// Ties on next_review_date must still page in id order
+		auto connection = pool.AcquireWriter();
+		sqlite3_exec(connection, "UPDATE kanji_review_state SET next_review_date = kanji_id / 4;", nullptr, nullptr, nullptr);
+	}
+
+	std::vector<std::uint32_t> paged_ids;
+	std::optional<KanjiCursor> cursor;
+	int pages = 0;
+	do
+	{
+		const auto page = repo.GetKanjiPage(cursor, 10);
+		for (const auto& record : page.kanjis)
+		{
+			paged_ids.push_back(record.id);
+		}
+		cursor = page.next;
+		++pages;
+	} while (cursor);
+
+	CHECK(pages == 3);
+	std::vector<std::uint32_t> all_ids;
+	for (const auto& record : repo.GetKanjis())
+	{
+		all_ids.push_back(record.id);
+	}
+	CHECK(paged_ids == all_ids);
+	CHECK(paged_ids.size() == 25);
+
+	const auto parsed = KanjiCursor::Parse(KanjiCursor{-5, 42}.ToString());
+	REQUIRE(parsed);
+	CHECK(parsed->next_review_date == -5);
+	CHECK(parsed->id == 42);
+	CHECK_FALSE(KanjiCursor::Parse("12"));
+	CHECK_FALSE(KanjiCursor::Parse("12:x"));
+}
+
+TEST_CASE("GetKanjiForReview latency by batch size", "[.benchmark][database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository repo{pool};
+
+	repo.BatchInsertKanjis(MakeKanjis(2000, {.examples = 4}));
+	MakeAllDue(pool);
+
+	BENCHMARK("batch of 5")
+	{
+		return repo.GetKanjiForReview(5);
+	};
+
+	BENCHMARK("batch of 50")
+	{
+		return repo.GetKanjiForReview(50);
+	};
+
+	BENCHMARK("batch of 500")
+	{
+		return repo.GetKanjiForReview(500);
+	};
+}
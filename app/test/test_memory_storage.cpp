@@ -0,0 +1,160 @@
+#include "controller.h"
+#include "database/database_context.h"
+#include "database/memory_storage.h"
+#include "kanji_fixtures.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <string>
+
+using namespace kanji;
+
+namespace
+{
+	// Everything a client can observe after a fixed sequence of calls
+	struct Observed
+	{
+		std::vector<std::uint32_t> added;
+		std::vector<std::uint32_t> learned;
+		std::vector<std::uint32_t> due_ids;
+		std::vector<std::string> due_words;
+		std::vector<std::uint32_t> list_ids;
+		std::vector<int> list_levels;
+		std::vector<std::uint32_t> paged_ids;
+		std::size_t due_count{};
+		std::size_t known{};
+
+		bool operator==(const Observed&) const = default;
+	};
+
+	Observed RunWorkload(database::IStorage& storage)
+	{
+		Observed observed;
+		{
+			// Backdate the first kanjis so they are due, newest first to exercise the ordering
+			const auto past = std::chrono::system_clock::now() - std::chrono::hours{24};
+			Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+			observed.added = controller.BatchAddKanjis(MakeKanjis(30));
+			std::vector<KanjiReviewState> backdated;
+			for (std::uint32_t id = 1; id <= 6; ++id)
+			{
+				backdated.push_back({id, 1, past - std::chrono::minutes{id}, past});
+			}
+			REQUIRE(storage.GetReviewStateRepository().SaveReviewStates(backdated));
+		}
+
+		// A fresh controller picks the backdated states up at startup
+		Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+		observed.due_count = controller.CountDueReviews();
+		for (const auto& kanji : controller.GetReviewKanjis())
+		{
+			observed.due_ids.push_back(kanji.id);
+			for (const auto& example : kanji.examples)
+			{
+				observed.due_words.push_back(example.word);
+			}
+		}
+
+		controller.SetAnswers({{6, 0}, {5, 2}, {6, 0}, {999, 0}});
+		observed.learned = controller.LearnMoreKanjis(3);
+
+		for (const auto& record : ParseKanjis(controller.GetKanjisJson()))
+		{
+			observed.list_ids.push_back(record.id);
+			observed.list_levels.push_back(record.level);
+		}
+
+		std::optional<database::KanjiCursor> cursor;
+		do
+		{
+			const auto page = ParseKanjiPage(controller.GetKanjiPageJson(cursor, 7));
+			for (const auto& record : page.kanjis)
+			{
+				observed.paged_ids.push_back(record.id);
+			}
+			cursor = page.next;
+		} while (cursor);
+
+		observed.known = controller.Annotate("字1字5字29字").summary.known_kanji;
+		return observed;
+	}
+} // namespace
+
+TEST_CASE("In-memory storage behaves like SQLite behind a controller", "[database][memory]")
+{
+	TempDatabase temp;
+	database::DatabaseContext sqlite{temp.GetPath()};
+	database::MemoryStorage memory;
+
+	const Observed expected = RunWorkload(sqlite);
+	const Observed actual = RunWorkload(memory);
+
+	CHECK(expected.added.size() == 30);
+	CHECK(expected.due_ids == std::vector<std::uint32_t>{6, 5, 4, 3, 2});
+	CHECK(expected.list_ids == expected.paged_ids);
+
+	CHECK(actual.added == expected.added);
+	CHECK(actual.learned == expected.learned);
+	CHECK(actual.due_count == expected.due_count);
+	CHECK(actual.due_ids == expected.due_ids);
+	CHECK(actual.due_words == expected.due_words);
+	CHECK(actual.list_ids == expected.list_ids);
+	CHECK(actual.list_levels == expected.list_levels);
+	CHECK(actual.paged_ids == expected.paged_ids);
+	CHECK(actual.known == expected.known);
+}
+
+TEST_CASE("In-memory storage skips unknown ids and rejects states for missing kanjis", "[database][memory]")
+{
+	database::MemoryStorage memory;
+	auto& kanjis = memory.GetKanjiRepository();
+	auto& states = memory.GetReviewStateRepository();
+
+	CHECK(kanjis.LoadCatalog()->Size() == 0);
+	CHECK(states.InitializeNewReviewStates(5).empty());
+
+	kanjis.BatchInsertKanjis(MakeKanjis(3));
+	const auto catalog = kanjis.LoadCatalog();
+	CHECK(catalog->Find(3));
+	CHECK_FALSE(catalog->Find(42));
+	CHECK(states.GetAllReviewStates().size() == 3);
+	CHECK_FALSE(states.SaveReviewStates({{4, 1, std::chrono::system_clock::now(), {}}}));
+	CHECK(states.GetAllReviewStates().size() == 3);
+	CHECK(catalog->Size() == 3);
+	CHECK(catalog->GetExampleCount() == 6);
+}
+
+TEST_CASE("Storage engines: SQLite vs memory, 5k kanjis", "[.benchmark][database][memory]")
+{
+	TempDatabase temp;
+	database::DatabaseContext sqlite{temp.GetPath()};
+	database::MemoryStorage memory;
+	sqlite.GetKanjiRepository().BatchInsertKanjis(MakeKanjis(5'000));
+	memory.GetKanjiRepository().BatchInsertKanjis(MakeKanjis(5'000));
+
+	const scheduler::WaniKaniScheduler scheduler;
+	std::vector<KanjiAnswer> answers;
+	for (std::uint32_t id = 1; id <= 50; ++id)
+	{
+		answers.push_back({id * 97, 0});
+	}
+
+	BENCHMARK("SQLite LoadCatalog")
+	{
+		return sqlite.GetKanjiRepository().LoadCatalog();
+	};
+	BENCHMARK("Memory LoadCatalog")
+	{
+		return memory.GetKanjiRepository().LoadCatalog();
+	};
+	BENCHMARK("SQLite ApplyAnswers x50")
+	{
+		return sqlite.GetReviewStateRepository().ApplyAnswers(answers, scheduler);
+	};
+	BENCHMARK("Memory ApplyAnswers x50")
+	{
+		return memory.GetReviewStateRepository().ApplyAnswers(answers, scheduler);
+	};
+}
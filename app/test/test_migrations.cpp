@@ -0,0 +1,176 @@
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "database/migrations.h"
+#include "database/review_state_repository.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+
+using namespace kanji;
+using namespace kanji::database;
+
+namespace
+{
+	std::vector<std::string> QueryPlan(sqlite3* db, const std::string& sql)
+	{
+		std::vector<std::string> plan;
+		sqlite3_stmt* stmt = nullptr;
+		REQUIRE(sqlite3_prepare_v2(db, ("EXPLAIN QUERY PLAN " + sql).c_str(), -1, &stmt, nullptr) == SQLITE_OK);
+		while (sqlite3_step(stmt) == SQLITE_ROW)
+		{
+			plan.emplace_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+		}
+		sqlite3_finalize(stmt);
+		return plan;
+	}
+
+	bool PlanContains(const std::vector<std::string>& plan, const std::string& detail)
+	{
+		for (const auto& line : plan)
+		{
+			if (line.find(detail) != std::string::npos)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Full scans of a base table; scans of CTEs, json_each and covering indexes are fine
+	bool PlanHasTableScan(const std::vector<std::string>& plan)
+	{
+		for (const auto& line : plan)
+		{
+			if (line.starts_with("SCAN ") && line.find("USING") == std::string::npos &&
+			    line != "SCAN due" && line.find("VIRTUAL TABLE") == std::string::npos)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	std::vector<std::string> PreparedStatements(sqlite3* db)
+	{
+		std::vector<std::string> statements;
+		for (sqlite3_stmt* stmt = sqlite3_next_stmt(db, nullptr); stmt; stmt = sqlite3_next_stmt(db, stmt))
+		{
+			statements.emplace_back(sqlite3_sql(stmt));
+		}
+		return statements;
+	}
+
+	struct ExpectedPlan
+	{
+		// Fragment that identifies the repository query
+		std::string query;
+		std::vector<std::string> required_details;
+	};
+} // namespace
+
+TEST_CASE("Migrations upgrade an unversioned database in place", "[database]")
+{
+	TempDatabase temp;
+	{
+		sqlite3* db = nullptr;
+		REQUIRE(sqlite3_open(temp.GetPath().string().c_str(), &db) == SQLITE_OK);
+		REQUIRE(sqlite3_exec(db,
+		                     "CREATE TABLE kanjis (id INTEGER PRIMARY KEY, kanji TEXT NOT NULL, meaning TEXT NOT NULL);"
+		                     "INSERT INTO kanjis (kanji, meaning) VALUES ('山', 'mountain');",
+		                     nullptr, nullptr, nullptr) == SQLITE_OK);
+		sqlite3_close(db);
+	}
+
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+
+	auto writer = pool.AcquireWriter();
+	REQUIRE(GetSchemaVersion(writer) == GetMigrations().back().version);
+
+	sqlite3_stmt* stmt = nullptr;
+	sqlite3_prepare_v2(writer, "SELECT count(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_%';", -1, &stmt, nullptr);
+	REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+	REQUIRE(sqlite3_column_int(stmt, 0) == 2);
+	sqlite3_finalize(stmt);
+
+	sqlite3_prepare_v2(writer, "SELECT count(*) FROM kanjis;", -1, &stmt, nullptr);
+	REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+	REQUIRE(sqlite3_column_int(stmt, 0) == 1);
+	sqlite3_finalize(stmt);
+
+	// Re-running is a no-op
+	REQUIRE(ApplyMigrations(writer));
+}
+
+TEST_CASE("Repository queries use the expected query plans", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	scheduler::WaniKaniScheduler scheduler;
+
+	// Exercise every repository query so its statement lands in the cache
+	kanji_repo.BatchInsertKanjis({{0, "日", "sun", {{"日本", "にほん"}}}});
+	kanji_repo.GetKanjiForReview();
+	kanji_repo.GetKanjisByIds({1});
+	kanji_repo.GetKanjis();
+	kanji_repo.GetKanjiPage(KanjiCursor{0, 1}, 10);
+	review_repo.GetReviewStates({1});
+	review_repo.GetAllReviewStates();
+	review_repo.GetAllReviewLevels();
+	review_repo.InitializeNewReviewStates(10);
+	review_repo.ApplyAnswers({{1, 0}}, scheduler);
+
+	const std::vector<ExpectedPlan> expected_plans = {
+	    {"WITH due AS",
+	     {"SEARCH rs USING COVERING INDEX idx_review_state_due (next_review_date<?)",
+	      "SEARCH k USING INTEGER PRIMARY KEY",
+	      "SEARCH w USING COVERING INDEX idx_kanji_words_kanji (kanji_id=?)"}},
+	    {"FROM json_each(?) ids",
+	     {"SEARCH k USING INTEGER PRIMARY KEY", "SEARCH w USING COVERING INDEX idx_kanji_words_kanji (kanji_id=?)"}},
+	    {"ORDER BY rs.next_review_date, rs.kanji_id;",
+	     {"SCAN rs USING COVERING INDEX idx_review_state_due", "SEARCH k USING INTEGER PRIMARY KEY"}},
+	    {"WHERE (rs.next_review_date, rs.kanji_id) > (?, ?)",
+	     {"SEARCH rs USING COVERING INDEX idx_review_state_due", "SEARCH k USING INTEGER PRIMARY KEY"}},
+	    {"WHERE kanji_id IN (SELECT value FROM json_each(?))",
+	     {"SEARCH kanji_review_state USING INTEGER PRIMARY KEY"}},
+	    {"SELECT k.kanji, krs.level",
+	     {"SCAN krs USING COVERING INDEX idx_review_state_due", "SEARCH k USING INTEGER PRIMARY KEY"}},
+	};
+
+	std::vector<std::string> statements = PreparedStatements(pool.AcquireReader());
+	for (auto& sql : PreparedStatements(pool.AcquireWriter()))
+	{
+		statements.push_back(std::move(sql));
+	}
+
+	auto writer = pool.AcquireWriter();
+	for (const auto& expected : expected_plans)
+	{
+		bool found = false;
+		for (const auto& sql : statements)
+		{
+			if (sql.find(expected.query) == std::string::npos)
+			{
+				continue;
+			}
+
+			found = true;
+			const auto plan = QueryPlan(writer, sql);
+			INFO(sql);
+			for (const auto& detail : expected.required_details)
+			{
+				INFO(detail);
+				REQUIRE(PlanContains(plan, detail));
+			}
+			REQUIRE_FALSE(PlanHasTableScan(plan));
+		}
+		INFO(expected.query);
+		REQUIRE(found);
+	}
+}
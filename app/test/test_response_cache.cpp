@@ -0,0 +1,80 @@
+#include "controller.h"
+#include "database/memory_storage.h"
+#include "http/response_cache.h"
+#include "scheduler/wanikani_scheduler.h"
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::http;
+
+TEST_CASE("Response cache serves a body only for the ETag it was built for", "[http]")
+{
+	ResponseCache cache{2};
+	CHECK_FALSE(cache.Find("kanjis", "\"1\""));
+
+	cache.Store("kanjis", "\"1\"", "[1]");
+	REQUIRE(cache.Find("kanjis", "\"1\""));
+	CHECK(*cache.Find("kanjis", "\"1\"") == "[1]");
+	CHECK_FALSE(cache.Find("kanjis", "\"2\""));
+	CHECK_FALSE(cache.Find("reviews", "\"1\""));
+
+	SECTION("A newer body replaces the old one")
+	{
+		cache.Store("kanjis", "\"2\"", "[1,2]");
+		CHECK_FALSE(cache.Find("kanjis", "\"1\""));
+		CHECK(*cache.Find("kanjis", "\"2\"") == "[1,2]");
+	}
+
+	SECTION("The oldest route is dropped once the cache is full")
+	{
+		const auto held = cache.Find("kanjis", "\"1\"");
+		cache.Store("reviews", "\"1\"", "[]");
+		cache.Store("kanjis?limit=10&cursor=", "\"1\"", "{}");
+		CHECK_FALSE(cache.Find("kanjis", "\"1\""));
+		CHECK(cache.Find("reviews", "\"1\""));
+		// Bodies already handed out stay valid
+		CHECK(*held == "[1]");
+	}
+}
+
+TEST_CASE("If-None-Match accepts lists, weak tags and the wildcard", "[http]")
+{
+	const std::string etag = MakeETag("42-7.3");
+	CHECK(etag == "\"42-7.3\"");
+
+	CHECK(MatchesIfNoneMatch("\"42-7.3\"", etag));
+	CHECK(MatchesIfNoneMatch("W/\"42-7.3\"", etag));
+	CHECK(MatchesIfNoneMatch("\"x\", \"42-7.3\"", etag));
+	CHECK(MatchesIfNoneMatch(" * ", etag));
+	CHECK_FALSE(MatchesIfNoneMatch("", etag));
+	CHECK_FALSE(MatchesIfNoneMatch("\"42-7.4\"", etag));
+	CHECK_FALSE(MatchesIfNoneMatch("42-7.3", etag));
+	CHECK_FALSE(MatchesIfNoneMatch(" , ,", etag));
+}
+
+TEST_CASE("Controller revision moves on every mutation and only then", "[http][controller]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	auto revision = controller.GetRevision();
+	const auto expect_bump = [&](bool bumped) {
+		const auto now = controller.GetRevision();
+		CHECK((now != revision) == bumped);
+		revision = now;
+	};
+
+	controller.GetKanjisJson();
+	controller.GetReviewKanjis();
+	expect_bump(false);
+
+	controller.BatchAddKanjis({{0, "日", "sun", {}}, {0, "月", "moon", {}}});
+	expect_bump(true);
+	controller.SetAnswers({{1, 0}});
+	expect_bump(true);
+	controller.LearnMoreKanjis(1);
+	expect_bump(true);
+	controller.Annotate("日月");
+	expect_bump(false);
+}
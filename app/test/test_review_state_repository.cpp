@@ -0,0 +1,140 @@
+#include "database/connection_pool.h"
+#include "database/kanji_repository.h"
+#include "database/review_state_repository.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::database;
+
+namespace
+{
+	void InsertKanjis(KanjiRepository& repo, int count)
+	{
+		std::vector<KanjiData> kanjis;
+		for (int i = 0; i < count; ++i)
+		{
+			kanjis.push_back({0, "字" + std::to_string(i), "meaning", {}});
+		}
+		repo.BatchInsertKanjis(kanjis);
+	}
+
+	int CountCommits(void* counter)
+	{
+		++*static_cast<int*>(counter);
+		return 0;
+	}
+} // namespace
+
+TEST_CASE("ApplyAnswers matches states by kanji id and commits once", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	scheduler::WaniKaniScheduler scheduler;
+
+	InsertKanjis(kanji_repo, 100);
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_exec(writer, "UPDATE kanji_review_state SET level = kanji_id % 5;", nullptr, nullptr, nullptr);
+	}
+
+	// Answers in reverse id order plus one id that has no review state
+	std::vector<KanjiAnswer> answers;
+	for (std::uint32_t id = 100; id >= 1; --id)
+	{
+		answers.push_back({id, 0});
+	}
+	answers.push_back({12345, 0});
+
+	int commits = 0;
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_commit_hook(writer, CountCommits, &commits);
+	}
+
+	const auto new_states = review_repo.ApplyAnswers(answers, scheduler);
+
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_commit_hook(writer, nullptr, nullptr);
+	}
+
+	REQUIRE(commits == 1);
+	REQUIRE(new_states.size() == 100);
+
+	std::vector<std::uint32_t> ids;
+	for (std::uint32_t id = 1; id <= 100; ++id)
+	{
+		ids.push_back(id);
+	}
+	for (const auto& state : review_repo.GetReviewStates(ids))
+	{
+		REQUIRE(state.level == static_cast<int>(state.kanji_id % 5) + 1);
+	}
+}
+
+TEST_CASE("ApplyAnswers chains repeated answers for the same kanji", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+	scheduler::WaniKaniScheduler scheduler;
+
+	InsertKanjis(kanji_repo, 1);
+
+	const auto new_states = review_repo.ApplyAnswers({{1, 0}, {1, 0}}, scheduler);
+	REQUIRE(new_states.size() == 1);
+	REQUIRE(new_states[0].level == 2);
+	REQUIRE(review_repo.GetReviewStates({1}).at(0).level == 2);
+}
+
+TEST_CASE("InitializeNewReviewStates starts the lowest unstarted ids in one commit", "[database]")
+{
+	TempDatabase temp;
+	ConnectionPool pool{temp.GetPath()};
+	REQUIRE(pool.Initialize());
+	KanjiRepository kanji_repo{pool};
+	ReviewStateRepository review_repo{pool};
+
+	InsertKanjis(kanji_repo, 300);
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_exec(writer, "DELETE FROM kanji_review_state WHERE kanji_id > 50 AND kanji_id % 2 = 0;", nullptr, nullptr,
+		             nullptr);
+	}
+
+	int commits = 0;
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_commit_hook(writer, CountCommits, &commits);
+	}
+
+	const auto new_states = review_repo.InitializeNewReviewStates(100);
+
+	{
+		auto writer = pool.AcquireWriter();
+		sqlite3_commit_hook(writer, nullptr, nullptr);
+	}
+
+	REQUIRE(commits == 1);
+	REQUIRE(new_states.size() == 100);
+	CHECK(new_states.front().kanji_id == 52);
+	CHECK(new_states.back().kanji_id == 250);
+	for (const auto& state : new_states)
+	{
+		CHECK(state.level == 0);
+		CHECK(state.kanji_id % 2 == 0);
+	}
+
+	CHECK(review_repo.InitializeNewReviewStates(100).size() == 25);
+	CHECK(review_repo.InitializeNewReviewStates(100).empty());
+	CHECK(review_repo.GetAllReviewStates().size() == 300);
+}
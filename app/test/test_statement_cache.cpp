@@ -0,0 +1,63 @@
+#include "database/sqlite_connection.h"
+#include "temp_database.h"
+#include <catch2/catch_test_macros.hpp>
+#include <sqlite3.h>
+
+using namespace kanji::database;
+
+TEST_CASE("Statement cache reuses prepared statements by SQL text", "[database]")
+{
+	TempDatabase temp;
+	SQLiteConnection connection{temp.GetPath()};
+	REQUIRE(connection.Initialize());
+
+	const char* sql = "SELECT ?;";
+	sqlite3_stmt* first_raw = nullptr;
+	{
+		SQLiteStatement stmt = connection.Prepare(sql);
+		REQUIRE(stmt);
+		first_raw = stmt;
+	}
+
+	SQLiteStatement stmt = connection.Prepare(sql);
+	REQUIRE(stmt.Get() == first_raw);
+
+	const auto stats = connection.GetStatementCacheStats();
+	REQUIRE(stats.misses >= 1);
+	REQUIRE(stats.hits >= 1);
+}
+
+TEST_CASE("Statement cache hands out reset and cleared statements", "[database]")
+{
+	TempDatabase temp;
+	SQLiteConnection connection{temp.GetPath()};
+	REQUIRE(connection.Initialize());
+
+	const char* sql = "SELECT ?;";
+	{
+		SQLiteStatement stmt = connection.Prepare(sql);
+		sqlite3_bind_int(stmt, 1, 42);
+		REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+		REQUIRE(sqlite3_column_int(stmt, 0) == 42);
+	}
+
+	SQLiteStatement stmt = connection.Prepare(sql);
+	REQUIRE(sqlite3_step(stmt) == SQLITE_ROW);
+	REQUIRE(sqlite3_column_type(stmt, 0) == SQLITE_NULL);
+}
+
+TEST_CASE("Statement cache prepares a separate statement for nested use", "[database]")
+{
+	TempDatabase temp;
+	SQLiteConnection connection{temp.GetPath()};
+	REQUIRE(connection.Initialize());
+
+	SQLiteStatement outer = connection.Prepare("SELECT 1;");
+	SQLiteStatement inner = connection.Prepare("SELECT 1;");
+	REQUIRE(outer);
+	REQUIRE(inner);
+	REQUIRE(outer.Get() != inner.Get());
+
+	SQLiteStatement invalid = connection.Prepare("SELECT FROM nowhere;");
+	REQUIRE_FALSE(invalid);
+}
@@ -0,0 +1,54 @@
+#include "auth/stream_tickets.h"
+#include <catch2/catch_test_macros.hpp>
+#include <set>
+#include <string>
+
+using namespace kanji::auth;
+using namespace std::chrono_literals;
+
+TEST_CASE("Stream tickets are redeemed once for the user they were issued to", "[auth][stream]")
+{
+	StreamTickets tickets;
+	const auto now = StreamTickets::Clock::now();
+
+	const auto alice = tickets.Issue("alice", now);
+	const auto bob = tickets.Issue("bob", now);
+	REQUIRE(alice.size() == 32);
+	CHECK(alice != bob);
+
+	CHECK(tickets.Redeem(bob, now + 1s) == "bob");
+	CHECK(tickets.Redeem(alice, now + 1s) == "alice");
+	// A replayed URL is refused
+	CHECK_FALSE(tickets.Redeem(alice, now + 2s));
+	CHECK_FALSE(tickets.Redeem("", now));
+	CHECK_FALSE(tickets.Redeem("not a ticket", now));
+}
+
+TEST_CASE("Stream tickets expire after their lifetime", "[auth][stream]")
+{
+	StreamTickets tickets{10s};
+	const auto now = StreamTickets::Clock::now();
+
+	const auto late = tickets.Issue("alice", now);
+	CHECK_FALSE(tickets.Redeem(late, now + 10s));
+
+	const auto on_time = tickets.Issue("alice", now);
+	CHECK(tickets.Redeem(on_time, now + 9s) == "alice");
+}
+
+TEST_CASE("Outstanding stream tickets are bounded", "[auth][stream]")
+{
+	StreamTickets tickets{10s};
+	const auto now = StreamTickets::Clock::now();
+
+	std::set<std::string> issued;
+	for (std::size_t i = 0; i < StreamTickets::MAX_OUTSTANDING; ++i)
+	{
+		issued.insert(tickets.Issue("alice", now));
+	}
+	CHECK(issued.size() == StreamTickets::MAX_OUTSTANDING);
+	CHECK(tickets.Issue("alice", now).empty());
+
+	// Expired tickets make room again
+	CHECK_FALSE(tickets.Issue("alice", now + 10s).empty());
+}
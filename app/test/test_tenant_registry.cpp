@@ -0,0 +1,131 @@
+#include "controller.h"
+#include "database/database_context.h"
+#include "database/transaction.h"
+#include "kanji_fixtures.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include "tenancy/tenant_registry.h"
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <sqlite3.h>
+#include <string>
+#include <thread>
+
+using namespace kanji;
+using namespace kanji::tenancy;
+
+namespace
+{
+	// Removes the shard directory with everything in it
+	struct ShardDirectory
+	{
+		explicit ShardDirectory(std::filesystem::path in_path)
+		    : path{std::move(in_path)}
+		{
+			std::filesystem::remove_all(path);
+		}
+
+		~ShardDirectory()
+		{
+			std::error_code ec;
+			std::filesystem::remove_all(path, ec);
+		}
+
+		std::filesystem::path path;
+	};
+} // namespace
+
+TEST_CASE("Learners get their own review-state shard over a shared catalog", "[tenancy][database]")
+{
+	TempDatabase temp;
+	ShardDirectory shards{temp.GetPath().string() + "_users"};
+	config::DatabaseSettings settings;
+	settings.busy_timeout_ms = 100;
+
+	database::DatabaseContext db{temp.GetPath(), settings};
+	Controller owner{db, std::make_unique<scheduler::WaniKaniScheduler>()};
+	owner.BatchAddKanjis(MakeKanjis(20));
+
+	TenantRegistry registry{shards.path, temp.GetPath(), settings, owner.GetCatalogStore(), 1};
+	CHECK_FALSE(registry.Acquire("../etc"));
+	CHECK_FALSE(registry.Acquire(""));
+
+	auto alice = registry.Acquire("1001");
+	REQUIRE(alice);
+	CHECK(std::filesystem::exists(shards.path / "1001.db"));
+	CHECK(ParseKanjis(alice->controller.GetKanjisJson()).empty());
+
+	const auto ids = alice->controller.LearnMoreKanjis(3);
+	CHECK(ids == std::vector<std::uint32_t>{1, 2, 3});
+	const auto learned = ParseKanjis(alice->controller.GetKanjisJson());
+	REQUIRE(learned.size() == 3);
+	CHECK(learned[0].kanji == "字0");
+	// The owner's own review states live in the main database and are untouched
+	CHECK(ParseKanjis(owner.GetKanjisJson()).size() == 20);
+
+	SECTION("Writes to different shards and the catalog never wait on each other")
+	{
+		auto bob = registry.Acquire("1002");
+		REQUIRE(bob);
+
+		database::ConnectionPool alice_pool{shards.path / "1001.db", settings, temp.GetPath()};
+		auto alice_writer = alice_pool.AcquireWriter();
+		database::Transaction held{alice_writer};
+		REQUIRE(held);
+
+		CHECK(bob->controller.LearnMoreKanjis(5).size() == 5);
+		CHECK(owner.BatchAddKanjis(MakeKanjis(2)).size() == 2);
+		// New catalog entries reach every learner
+		CHECK(bob->controller.LearnMoreKanjis(100).size() == 17);
+	}
+
+	SECTION("An evicted shard in use is handed back instead of reopened")
+	{
+		auto bob = registry.Acquire("1002");
+		CHECK(registry.GetStats().evictions == 1);
+		CHECK(registry.Acquire("1001") == alice);
+
+		const auto stats = registry.GetStats();
+		CHECK(stats.open == 1);
+		CHECK(stats.misses == 3);
+	}
+}
+
+TEST_CASE("A slow shard open does not hold up other learners", "[tenancy][database]")
+{
+	using namespace std::chrono_literals;
+
+	TempDatabase temp;
+	ShardDirectory shards{temp.GetPath().string() + "_users"};
+	config::DatabaseSettings settings;
+	settings.busy_timeout_ms = 300;
+
+	database::DatabaseContext db{temp.GetPath(), settings};
+	Controller owner{db, std::make_unique<scheduler::WaniKaniScheduler>()};
+	owner.BatchAddKanjis(MakeKanjis(5));
+
+	TenantRegistry registry{shards.path, temp.GetPath(), settings, owner.GetCatalogStore(), 4};
+	auto alice = registry.Acquire("1001");
+	REQUIRE(alice);
+
+	// Another process holds bob's shard, so opening it waits out busy timeouts
+	std::filesystem::create_directories(shards.path);
+	sqlite3* blocker = nullptr;
+	REQUIRE(sqlite3_open((shards.path / "1002.db").string().c_str(), &blocker) == SQLITE_OK);
+	REQUIRE(sqlite3_exec(blocker, "BEGIN EXCLUSIVE;", nullptr, nullptr, nullptr) == SQLITE_OK);
+
+	// Bob's open takes several busy timeouts; alice's lookup must not sit behind it
+	const auto start = std::chrono::steady_clock::now();
+	std::jthread bob{[&] { registry.Acquire("1002"); }};
+	while (registry.GetStats().misses < 2)
+	{
+		std::this_thread::yield();
+	}
+	CHECK(registry.Acquire("1001") == alice);
+	CHECK(std::chrono::steady_clock::now() - start < 300ms);
+
+	bob.join();
+	sqlite3_exec(blocker, "ROLLBACK;", nullptr, nullptr, nullptr);
+	sqlite3_close(blocker);
+}
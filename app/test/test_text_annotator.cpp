@@ -0,0 +1,106 @@
+#include "annotation/text_annotator.h"
+#include "controller.h"
+#include "database/database_context.h"
+#include "scheduler/wanikani_scheduler.h"
+#include "temp_database.h"
+#include "utils/utf8.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+using namespace kanji;
+using namespace kanji::annotation;
+
+TEST_CASE("utf8::Decode rejects malformed sequences", "[annotation]")
+{
+	std::size_t length = 0;
+	CHECK(utils::utf8::Decode("日", 0, length) == U'日');
+	CHECK(length == 3);
+	CHECK(utils::utf8::Decode("\xF0\xA0\x80\x8B", 0, length) == U'\U0002000B');
+	CHECK(length == 4);
+
+	// Truncated, overlong and surrogate forms all decode to one replacement character
+	for (const std::string_view bad : {"\xE6\x97", "\xC0\xAF", "\xED\xA0\x80", "\x80"})
+	{
+		CHECK(utils::utf8::Decode(bad, 0, length) == utils::utf8::REPLACEMENT_CHARACTER);
+		CHECK(length == 1);
+	}
+}
+
+TEST_CASE("Annotate counts kanji and levels", "[annotation]")
+{
+	const LevelTable table{{{U'日', 3}, {U'本', 0}, {U'a', 5}}};
+	const auto result = Annotate("Hello, 日本語の日記 and more ASCII text\xE6\x97", table);
+
+	REQUIRE(result.kanjis.size() == 4);
+	CHECK(result.kanjis[0].kanji == "日");
+	CHECK(result.kanjis[0].count == 2);
+	CHECK(result.kanjis[0].level == 3);
+	CHECK(result.kanjis[1].level == 0);
+	CHECK_FALSE(result.kanjis[2].level);
+
+	CHECK(result.summary.total_kanji == 5);
+	CHECK(result.summary.known_kanji == 3);
+	CHECK(result.summary.unknown_kanji == 2);
+	CHECK(result.summary.distinct_known == 2);
+	CHECK(result.summary.coverage == 0.6);
+	// Non-kanji codepoints are never levelled
+	REQUIRE(result.summary.level_counts.size() == 4);
+	CHECK(result.summary.level_counts[3] == 2);
+
+	const nlohmann::json j = result;
+	CHECK(j["kanjis"][2]["level"] == "unknown");
+	CHECK(Annotate("", table).summary.coverage == 0.0);
+
+	// The counter table is reused by the thread, so nothing may carry over between requests
+	const auto again = Annotate("日本", table);
+	REQUIRE(again.kanjis.size() == 2);
+	CHECK(again.kanjis[0].count == 1);
+	CHECK(again.kanjis[1].count == 1);
+}
+
+TEST_CASE("Controller annotates with current review levels", "[annotation][database]")
+{
+	TempDatabase temp;
+	database::DatabaseContext db{temp.GetPath()};
+	Controller controller{db, std::make_unique<scheduler::WaniKaniScheduler>()};
+
+	CHECK(controller.Annotate("日").summary.known_kanji == 0);
+
+	const auto ids = controller.BatchAddKanjis({{0, "日", "sun", {}}, {0, "本", "book", {}}});
+	REQUIRE(ids.size() == 2);
+	CHECK(controller.Annotate("日本").summary.known_kanji == 2);
+
+	controller.SetAnswers({{ids[0], 0}});
+	const auto result = controller.Annotate("日本");
+	REQUIRE(result.kanjis[0].level);
+	CHECK(*result.kanjis[0].level == 1);
+}
+
+TEST_CASE("Annotate throughput", "[.benchmark][annotation]")
+{
+	std::unordered_map<char32_t, int> levels;
+	for (char32_t codepoint = 0x4E00; codepoint < 0x4E00 + 2000; ++codepoint)
+	{
+		levels.emplace(codepoint, static_cast<int>(codepoint % 9));
+	}
+	const LevelTable table{levels};
+
+	std::string japanese;
+	std::string mixed;
+	for (int i = 0; i < 100000; ++i)
+	{
+		japanese += "今日は日本語を勉強します。";
+		mixed += "<p class=\"body\">The word 勉強 means study.</p>\n";
+	}
+
+	BENCHMARK("Japanese prose (~3.9 MB)")
+	{
+		return Annotate(japanese, table).summary.total_kanji;
+	};
+
+	BENCHMARK("ASCII-heavy markup (~4.5 MB)")
+	{
+		return Annotate(mixed, table).summary.total_kanji;
+	};
+}
@@ -0,0 +1,155 @@
+#include "controller.h"
+#include "database/memory_storage.h"
+#include "http/request_parsers.h"
+#include "http/wire_format.h"
+#include "kanji_fixtures.h"
+#include "scheduler/wanikani_scheduler.h"
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <string>
+
+using namespace kanji;
+using http::WireFormat;
+
+namespace
+{
+	std::string ToJsonOrError(std::string_view body, WireFormat format)
+	{
+		std::string storage;
+		std::string error;
+		const auto json = http::ToJson(body, format, storage, error);
+		return json ? std::string{*json} : "error: " + error;
+	}
+} // namespace
+
+TEST_CASE("Request bodies are read by their Content-Type", "[http][wire]")
+{
+	CHECK(http::RequestFormat("application/msgpack") == WireFormat::MessagePack);
+	CHECK(http::RequestFormat("application/x-msgpack") == WireFormat::MessagePack);
+	CHECK(http::RequestFormat("Application/CBOR; charset=binary") == WireFormat::Cbor);
+	CHECK(http::RequestFormat("application/json; charset=utf-8") == WireFormat::Json);
+	// Older clients send JSON as text/plain or without a header
+	CHECK(http::RequestFormat("text/plain;charset=UTF-8") == WireFormat::Json);
+	CHECK(http::RequestFormat("") == WireFormat::Json);
+
+	CHECK(http::GetInputFormat(WireFormat::Json) == nlohmann::json::input_format_t::json);
+	CHECK(http::GetInputFormat(WireFormat::MessagePack) == nlohmann::json::input_format_t::msgpack);
+	CHECK(http::GetInputFormat(WireFormat::Cbor) == nlohmann::json::input_format_t::cbor);
+}
+
+TEST_CASE("Responses follow the Accept header", "[http][wire]")
+{
+	CHECK(http::NegotiateFormat("") == WireFormat::Json);
+	CHECK(http::NegotiateFormat("*/*") == WireFormat::Json);
+	CHECK(http::NegotiateFormat("text/html") == WireFormat::Json);
+	CHECK(http::NegotiateFormat("application/msgpack") == WireFormat::MessagePack);
+	CHECK(http::NegotiateFormat("application/cbor") == WireFormat::Cbor);
+
+	SECTION("Higher q wins")
+	{
+		CHECK(http::NegotiateFormat("application/json;q=0.9, application/cbor") == WireFormat::Cbor);
+		CHECK(http::NegotiateFormat("application/msgpack;q=0.2, application/json;q=0.8") == WireFormat::Json);
+		CHECK(http::NegotiateFormat("application/msgpack; q=0") == WireFormat::Json);
+	}
+
+	SECTION("Named types beat wildcards, earlier entries beat later ones")
+	{
+		CHECK(http::NegotiateFormat("*/*, application/msgpack") == WireFormat::MessagePack);
+		CHECK(http::NegotiateFormat("application/cbor;q=0.5, application/msgpack;q=0.5") == WireFormat::Cbor);
+		CHECK(http::NegotiateFormat("application/json, application/msgpack") == WireFormat::Json);
+	}
+
+	CHECK(http::GetMediaType(WireFormat::MessagePack) == "application/msgpack");
+	CHECK(http::GetSuffix(WireFormat::Json).empty());
+	CHECK(http::GetSuffix(WireFormat::Cbor) != http::GetSuffix(WireFormat::MessagePack));
+}
+
+TEST_CASE("Binary bodies round-trip through JSON", "[http][wire]")
+{
+	const std::string json = R"({"answers":[{"kanji_id":3,"incorrect_streak":2}],"text":"漢字 \"quoted\"","ok":true,"none":null})";
+
+	SECTION("JSON passes through untouched")
+	{
+		CHECK(http::FromJson(json, WireFormat::Json) == json);
+		std::string storage;
+		std::string error;
+		const auto view = http::ToJson(json, WireFormat::Json, storage, error);
+		REQUIRE(view);
+		CHECK(view->data() == json.data());
+	}
+
+	for (const auto format : {WireFormat::MessagePack, WireFormat::Cbor})
+	{
+		const auto encoded = http::FromJson(json, format);
+		CHECK(encoded.size() < json.size());
+		CHECK(nlohmann::json::parse(ToJsonOrError(encoded, format)) == nlohmann::json::parse(json));
+	}
+
+	SECTION("Decoded answers go through the JSON validation")
+	{
+		const auto body = http::FromJson(R"({"answers":[{"kanji_id":5,"incorrect_streak":1},{"kanji_id":6}]})",
+		                                 WireFormat::MessagePack);
+		std::string error;
+		CHECK_FALSE(http::ParseAnswers(ToJsonOrError(body, WireFormat::MessagePack), error));
+		CHECK(error == "answers[1]: missing \"incorrect_streak\"");
+	}
+}
+
+TEST_CASE("Malformed binary bodies are rejected", "[http][wire]")
+{
+	// 0xc1 is never used in MessagePack; a lone 0xff is a CBOR "break" outside any container
+	CHECK(ToJsonOrError("\xc1", WireFormat::MessagePack) == "error: malformed MessagePack body");
+	CHECK(ToJsonOrError("\xff", WireFormat::Cbor) == "error: malformed CBOR body");
+
+	// Truncated: a four-element array holding one element
+	CHECK(ToJsonOrError("\x94\x01", WireFormat::MessagePack).starts_with("error:"));
+	// Trailing bytes after the document
+	CHECK(ToJsonOrError(std::string{"\x01\x02"}, WireFormat::MessagePack).starts_with("error:"));
+
+	// An empty body is "no body" rather than an error
+	CHECK(ToJsonOrError("", WireFormat::Cbor).empty());
+
+	// Strings with broken UTF-8 are mended instead of throwing on the way to JSON
+	const std::string broken{"\xa2\xff\xfe", 3};
+	CHECK(nlohmann::json::parse(ToJsonOrError(broken, WireFormat::MessagePack)) == "\xef\xbf\xbd\xef\xbf\xbd");
+}
+
+TEST_CASE("GET /api/kanjis wire formats, 10k kanjis", "[.benchmark][http][wire]")
+{
+	database::MemoryStorage storage;
+	Controller controller{storage, std::make_unique<scheduler::WaniKaniScheduler>()};
+	controller.BatchAddKanjis(MakeKanjis(10'000, {.meaning = "character, letter "}));
+	const auto json = controller.GetKanjisJson();
+	const auto msgpack = http::FromJson(json, WireFormat::MessagePack);
+	const auto cbor = http::FromJson(json, WireFormat::Cbor);
+	spdlog::warn("GET /api/kanjis body: JSON {} bytes, MessagePack {} bytes, CBOR {} bytes", json.size(),
+	             msgpack.size(), cbor.size());
+	CHECK(msgpack.size() < json.size());
+	CHECK(cbor.size() < json.size());
+
+	// Server side, once per revision: the response cache keeps the encoded body
+	BENCHMARK("encode MessagePack")
+	{
+		return http::FromJson(json, WireFormat::MessagePack);
+	};
+	BENCHMARK("encode CBOR")
+	{
+		return http::FromJson(json, WireFormat::Cbor);
+	};
+
+	// Client side, on every pull
+	BENCHMARK("decode JSON")
+	{
+		return nlohmann::json::parse(json);
+	};
+	BENCHMARK("decode MessagePack")
+	{
+		return nlohmann::json::from_msgpack(msgpack);
+	};
+	BENCHMARK("decode CBOR")
+	{
+		return nlohmann::json::from_cbor(cbor);
+	};
+}
@@ -1,9 +1,11 @@
 import { useEffect, useState } from "react";
 import { useNavigate } from "react-router-dom";
-import type { Transport, KanjiListEntry } from "../core/transport";
+import type { Transport, KanjiListEntry, KanjiListPage } from "../core/transport";
 import "./KanjiListScreen.css";
 
 const PAGE_SIZE = 20;
+// Rows fetched per request while the list loads in the background
+const LOAD_PAGE_SIZE = 500;
 
 type KanjiListScreenProps = {
   transport: Transport;
@@ -30,10 +32,26 @@ export default function KanjiListScreen({ transport }: KanjiListScreenProps) {
   const [page, setPage] = useState(0);
 
   useEffect(() => {
-    transport.getKanjiList().then((data) => {
-      setKanjis(data);
-      setIsLoading(false);
-    });
+    let cancelled = false;
+
+    // Show the first page as soon as it arrives and keep appending the rest
+    const load = async () => {
+      let loaded: KanjiListEntry[] = [];
+      let cursor: string | null = null;
+      do {
+        const result: KanjiListPage = await transport.getKanjiPage(LOAD_PAGE_SIZE, cursor);
+        if (cancelled) return;
+        loaded = loaded.concat(result.kanjis);
+        setKanjis(loaded);
+        setIsLoading(false);
+        cursor = result.next_cursor;
+      } while (cursor);
+    };
+    load();
+
+    return () => {
+      cancelled = true;
+    };
   }, [transport]);
 
   const totalPages = Math.max(1, Math.ceil(kanjis.length / PAGE_SIZE));
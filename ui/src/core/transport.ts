@@ -41,6 +41,11 @@ export type KanjiListEntry = {
   next_review_date: number;
 };
 
+export type KanjiListPage = {
+  kanjis: KanjiListEntry[];
+  next_cursor: string | null;
+};
+
 export class Transport {
   private baseUrl = "";
   public onSessionExpired: (() => void) | null = null;
@@ -84,11 +89,14 @@ export class Transport {
     return res.json();
   }
 
-  public async learnMoreKanjis(): Promise<void> {
-    await this.fetchWithAuth(`${this.baseUrl}/api/learn-more`, {
+  public async learnMoreKanjis(count?: number): Promise<number[]> {
+    const query = count === undefined ? "" : `?count=${count}`;
+    const res = await this.fetchWithAuth(`${this.baseUrl}/api/learn-more${query}`, {
       method: "POST",
       headers: this.getAuthHeaders(),
     });
+    const body: { ids: number[] } = await res.json();
+    return body.ids;
   }
 
   public async getKanjiList(): Promise<KanjiListEntry[]> {
@@ -97,4 +105,13 @@ export class Transport {
     });
     return res.json();
   }
+
+  public async getKanjiPage(limit: number, cursor: string | null): Promise<KanjiListPage> {
+    const params = new URLSearchParams({ limit: String(limit) });
+    if (cursor) params.set("cursor", cursor);
+    const res = await this.fetchWithAuth(`${this.baseUrl}/api/kanjis?${params}`, {
+      headers: this.getAuthHeaders(),
+    });
+    return res.json();
+  }
 }
\ No newline at end of file